@@ -36,20 +36,35 @@
 from __future__ import print_function
 from __future__ import absolute_import
 
+import os
+
 from m5 import fatal
 import m5.objects
 
+def etrace_file_name(name, cpu_id, num_cpus):
+    """Elastic trace file of a cpu: 'inst.pb.gz' becomes 'inst.cpu1.pb.gz'
+    when there is more than one cpu."""
+    if num_cpus == 1:
+        return name
+    dirname, filename = os.path.split(name)
+    base, sep, ext = filename.partition(".")
+    return os.path.join(dirname, "%s.cpu%d%s%s" % (base, cpu_id, sep, ext))
+
 def config_etrace(cpu_cls, cpu_list, options):
     if issubclass(cpu_cls, m5.objects.DerivO3CPU):
-        # Assign the same file name to all cpus for now. This must be
-        # revisited when creating elastic traces for multi processor systems.
-        for cpu in cpu_list:
+        # Multi processor systems get one pair of trace files per cpu, see
+        # etrace_file_name()
+        for i, cpu in enumerate(cpu_list):
             # Attach the elastic trace probe listener. Set the protobuf trace
             # file names. Set the dependency window size equal to the cpu it
             # is attached to.
             cpu.traceListener = m5.objects.ElasticTrace(
-                                instFetchTraceFile = options.inst_trace_file,
-                                dataDepTraceFile = options.data_trace_file,
+                                instFetchTraceFile = etrace_file_name(
+                                    options.inst_trace_file, i,
+                                    len(cpu_list)),
+                                dataDepTraceFile = etrace_file_name(
+                                    options.data_trace_file, i,
+                                    len(cpu_list)),
                                 depWindowSize = 3 * cpu.numROBEntries)
             # Make the number of entries in the ROB, LQ and SQ very
             # large so that there are no stalls due to resource
@@ -189,4 +189,5 @@ def _subclass_tester(name):
     return tester
 
 is_kvm_cpu = _subclass_tester("BaseKvmCPU")
+is_o3_cpu = _subclass_tester("DerivO3CPU")
 is_noncaching_cpu = _subclass_tester("NonCachingSimpleCPU")
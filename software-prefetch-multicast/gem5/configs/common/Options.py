@@ -296,8 +296,12 @@ def addCommonOptions(parser):
                       help="Enable basic block profiling for SimPoints")
     parser.add_option("--simpoint-interval", type="int", default=10000000,
                       help="SimPoint interval in num of instructions")
+    parser.add_option("--simpoint-roi-only", action="store_true",
+                      help="Only profile basic blocks inside the prepush "
+                           "(ROI) window, one BBV for all the threads")
     parser.add_option("--take-simpoint-checkpoints", action="store", type="string",
-        help="<simpoint file,weight file,interval-length,warmup-length>")
+        help="<simpoint file,weight file,interval-length,warmup-length"
+             "[,inst file]>")
     parser.add_option("--restore-simpoint-checkpoint", action="store_true",
         help="restore from a simpoint checkpoint taken with " +
              "--take-simpoint-checkpoints")
@@ -339,6 +343,29 @@ def addCommonOptions(parser):
     parser.add_option("-p", "--prog-interval", type="str",
         help="CPU Progress Interval")
 
+    # Sampled (SMARTS-style) simulation: alternate functional warming on a
+    # simple timing CPU, which keeps the Ruby caches and the prepush state
+    # warm, with short detailed measurement windows
+    parser.add_option("--sample-window", action="store", type="int",
+        default=None,
+        help="Sampled simulation: detailed measurement window in ticks")
+    parser.add_option("--sample-interval", action="store", type="int",
+        default=None,
+        help="Sampled simulation: functional warming period in ticks "
+             "between two detailed windows")
+    parser.add_option("--sample-detail-warmup", action="store", type="int",
+        default=0,
+        help="Sampled simulation: detailed warming in ticks before each "
+             "measurement window (not measured)")
+    parser.add_option("--sample-confidence", action="store", type="float",
+        default=0.95,
+        help="Sampled simulation: confidence level of the reported "
+             "intervals")
+    parser.add_option("--sample-target-error", action="store", type="float",
+        default=0.03,
+        help="Sampled simulation: relative error used to recommend the "
+             "number of windows")
+
     # Fastforwarding and simpoint related materials
     parser.add_option("-W", "--warmup-insts", action="store", type="int",
         default=None,
@@ -369,6 +396,19 @@ def addCommonOptions(parser):
         "that are present under any of the roots. If not given, dump all "
         "stats. "
     )
+    parser.add_option("--eventq-calendar", action="store_true",
+                      default=False,
+                      help="Index the event queue bins in a calendar instead "
+                           "of walking them on every insertion")
+    parser.add_option("--stats-sample", action="append", default=[],
+                      help="Sample the statistics matching this name "
+                           "expression (e.g. 'system.ruby.network.*') into "
+                           "a binary time series, can be repeated")
+    parser.add_option("--stats-sample-interval", type="int", default=10000,
+                      help="Statistics sampling interval in cycles")
+    parser.add_option("--stats-sample-capacity", type="int", default=4096,
+                      help="Samples held in memory between two writes of "
+                           "the time series")
 
 
 def addSEOptions(parser):
@@ -406,6 +446,11 @@ def addSEOptions(parser):
                            "itself from the elf binary. The option points to "
                            "the parent folder of the guest /lib in the "
                            "host fs")
+    parser.add_option("--shared-decode-cache", action="store_true",
+                      default=False,
+                      help="Share the x86 decode cache across the threads "
+                           "and pre-decode the text of the workloads into "
+                           "it at load time")
 
     parser.add_option("--redirects", action="append", type="string",
                       default=[],
@@ -416,6 +461,19 @@ def addSEOptions(parser):
     parser.add_option("--wait-gdb", default=False,
                       help="Wait for remote GDB to connect.")
 
+    # Spin-wait quiescing options
+    parser.add_option("--spin-quiesce", action="store_true",
+                      help="Suspend O3 threads spinning on an unchanged "
+                           "cache line (e.g. OpenMP barriers) until the "
+                           "line is written")
+    parser.add_option("--spin-quiesce-iterations", type="int", default=64,
+                      help="Identical spin-wait iterations before "
+                           "quiescing")
+    parser.add_option("--spin-quiesce-max-cycles", type="int",
+                      default=100000,
+                      help="Maximum number of cycles a spin-wait quiesce "
+                           "can last")
+
 
 
 def addFSOptions(parser):
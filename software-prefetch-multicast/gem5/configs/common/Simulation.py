@@ -40,6 +40,7 @@
 from __future__ import print_function
 from __future__ import absolute_import
 
+import math
 import six
 import sys
 from os import getcwd
@@ -291,8 +292,11 @@ def benchCheckpoints(options, maxtick, cptdir):
 def parseSimpointAnalysisFile(options, testsys):
     import re
 
+    fields = options.take_simpoint_checkpoints.split(",")
+    if len(fields) not in (4, 5):
+        fatal("--take-simpoint-checkpoints expects 4 or 5 fields")
     simpoint_filename, weight_filename, interval_length, warmup_length = \
-        options.take_simpoint_checkpoints.split(",", 3)
+        fields[:4]
     print("simpoint analysis file:", simpoint_filename)
     print("simpoint weight file:", weight_filename)
     print("interval length:", interval_length)
@@ -301,6 +305,14 @@ def parseSimpointAnalysisFile(options, testsys):
     interval_length = int(interval_length)
     warmup_length = int(warmup_length)
 
+    # Intervals profiled with --simpoint-roi-only do not start at multiples
+    # of the interval length, their start inst counts are read instead.
+    interval_starts = None
+    if len(fields) == 5:
+        print("simpoint inst file:", fields[4])
+        with open(fields[4]) as inst_file:
+            interval_starts = [int(l) for l in inst_file if l.strip()]
+
     # Simpoint analysis output starts interval counts with 0.
     simpoints = []
     simpoint_start_insts = []
@@ -327,15 +339,22 @@ def parseSimpointAnalysisFile(options, testsys):
         else:
             fatal('unrecognized line in simpoint weight file!')
 
-        if (interval * interval_length - warmup_length > 0):
-            starting_inst_count = \
-                interval * interval_length - warmup_length
+        if interval_starts is not None:
+            if interval >= len(interval_starts):
+                fatal('interval %d not found in simpoint inst file!' %
+                      interval)
+            interval_start = interval_starts[interval]
+        else:
+            interval_start = interval * interval_length
+
+        if (interval_start - warmup_length > 0):
+            starting_inst_count = interval_start - warmup_length
             actual_warmup_length = warmup_length
         else:
             # Not enough room for proper warmup
             # Just starting from the beginning
             starting_inst_count = 0
-            actual_warmup_length = interval * interval_length
+            actual_warmup_length = interval_start
 
         simpoints.append((interval, weight, starting_inst_count,
             actual_warmup_length))
@@ -431,6 +450,145 @@ def repeatSwitch(testsys, repeat_switch_cpu_list, maxtick, switch_freq):
             exit_event = m5.simulate(maxtick - m5.curTick())
             return exit_event
 
+def sampleZScore(confidence):
+    """Two-sided normal critical value for the given confidence level."""
+    try:
+        from statistics import NormalDist
+        return NormalDist().inv_cdf(0.5 + confidence / 2.0)
+    except ImportError:
+        table = { 0.90 : 1.645, 0.95 : 1.960, 0.99 : 2.576, 0.997 : 3.000 }
+        if confidence not in table:
+            fatal("Unsupported --sample-confidence %s, use one of %s" %
+                  (confidence, sorted(table.keys())))
+        return table[confidence]
+
+def reportSamples(options, samples, total_insts, tick_period):
+    """Summarize the per-window samples of a sampled simulation.
+
+       Each sample is a (instructions, cycles) tuple covering all the
+       detailed CPUs. The mean IPC, its confidence interval and the
+       sim_seconds extrapolated from the instructions committed over the
+       whole sampled region are printed and written to sampling.txt.
+    """
+    n = len(samples)
+    if n == 0:
+        warn("Sampled simulation finished without a complete window")
+        return
+
+    ipcs = [float(insts) / cycles for insts, cycles in samples if cycles > 0]
+    n = len(ipcs)
+    if n == 0:
+        warn("Sampled simulation finished without a window of any cycle")
+        return
+    mean = sum(ipcs) / n
+    if n > 1:
+        var = sum((x - mean) ** 2 for x in ipcs) / (n - 1)
+    else:
+        var = 0.0
+    stdev = var ** 0.5
+    z = sampleZScore(options.sample_confidence)
+    half = z * stdev / (n ** 0.5)
+    cov = stdev / mean if mean > 0 else 0.0
+    # SMARTS: n >= (z * V / epsilon)^2 windows for a relative error epsilon
+    needed = int(math.ceil((z * cov / options.sample_target_error) ** 2))
+
+    tick_seconds = 1.0 / m5.ticks.fromSeconds(1.0)
+    def extrapolate(ipc):
+        if ipc <= 0:
+            return float('inf')
+        return total_insts / ipc * tick_period * tick_seconds
+
+    lines = [
+        "windows                %d" % n,
+        "window_ticks           %d" % options.sample_window,
+        "interval_ticks         %d" % options.sample_interval,
+        "confidence             %.3f" % options.sample_confidence,
+        "ipc_mean               %.6f" % mean,
+        "ipc_per_cpu_mean       %.6f" % (mean / options.num_cpus),
+        "ipc_stdev              %.6f" % stdev,
+        "ipc_ci_low             %.6f" % (mean - half),
+        "ipc_ci_high            %.6f" % (mean + half),
+        "ipc_rel_error          %.6f" % (half / mean if mean > 0 else 0.0),
+        "windows_for_target     %d" % needed,
+        "total_insts            %d" % total_insts,
+        "sim_seconds_estimate   %.9f" % extrapolate(mean),
+        "sim_seconds_ci_low     %.9f" % extrapolate(mean + half),
+        "sim_seconds_ci_high    %.9f" % extrapolate(mean - half),
+    ]
+
+    print("**** SAMPLED SIMULATION SUMMARY ****")
+    for line in lines:
+        print(line)
+    if needed > n:
+        warn("%d windows needed for a %.1f%% error at %.1f%% confidence, "
+             "only %d were measured" % (needed,
+             options.sample_target_error * 100,
+             options.sample_confidence * 100, n))
+
+    outdir = m5.options.outdir if m5.options.outdir else getcwd()
+    with open(joinpath(outdir, "sampling.txt"), "w") as f:
+        f.write("\n".join(lines) + "\n")
+        f.write("\n# window insts cycles ipc\n")
+        for i, (insts, cycles) in enumerate(samples):
+            f.write("%d %d %d %.6f\n" % (i, insts, cycles,
+                    float(insts) / cycles if cycles > 0 else 0.0))
+
+def sampledSimulation(options, testsys, detail_cpus, warm_cpus, maxtick):
+    """SMARTS-style sampling loop.
+
+       The detailed CPUs run a (optional) detailed warming period and a
+       measurement window, then hand over to the warming CPUs for
+       --sample-interval ticks. The warming CPUs are timing simple CPUs
+       so that every access still goes through the Ruby protocol: the
+       L0/L1/LLC contents, the prepush waitlists and the share groups stay
+       warm, which atomic_noncaching accesses would bypass.
+    """
+    print("starting sampled simulation")
+    tick_period = m5.ticks.fromSeconds(1.0 / convert.toFrequency(
+                                       options.cpu_clock))
+    all_cpus = list(detail_cpus) + list(warm_cpus)
+    start_insts = sum(cpu.totalInsts() for cpu in all_cpus)
+    detail_list = [(detail_cpus[i], warm_cpus[i])
+                   for i in range(len(detail_cpus))]
+    warm_list = [(warm_cpus[i], detail_cpus[i])
+                 for i in range(len(detail_cpus))]
+    samples = []
+
+    def remaining():
+        return maxtick - m5.curTick()
+
+    while True:
+        if options.sample_detail_warmup:
+            exit_event = m5.simulate(min(options.sample_detail_warmup,
+                                         remaining()))
+            if exit_event.getCause() != "simulate() limit reached" or \
+                    remaining() <= 0:
+                break
+
+        insts = sum(cpu.totalInsts() for cpu in detail_cpus)
+        start = m5.curTick()
+        exit_event = m5.simulate(min(options.sample_window, remaining()))
+        window_insts = sum(cpu.totalInsts() for cpu in detail_cpus) - insts
+        window_cycles = (m5.curTick() - start) // tick_period
+        if exit_event.getCause() != "simulate() limit reached" or \
+                remaining() <= 0:
+            # Only keep a truncated window if it is the only one we have
+            if not samples:
+                samples.append((window_insts, window_cycles))
+            break
+        samples.append((window_insts, window_cycles))
+
+        m5.switchCpus(testsys, detail_list)
+        exit_event = m5.simulate(min(options.sample_interval, remaining()))
+        if exit_event.getCause() != "simulate() limit reached" or \
+                remaining() <= 0:
+            break
+        m5.switchCpus(testsys, warm_list)
+
+    total_insts = sum(cpu.totalInsts() for cpu in all_cpus) - start_insts
+    reportSamples(options, samples, total_insts, tick_period)
+    return exit_event
+
 def run(options, root, testsys, cpu_class):
     if options.checkpoint_dir:
         cptdir = options.checkpoint_dir
@@ -451,6 +609,23 @@ def run(options, root, testsys, cpu_class):
     if options.repeat_switch and options.take_checkpoints:
         fatal("Can't specify both --repeat-switch and --take-checkpoints")
 
+    if options.sample_window:
+        if not options.sample_interval:
+            fatal("--sample-window requires --sample-interval")
+        if options.repeat_switch or options.standard_switch:
+            fatal("Can't specify --sample-window with --repeat-switch or "
+                  "--standard-switch")
+        if options.take_checkpoints or options.take_simpoint_checkpoints:
+            fatal("Can't specify --sample-window when taking checkpoints")
+
+    root.eventq_calendar = options.eventq_calendar
+
+    if options.stats_sample:
+        testsys.stats_sampler = StatsSampler(
+            stats=options.stats_sample,
+            interval=options.stats_sample_interval,
+            capacity=options.stats_sample_capacity)
+
     # Setup global stat filtering.
     stat_root_simobjs = []
     for stat_root_str in options.stats_root:
@@ -538,6 +713,28 @@ def run(options, root, testsys, cpu_class):
             repeat_switch_cpu_list = [(testsys.cpu[i], repeat_switch_cpus[i])
                                       for i in range(np)]
 
+    if options.sample_window:
+        # Functional warming CPUs of the sampled simulation, swapped in
+        # between the detailed measurement windows
+        sample_warm_cpus = [TimingSimpleCPU(switched_out=True, cpu_id=(i))
+                            for i in range(np)]
+
+        for i in range(np):
+            sample_warm_cpus[i].system = testsys
+            sample_warm_cpus[i].workload = testsys.cpu[i].workload
+            sample_warm_cpus[i].clk_domain = testsys.cpu[i].clk_domain
+            sample_warm_cpus[i].isa = testsys.cpu[i].isa
+
+            if options.maxinsts:
+                sample_warm_cpus[i].max_insts_any_thread = options.maxinsts
+
+        testsys.sample_warm_cpus = sample_warm_cpus
+
+        if cpu_class:
+            sample_detail_cpus = switch_cpus
+        else:
+            sample_detail_cpus = testsys.cpu
+
     if options.standard_switch:
         switch_cpus = [TimingSimpleCPU(switched_out=True, cpu_id=(i))
                        for i in range(np)]
@@ -727,7 +924,11 @@ def run(options, root, testsys, cpu_class):
 
         # If checkpoints are being taken, then the checkpoint instruction
         # will occur in the benchmark code it self.
-        if options.repeat_switch and maxtick > options.repeat_switch:
+        if options.sample_window:
+            exit_event = sampledSimulation(options, testsys,
+                                           sample_detail_cpus,
+                                           sample_warm_cpus, maxtick)
+        elif options.repeat_switch and maxtick > options.repeat_switch:
             exit_event = repeatSwitch(testsys, repeat_switch_cpu_list,
                                       maxtick, options.repeat_switch)
         else:
@@ -0,0 +1,97 @@
+# Replay the elastic traces of a multi-core SPM run into a Ruby hierarchy.
+#
+# This is the timing half of a fan out design-space exploration: the
+# functional front end runs once (se.py with --elastic-trace-en records, per
+# core, the instruction fetch and data dependency traces of the detailed
+# region, with the PCs and request flags so that software prefetches still
+# reach the SPM L1 as such), then one replay per Ruby configuration runs
+# concurrently without re-executing or re-decoding the guest program, see
+# --fanout in utils/run-experiment.py.
+#
+# Each configuration is a separate gem5 process: Ruby keeps per-process
+# state (SLICC controller counts, static cache stats), so several Ruby
+# systems cannot share one process. Replaying a trace drops the
+# timing-dependent interleaving between cores, the dependencies inside a
+# core are kept.
+
+from __future__ import print_function
+from __future__ import absolute_import
+
+import optparse
+import sys
+
+import m5
+from m5.objects import *
+from m5.util import addToPath, fatal
+
+addToPath('../')
+
+from ruby import Ruby
+
+from common import Options
+from common import CpuConfig
+
+def build_system(options):
+    """Builds a system of Trace CPUs over a Ruby hierarchy."""
+    np = options.num_cpus
+    system = System(cpu = [TraceCPU(cpu_id=i) for i in range(np)],
+                    mem_mode = 'timing',
+                    mem_ranges = [AddrRange(options.mem_size)],
+                    cache_line_size = options.cacheline_size)
+
+    system.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
+    system.clk_domain = SrcClockDomain(clock =  options.sys_clock,
+                                       voltage_domain = system.voltage_domain)
+    system.cpu_voltage_domain = VoltageDomain()
+    system.cpu_clk_domain = SrcClockDomain(clock = options.cpu_clock,
+                                           voltage_domain =
+                                           system.cpu_voltage_domain)
+
+    for i, cpu in enumerate(system.cpu):
+        cpu.clk_domain = system.cpu_clk_domain
+        cpu.createThreads()
+        cpu.instTraceFile = CpuConfig.etrace_file_name(
+            options.inst_trace_file, i, np)
+        cpu.dataTraceFile = CpuConfig.etrace_file_name(
+            options.data_trace_file, i, np)
+
+    Ruby.create_system(options, False, system)
+    assert(np == len(system.ruby._cpu_ports))
+    system.ruby.clk_domain = SrcClockDomain(clock = options.ruby_clock,
+                                        voltage_domain = system.voltage_domain)
+
+    # Trace CPUs have no interrupt controller, only the cache ports are
+    # connected
+    for i in range(np):
+        ruby_port = system.ruby._cpu_ports[i]
+        system.cpu[i].icache_port = ruby_port.in_ports
+        system.cpu[i].dcache_port = ruby_port.in_ports
+
+    return system
+
+parser = optparse.OptionParser()
+Options.addCommonOptions(parser)
+Ruby.define_options(parser)
+
+(options, args) = parser.parse_args()
+
+if args:
+    print("Error: script doesn't take any positional arguments")
+    sys.exit(1)
+
+if options.cpu_type != "TraceCPU":
+    fatal("This is a script for elastic trace replay simulation, use "\
+            "--cpu-type=TraceCPU\n")
+
+if not options.ruby:
+    fatal("This script replays the traces into Ruby, use --ruby\n")
+
+system = build_system(options)
+root = Root(full_system = False, system = system,
+            eventq_calendar = options.eventq_calendar)
+
+m5.instantiate()
+
+print("**** REPLAY ****")
+exit_event = m5.simulate()
+print('Exiting @ tick %i because %s' % (m5.curTick(), exit_event.getCause()))
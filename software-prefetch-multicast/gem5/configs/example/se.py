@@ -164,6 +164,18 @@ else:
 (CPUClass, test_mem_mode, FutureClass) = Simulation.setCPUClass(options)
 CPUClass.numThreads = numThreads
 
+# Spin-wait quiescing is implemented in the O3 commit stage, with fast
+# forwarding it only applies to the detailed CPU
+if options.spin_quiesce:
+    spin_classes = [cls for cls in (CPUClass, FutureClass)
+                    if ObjectList.is_o3_cpu(cls)]
+    if not spin_classes:
+        fatal("--spin-quiesce requires an O3 CPU type")
+    for cls in spin_classes:
+        cls.spinQuiesce = True
+        cls.spinQuiesceIterations = options.spin_quiesce_iterations
+        cls.spinQuiesceMaxCycles = options.spin_quiesce_max_cycles
+
 # Check -- do not allow SMT with multiple CPUs
 if options.smt and options.num_cpus > 1:
     fatal("You cannot use SMT with multiple CPUs!")
@@ -217,8 +229,9 @@ if ObjectList.is_kvm_cpu(CPUClass) or ObjectList.is_kvm_cpu(FutureClass):
 if options.simpoint_profile:
     if not ObjectList.is_noncaching_cpu(CPUClass):
         fatal("SimPoint/BPProbe should be done with an atomic cpu")
-    if np > 1:
-        fatal("SimPoint generation not supported with more than one CPUs")
+    if np > 1 and not options.simpoint_roi_only:
+        fatal("SimPoint generation not supported with more than one CPUs, "
+              "unless profiling the ROI with --simpoint-roi-only")
 
 for i in range(np):
     if options.smt:
@@ -229,7 +242,8 @@ for i in range(np):
         system.cpu[i].workload = multiprocesses[i]
 
     if options.simpoint_profile:
-        system.cpu[i].addSimPointProbe(options.simpoint_interval)
+        system.cpu[i].addSimPointProbe(options.simpoint_interval,
+            system if options.simpoint_roi_only else None, i)
 
     if options.checker:
         system.cpu[i].addCheckerCpu()
@@ -245,6 +259,12 @@ for i in range(np):
 
     system.cpu[i].createThreads()
 
+    if options.shared_decode_cache:
+        if buildEnv['TARGET_ISA'] != 'x86':
+            fatal("--shared-decode-cache is only supported on x86")
+        for isa in system.cpu[i].isa:
+            isa.shared_decode_cache = True
+
 if options.ruby:
     Ruby.create_system(options, False, system)
     assert(options.num_cpus == len(system.ruby._cpu_ports))
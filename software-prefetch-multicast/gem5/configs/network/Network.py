@@ -91,6 +91,22 @@ def define_options(parser):
                       help="""send the whole pacekt one by one to each output
                             VC without reserving multile output VCs at the
                             same time, need to work with VCT flow control""")
+    parser.add_option("--multicast-vcs-per-vnet", action="store", type="int",
+                      default=0,
+                      help="""virtual channels of every virtual network
+                            reserved for the multicast packets, so that the
+                            unicast ones never wait behind them""")
+    parser.add_option("--multicast-staging-flits", action="store",
+                      type="int", default=0,
+                      help="""flits buffered at every router output for the
+                            multicast replicas blocked there, so that they
+                            release their input VC (0 to disable)""")
+    parser.add_option("--multicast-routing", type="choice",
+                      default="deterministic",
+                      choices=["deterministic", "west-first"],
+                      help="""routing of the multicast branches, west-first
+                            takes the productive outport with the most
+                            downstream credits on a mesh""")
     parser.add_option("--prepush-filter", action="store_true",
                       default=False,
                       help="filter unncessary data requests when requests and"
@@ -99,10 +115,22 @@ def define_options(parser):
                       default=False,
                       help="Enable filter but don't filter unncessary data requests when requests and"
                            " prepush response meet in the routers")
+    parser.add_option("--ack-combining", action="store_true",
+                      default=False,
+                      help="combine the prepush acks to the same L2 that meet"
+                           " in the routers into one message")
     parser.add_option("--hold-switch-for-multicast-only", action="store_true",
                       default=False,
                       help="Hold switch for multicast packets only but not "
                            "other data packets")
+    parser.add_option("--noc-latency-csv", action="store", type="string",
+                      default="",
+                      help="""stream the per message class latency breakdown
+                            of the garnet packets to this CSV file of the
+                            output directory""")
+    parser.add_option("--noc-latency-csv-interval", action="store",
+                      type="int", default=10000,
+                      help="sampling interval of --noc-latency-csv in cycles")
 
 def create_network(options, ruby):
 
@@ -148,10 +176,16 @@ def init_network(options, network, InterfaceClass):
         network.garnet_deadlock_threshold = options.garnet_deadlock_threshold
         network.enableMulticast = options.enable_multicast
         network.asynchronousMulticast = options.asynchronous_multicast
+        network.multicastVcsPerVnet = options.multicast_vcs_per_vnet
+        network.multicastStagingFlits = options.multicast_staging_flits
+        network.multicastRouting = options.multicast_routing
         network.prepushFilter = options.prepush_filter
         network.prepushFilterNoDrop = options.prepush_filter_nodrop
+        network.ackCombining = options.ack_combining
         network.holdSwitchForMulticastOnly = \
                 options.hold_switch_for_multicast_only
+        network.latency_csv = options.noc_latency_csv
+        network.latency_csv_interval = options.noc_latency_csv_interval
 
         # Create Bridges and connect them to the corresponding links
         for intLink in network.int_links:
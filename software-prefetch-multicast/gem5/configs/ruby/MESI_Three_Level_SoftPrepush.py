@@ -70,6 +70,17 @@ def define_options(parser):
     parser.add_option("--en_adaptive_timeout_threshold", type="int", default=0, help="Enable adaptive timeout")
     parser.add_option("--en_adaptive_timeout_division", type="int", default=1, help="adaptive timeout division")
     parser.add_option("--timeout_threshold_upper_bound", type="int", default=256, help="adaptive timeout upper bound")
+    # Evaluated on the waitlist events of the real timeout, they only add
+    # stats (shadow_timeout.*) to the L1 controllers, e.g. 128,256,1024
+    parser.add_option("--shadow_timeout_thresholds", type="string", default="",
+                        help="comma separated fixed timeout thresholds to evaluate in the shadow of --timeout_threshold")
+    parser.add_option("--shadow_adaptive_upper_bounds", type="string", default="",
+                        help="comma separated adaptive timeout upper bounds to evaluate in the shadow of --timeout_threshold")
+
+    # e.g. 64, learned per prefetch PC from --timeout_threshold, which
+    # it replaces as well as the adaptive timeout
+    parser.add_option("--pc_timeout_entries", type="int", default=0,
+                        help="entries of the per PC timeout predictor, 0 disables it")
 
     # 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, 32768, 65536
     parser.add_option("--timeout_switch_threshold",  type="int", default=16384, help="Timeout Switch host Threshold")
@@ -110,6 +121,46 @@ def define_options(parser):
     parser.add_option("--dont_response_threshold",  type="int", default=250,\
                         help="Dont reply threshold")
 
+    # 1024 to 4096, 0 keeps the group sharers of every LLC line
+    parser.add_option("--region_sharers_size",  type="int", default=0,\
+                        help="Bytes per region tracking the LLC group sharers")
+    parser.add_option("--region_sharers_entries",  type="int", default=256,\
+                        help="Regions tracked at once per LLC bank")
+
+    # 1 requests every prefetcht1 line on its own
+    parser.add_option("--prepush_range_lines",  type="int", default=1,\
+                        help="Lines a host prefetcht1 requests at once")
+
+    # Replaces the per benchmark number of groups and the Config_Req of the
+    # cores, e.g. a threshold of 8 co-requested lines per 1024 GetS
+    parser.add_option("--auto_share_groups",  type="int", default=0,\
+                        help="Learn the share groups at the LLC if = 1")
+    parser.add_option("--share_group_threshold",  type="int", default=8,\
+                        help="Lines two cores request to be grouped")
+    parser.add_option("--share_group_epoch",  type="int", default=1024,\
+                        help="GetS per LLC bank between two regroupings")
+
+    # e.g. 16 lines next to the L1, fully associative
+    parser.add_option("--prepush_buffer_entries",  type="int", default=0,\
+                        help="Lines of the L1 prepush buffer, 0 installs the prepushes in the L1")
+
+    # The LLC pushes the lines written by these stores to the sharers they
+    # invalidated, e.g. the producer loop of a producer/consumer kernel
+    parser.add_option("--push_update_start_pc",  type="int", default=0,\
+                        help="First store PC of the push update range")
+    parser.add_option("--push_update_end_pc",  type="int", default=0,\
+                        help="Last store PC of the push update range, 0 disables the push updates")
+
+    # e.g. 4 lines from 2 strides ahead of the prepush misses of a group
+    parser.add_option("--dir_stream_degree",  type="int", default=0,\
+                        help="Lines a directory reads ahead of a prepush miss stream, 0 disables it")
+    parser.add_option("--dir_stream_distance",  type="int", default=1,\
+                        help="Strides between a prepush miss and the first line read ahead")
+    parser.add_option("--dir_stream_entries",  type="int", default=16,\
+                        help="Share groups followed at once per directory")
+    parser.add_option("--dir_stream_lines",  type="int", default=32,\
+                        help="Lines read ahead and buffered at once per directory")
+
     parser.add_option("--benchmark_num",  type="int", default=1,\
                         help="0: Nothing; 1: cachebw; 2: multilevel; 3: mv; 4: conv3d; \
                         5: mlp; 6: backprop; 7: particlefilter")
@@ -147,6 +198,11 @@ def create_system(options, full_system, system, dma_ports, bootmem,
 
     buffer_size = options.message_buffer_size
 
+    shadow_timeout_thresholds = \
+        [int(t) for t in options.shadow_timeout_thresholds.split(",") if t]
+    shadow_adaptive_upper_bounds = \
+        [int(t) for t in options.shadow_adaptive_upper_bounds.split(",") if t]
+
     if options.print_all_cache_evict_dist:
         options.print_l0_cache_evict_dist = True
         options.print_l1_cache_evict_dist = True
@@ -236,6 +292,10 @@ def create_system(options, full_system, system, dma_ports, bootmem,
         in_PC3  = 0x403c85
         in_PC4  = 0x404d80
 
+    # Every core starts as a group of its own, the LLC learning the groups
+    if options.auto_share_groups == 1:
+        num_of_groups = options.num_cpus
+
     #
     # Must create the individual controllers before the network to ensure the
     # controller constructors are called before the network constructor
@@ -329,6 +389,16 @@ def create_system(options, full_system, system, dma_ports, bootmem,
                                        options.print_l1_cache_evict_dist,
                                 enable_DoNotReplacePushed = options.enable_DoNotReplacePushed,
                                 is_software_pushmulticast = 1)
+            # fully associative, none when disabled
+            prepush_buffer = NULL
+            if options.prepush_buffer_entries > 0:
+                buffer_entries = options.prepush_buffer_entries
+                prepush_buffer = L1Cache(size = "%dB" % (buffer_entries *
+                                                         options.cacheline_size),
+                                         assoc = buffer_entries,
+                                         start_index_bit = block_size_bits,
+                                         replacement_policy = LRURP(),
+                                         is_software_pushmulticast = 1)
             l1_prefetcher = RubyPrefetcher(
                 num_streams=16,
                 unit_filter = 256,
@@ -341,6 +411,10 @@ def create_system(options, full_system, system, dma_ports, bootmem,
             l1_cntrl = L1Cache_Controller(
                     version = i * num_cpus_per_cluster + j, number_of_TBEs = 256,
                     cache = l1_cache, l2_select_num_bits = l2_bits,
+                    prepushBuffer = prepush_buffer,
+                    en_prepush_buffer = int(options.prepush_buffer_entries > 0),
+                    PushUpdateStartPC = options.push_update_start_pc,
+                    PushUpdateEndPC = options.push_update_end_pc,
                     prefetcher=l1_prefetcher,
                     enable_prefetch = options.enable_L1bingo_L2Stride,
                     cluster_id = i,
@@ -369,7 +443,13 @@ def create_system(options, full_system, system, dma_ports, bootmem,
                     determine_host = options.determine_host,
                     enable_select_newvictim = options.enable_select_newvictim,
                     ruby_system = ruby_system, donot_observe_prefetch = options.donot_observe_prefetch, en_adaptive_timeout_threshold = options.en_adaptive_timeout_threshold,
-                    en_adaptive_timeout_division = options.en_adaptive_timeout_division, timeout_threshold_upper_bound = options.timeout_threshold_upper_bound)
+                    en_adaptive_timeout_division = options.en_adaptive_timeout_division, timeout_threshold_upper_bound = options.timeout_threshold_upper_bound,
+                    prepush_range_lines = options.prepush_range_lines,
+                    auto_share_groups = options.auto_share_groups,
+                    shadow_timeout_thresholds = shadow_timeout_thresholds,
+                    shadow_adaptive_upper_bounds = shadow_adaptive_upper_bounds,
+                    shadow_timeout_division = options.en_adaptive_timeout_division,
+                    pc_timeout_entries = options.pc_timeout_entries)
 
             exec("ruby_system.l0_cntrl%d = l0_cntrl"
                  % ( i * num_cpus_per_cluster + j))
@@ -431,6 +511,12 @@ def create_system(options, full_system, system, dma_ports, bootmem,
 
                         en_dont_response = options.en_dont_response,
                         dont_response_threshold = options.dont_response_threshold,
+                        region_sharers_size = options.region_sharers_size,
+                        region_sharers_entries = options.region_sharers_entries,
+                        l2_select_num_bits = l2_bits,
+                        auto_share_groups = options.auto_share_groups,
+                        share_group_threshold = options.share_group_threshold,
+                        share_group_epoch = options.share_group_epoch,
 
                         windowCycles = options.window_cycles,
                         profileLLCSharers = options.profile_llc_sharers,
@@ -474,6 +560,8 @@ def create_system(options, full_system, system, dma_ports, bootmem,
             l2_cntrl.responseToL2Cache = \
                     MessageBuffer(enable_filter_drop = options.en_Filter_Drop,buffer_size = buffer_size)
             l2_cntrl.responseToL2Cache.slave = ruby_system.network.master
+            # internal and unbounded, the bank walks its ranges through it
+            l2_cntrl.rangeTriggerQueue = MessageBuffer(ordered = True)
 
     # Run each of the ruby memory controllers at a ratio of the frequency of
     # the ruby system
@@ -496,6 +584,12 @@ def create_system(options, full_system, system, dma_ports, bootmem,
         dir_cntrl.responseFromDir.master = ruby_system.network.slave
         dir_cntrl.requestToMemory = MessageBuffer(enable_filter_drop = options.en_Filter_Drop,buffer_size = buffer_size)
         dir_cntrl.responseFromMemory = MessageBuffer(enable_filter_drop = options.en_Filter_Drop,buffer_size = buffer_size)
+        dir_cntrl.streamTriggerQueue = MessageBuffer(ordered = True)
+
+        dir_cntrl.prepush_stream_degree = options.dir_stream_degree
+        dir_cntrl.prepush_stream_distance = options.dir_stream_distance
+        dir_cntrl.prepush_stream_entries = options.dir_stream_entries
+        dir_cntrl.prepush_stream_lines = options.dir_stream_lines
 
     for i, dma_port in enumerate(dma_ports):
         #
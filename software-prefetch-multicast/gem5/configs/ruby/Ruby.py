@@ -144,6 +144,14 @@ def define_options(parser):
                            "unblock-forward virtual networks, "
                            "'ordered-prepush-inv' for only ordered prepush "
                            "and invalidation messages")
+    parser.add_option("--mem-sched-policy", type="choice", default="frfcfs",
+                      choices=["fcfs", "frfcfs", "frfcfs_prepush"],
+                      help="Memory scheduling policy, 'frfcfs_prepush' "
+                           "batches the prepush stream reads of the "
+                           "directories per row behind the demand reads")
+    parser.add_option("--prepush-batch-size", type="int", default=8,
+                      help="Prepush reads to a row issued ahead of the "
+                           "demand reads with 'frfcfs_prepush'")
 
 
     protocol = buildEnv['PROTOCOL']
@@ -191,6 +199,8 @@ def setup_memory_controllers(system, ruby, dir_cntrls, options):
                 options.num_dirs, int(math.log(options.num_dirs, 2)),
                 intlv_size, options.xor_low_bit)
             mem_ctrl = m5.objects.MemCtrl(dram = dram_intf)
+            mem_ctrl.mem_sched_policy = options.mem_sched_policy
+            mem_ctrl.prepush_batch_size = options.prepush_batch_size
 
             if options.access_backing_store:
                 dram_intf.kvm_map=False
@@ -43,3 +43,6 @@ class X86ISA(BaseISA):
 
     vendor_string = Param.String("M5 Simulator",
                                  "Vendor string for CPUID instruction")
+    shared_decode_cache = Param.Bool(False, "Share the decoded pages of "
+        "the x86 decoders across all the threads, and pre-decode the text "
+        "of the SE workloads into them")
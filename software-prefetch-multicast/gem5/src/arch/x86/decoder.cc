@@ -28,7 +28,11 @@
 
 #include "arch/x86/decoder.hh"
 
+#include <cstring>
+#include <mutex>
+
 #include "arch/x86/regs/misc.hh"
+#include "base/loader/memory_image.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "base/types.hh"
@@ -44,7 +48,24 @@ Decoder::doResetState()
 {
     origPC = basePC + offset;
     DPRINTF(Decoder, "Setting origPC to %#x\n", origPC);
-    instBytes = &decodePages->lookup(origPC);
+    instBytes = nullptr;
+    sharedBytes = false;
+    if (sharedPages) {
+        // Our own entries come first, they hold the code rewritten since
+        // the shared pages were decoded.
+        instBytes = decodePages->find(origPC);
+        if (!instBytes || !instBytes->si) {
+            const InstBytes *shared = sharedPages->find(origPC);
+            if (shared && shared->si) {
+                DPRINTF(Decoder, "Using the shared decode cache.\n");
+                // Only read from, see doFromCacheState.
+                instBytes = const_cast<InstBytes *>(shared);
+                sharedBytes = true;
+            }
+        }
+    }
+    if (!sharedBytes)
+        instBytes = &decodePages->lookup(origPC);
     chunkIdx = 0;
 
     name();
@@ -158,6 +179,14 @@ Decoder::doFromCacheState()
     if ((fetchChunk & instBytes->masks[chunkIdx]) !=
             instBytes->chunks[chunkIdx]) {
         DPRINTF(Decoder, "Decode cache miss.\n");
+        if (sharedBytes) {
+            // Leave the shared entry alone and carry on with a copy in our
+            // own pages.
+            InstBytes &own = decodePages->lookup(origPC);
+            own = *instBytes;
+            instBytes = &own;
+            sharedBytes = false;
+        }
         // The chached chunks didn't match what was fetched. Fall back to the
         // predecoder.
         instBytes->chunks[chunkIdx] = fetchChunk;
@@ -790,6 +819,87 @@ Decoder::doImmediateState()
 
 Decoder::InstBytes Decoder::dummy;
 Decoder::InstCacheMap Decoder::instCacheMap;
+bool Decoder::sharedCache = false;
+
+Decoder::SharedDecodePages *
+Decoder::sharedPagesFor(CacheKey key)
+{
+    // The decoders of the threads set their mode concurrently.
+    static std::mutex lock;
+    static std::unordered_map<CacheKey, SharedDecodePages *> pages;
+
+    std::lock_guard<std::mutex> guard(lock);
+    SharedDecodePages *&shared = pages[key];
+    if (!shared)
+        shared = new SharedDecodePages;
+    return shared;
+}
+
+size_t
+Decoder::preDecodeSegment(Addr base, const uint8_t *data, size_t size)
+{
+    const Addr chunkSize = sizeof(MachInst);
+    const Addr end = base + size;
+    PCState pc(base);
+    size_t insts = 0;
+
+    while (pc.instAddr() < end) {
+        reset();
+        Addr fetchPC = pc.instAddr() & ~(chunkSize - 1);
+        while (!instReady()) {
+            // An instruction cut by the end of the segment is left
+            // undecoded, its entry has no StaticInst.
+            if (fetchPC >= end)
+                return insts;
+            // Feed the chunks as fetch does, the bytes out of the segment
+            // read as zeros.
+            uint8_t bytes[sizeof(MachInst)] = {};
+            for (Addr i = 0; i < chunkSize; i++) {
+                if (fetchPC + i >= base && fetchPC + i < end)
+                    bytes[i] = data[fetchPC + i - base];
+            }
+            MachInst chunk;
+            memcpy(&chunk, bytes, sizeof(chunk));
+            moreBytes(pc, fetchPC, chunk);
+            fetchPC += chunkSize;
+        }
+        decode(pc);
+        pc.advance();
+        insts++;
+    }
+    return insts;
+}
+
+void
+Decoder::preDecode(HandyM5Reg m5Reg, const ::Loader::MemoryImage &image)
+{
+    if (!sharedCache)
+        return;
+
+    // Decode a linear sweep of the text in private pages, then publish
+    // them. Like the pages of every decoder, they are never freed. Data
+    // in the text decodes to instructions which are never fetched, which
+    // costs memory but no correctness: an entry is only used when its
+    // bytes match the fetched ones.
+    Decoder decoder;
+    decoder.setM5Reg(m5Reg);
+    decoder.sharedPages = NULL;
+
+    size_t insts = 0;
+    for (const auto &seg : image.segments()) {
+        if (seg.executable && seg.data)
+            insts += decoder.preDecodeSegment(seg.base, seg.data, seg.size);
+    }
+
+    SharedDecodePages *shared = sharedPagesFor(m5Reg);
+    size_t pages = 0;
+    decoder.decodePages->forEachChunk(
+            [shared, &pages](Addr chunk_addr, const InstBytes *items) {
+                pages += shared->publish(chunk_addr, items);
+            });
+    DPRINTFS(Decoder, (&decoder), "Pre-decoded %d instructions, %d pages.\n",
+             insts, pages);
+}
 
 StaticInstPtr
 Decoder::decode(ExtMachInst mach_inst, Addr addr)
@@ -45,6 +45,11 @@
 #include "cpu/static_inst.hh"
 #include "debug/Decoder.hh"
 
+namespace Loader
+{
+class MemoryImage;
+} // namespace Loader
+
 namespace X86ISA
 {
 
@@ -91,6 +96,8 @@ class Decoder : public InstDecoder
     //The bytes to be predecoded
     MachInst fetchChunk;
     InstBytes *instBytes;
+    //Whether instBytes is a published, read only, shared entry
+    bool sharedBytes;
     int chunkIdx;
     //The pc of the start of fetchChunk
     Addr basePC;
@@ -249,6 +256,18 @@ class Decoder : public InstDecoder
             CacheKey, DecodeCache::InstMap<ExtMachInst> *> InstCacheMap;
     static InstCacheMap instCacheMap;
 
+    /// Pages decoded ahead of time, shared by the decoders of every
+    /// thread. A decoder looks at them when its own pages miss and never
+    /// writes to them: a mismatch copies the entry to its own pages.
+    typedef DecodeCache::SharedAddrMap<Decoder::InstBytes> SharedDecodePages;
+    SharedDecodePages *sharedPages;
+    static bool sharedCache;
+    static SharedDecodePages *sharedPagesFor(CacheKey key);
+
+    /// Decode the bytes of a segment in order, into decodePages.
+    /// @retval The number of instructions decoded.
+    size_t preDecodeSegment(Addr base, const uint8_t *data, size_t size);
+
   public:
     Decoder(ISA* isa = nullptr, int thread_id = 0)
         : _name(std::string("decoder") + std::to_string(thread_id)),
@@ -267,10 +286,23 @@ class Decoder : public InstDecoder
         defAddr = 0;
         stack = 0;
         instBytes = &dummy;
+        sharedBytes = false;
         decodePages = NULL;
         instMap = NULL;
+        sharedPages = NULL;
     }
 
+    /// Share the decoded pages across the decoders of all the threads,
+    /// for the decoders which set their mode from now on.
+    static void enableSharedCache() { sharedCache = true; }
+    static bool sharedCacheEnabled() { return sharedCache; }
+
+    /// Decode the executable segments of an image for the given mode and
+    /// publish the result in the shared pages, so that the threads start
+    /// with a warm decode cache.
+    static void preDecode(HandyM5Reg m5Reg,
+                          const ::Loader::MemoryImage &image);
+
     void setM5Reg(HandyM5Reg m5Reg)
     {
         mode = (X86Mode)(uint64_t)m5Reg.mode;
@@ -298,6 +330,9 @@ class Decoder : public InstDecoder
             instMap = new DecodeCache::InstMap<ExtMachInst>;
             instCacheMap[m5Reg] = instMap;
         }
+
+        if (sharedCache)
+            sharedPages = sharedPagesFor(m5Reg);
     }
 
     void takeOverFrom(Decoder *old)
@@ -319,6 +354,9 @@ class Decoder : public InstDecoder
         if (!this->instMap) {
             this->instMap = old->instMap;
         }
+        if (!this->sharedPages) {
+            this->sharedPages = old->sharedPages;
+        }
     }
 
     void reset()
@@ -134,6 +134,8 @@ ISA::ISA(const X86ISAParams &p) : BaseISA(p), vendorString(p.vendor_string)
 {
     fatal_if(vendorString.size() != 12,
              "CPUID vendor string must be 12 characters\n");
+    if (p.shared_decode_cache)
+        Decoder::enableSharedCache();
     clear();
 }
 
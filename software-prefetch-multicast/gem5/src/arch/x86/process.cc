@@ -44,6 +44,7 @@
 #include <string>
 #include <vector>
 
+#include "arch/x86/decoder.hh"
 #include "arch/x86/fs_workload.hh"
 #include "arch/x86/isa_traits.hh"
 #include "arch/x86/regs/misc.hh"
@@ -584,6 +585,15 @@ X86_64Process::initState()
             tc->setMiscReg(MISCREG_MXCSR, 0x1f80);
         }
     }
+
+    // Warm up the decode cache shared by the threads with the text of the
+    // program and of its interpreter, in the mode the threads start in.
+    if (Decoder::sharedCacheEnabled()) {
+        ThreadContext *tc = system->threads[contextIds[0]];
+        HandyM5Reg m5reg = tc->readMiscRegNoEffect(MISCREG_M5_REG);
+        Decoder::preDecode(m5reg, image);
+        Decoder::preDecode(m5reg, interpImage);
+    }
 }
 
 void
@@ -333,8 +333,10 @@ ElfObject::handleLoadableSegment(GElf_Phdr phdr, int seg_num)
         return;
     }
 
-    image.addSegment({ name, phdr.p_paddr, imageData,
-                       phdr.p_offset, phdr.p_filesz });
+    MemoryImage::Segment seg(name, phdr.p_paddr, imageData,
+                             phdr.p_offset, phdr.p_filesz);
+    seg.executable = phdr.p_flags & PF_X;
+    image.addSegment(seg);
     Addr uninitialized = phdr.p_memsz - phdr.p_filesz;
     if (uninitialized) {
         // There may be parts of a segment which aren't included in the
@@ -77,6 +77,8 @@ class MemoryImage
         Addr base = 0;
         const uint8_t *data = nullptr;
         size_t size = 0;
+        // Whether the segment holds code, e.g. for pre-decoding.
+        bool executable = false;
     };
 
     MemoryImage() {}
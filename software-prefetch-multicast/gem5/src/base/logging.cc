@@ -43,6 +43,7 @@
 #include <sstream>
 
 #include "base/hostinfo.hh"
+#include "base/trace.hh"
 
 namespace {
 
@@ -70,6 +71,17 @@ class ExitLogger : public NormalLogger
     }
 };
 
+class PanicLogger : public ExitLogger
+{
+  public:
+    using ExitLogger::ExitLogger;
+
+  protected:
+    // Keep the end of a binary debug trace for the post-mortem, the abort
+    // signal handler cannot write it safely
+    void exit() override { Trace::getDebugLogger()->flush(); }
+};
+
 class FatalLogger : public ExitLogger
 {
   public:
@@ -79,7 +91,7 @@ class FatalLogger : public ExitLogger
     void exit() override { ::exit(1); }
 };
 
-ExitLogger panicLogger("panic: ");
+PanicLogger panicLogger("panic: ");
 FatalLogger fatalLogger("fatal: ");
 NormalLogger warnLogger("warn: ");
 NormalLogger infoLogger("info: ");
@@ -0,0 +1,57 @@
+/* @file
+ * Fixed size slot pools and an allocator for node based containers
+ */
+
+#include "base/pool_allocator.hh"
+
+#include <algorithm>
+
+namespace
+{
+
+size_t
+slotSizeFor(size_t size)
+{
+    const size_t align = alignof(std::max_align_t);
+    size = std::max(size, sizeof(void *));
+    return (size + align - 1) / align * align;
+}
+
+} // anonymous namespace
+
+SlotPool::SlotPool(size_t slot_size, size_t slab_slots)
+    : _slotSize(slotSizeFor(slot_size)), slabSlots(slab_slots),
+      freeList(nullptr), _capacity(0), _inUse(0)
+{
+}
+
+SlotPool::~SlotPool()
+{
+    if (_inUse)
+        return;
+
+    for (char *slab : slabs)
+        ::operator delete(slab);
+}
+
+void
+SlotPool::reserve(size_t slots)
+{
+    if (slots > _capacity)
+        grow(slots - _capacity);
+}
+
+void
+SlotPool::grow(size_t slots)
+{
+    char *slab = static_cast<char *>(::operator new(slots * _slotSize));
+    slabs.push_back(slab);
+
+    // Thread the slots so that they are handed out in address order
+    for (size_t i = slots; i > 0; i--) {
+        Free *slot = reinterpret_cast<Free *>(slab + (i - 1) * _slotSize);
+        slot->next = freeList;
+        freeList = slot;
+    }
+    _capacity += slots;
+}
@@ -0,0 +1,151 @@
+/* @file
+ * Fixed size slot pools and an allocator for node based containers
+ */
+
+#ifndef __BASE_POOL_ALLOCATOR_HH__
+#define __BASE_POOL_ALLOCATOR_HH__
+
+#include <cstddef>
+#include <list>
+#include <new>
+#include <vector>
+
+/**
+ * Slabs of fixed size slots threaded on a free list. A slot is handed
+ * out and returned in constant time and slots are never returned to the
+ * system: once the pool holds as many slots as the peak number of
+ * objects alive, it does not allocate anymore.
+ *
+ * A pool is not thread safe, it belongs to the objects of a thread.
+ */
+class SlotPool
+{
+  public:
+    /**
+     * @param slot_size Size of the objects held, rounded up so that every
+     *        slot is suitably aligned for any type
+     * @param slab_slots Slots added when the free list runs dry
+     */
+    explicit SlotPool(size_t slot_size, size_t slab_slots = 256);
+
+    /** Slots still in use are leaked rather than freed under them */
+    ~SlotPool();
+
+    SlotPool(const SlotPool &) = delete;
+    SlotPool &operator=(const SlotPool &) = delete;
+
+    void *
+    allocate()
+    {
+        if (!freeList)
+            grow(slabSlots);
+
+        Free *slot = freeList;
+        freeList = slot->next;
+        _inUse++;
+        return slot;
+    }
+
+    void
+    release(void *ptr)
+    {
+        Free *slot = static_cast<Free *>(ptr);
+        slot->next = freeList;
+        freeList = slot;
+        _inUse--;
+    }
+
+    /** Grows the pool to hold at least slots slots */
+    void reserve(size_t slots);
+
+    size_t slotSize() const { return _slotSize; }
+    size_t capacity() const { return _capacity; }
+    size_t inUse() const { return _inUse; }
+
+  private:
+    struct Free
+    {
+        Free *next;
+    };
+
+    void grow(size_t slots);
+
+    const size_t _slotSize;
+    const size_t slabSlots;
+
+    Free *freeList;
+    std::vector<char *> slabs;
+
+    size_t _capacity;
+    size_t _inUse;
+};
+
+/**
+ * The pool of the calling thread for objects of the given size. The pool
+ * is never destroyed, so that objects of static containers can still
+ * return their slots at exit.
+ */
+template <size_t Size>
+SlotPool &
+threadSlotPool()
+{
+    static thread_local SlotPool *pool = new SlotPool(Size);
+    return *pool;
+}
+
+/**
+ * Allocator drawing the single object allocations, i.e. the nodes of a
+ * std::list or the shared block of std::allocate_shared, from the slot
+ * pool of the thread. Larger allocations go to operator new.
+ */
+template <class T>
+class PoolAllocator
+{
+  public:
+    typedef T value_type;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "Pool slots are only aligned for the fundamental types");
+
+    PoolAllocator() = default;
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U> &) {}
+
+    T *
+    allocate(size_t n)
+    {
+        if (n == 1)
+            return static_cast<T *>(threadSlotPool<sizeof(T)>().allocate());
+        return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T *ptr, size_t n)
+    {
+        if (n == 1)
+            threadSlotPool<sizeof(T)>().release(ptr);
+        else
+            ::operator delete(ptr);
+    }
+};
+
+template <class T, class U>
+bool
+operator==(const PoolAllocator<T> &, const PoolAllocator<U> &)
+{
+    return true;
+}
+
+template <class T, class U>
+bool
+operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &)
+{
+    return false;
+}
+
+/** A std::list whose nodes come from the slot pool of the thread */
+template <class T>
+using PooledList = std::list<T, PoolAllocator<T>>;
+
+#endif // __BASE_POOL_ALLOCATOR_HH__
@@ -0,0 +1,101 @@
+/* @file
+ * SlotPool and PoolAllocator tests
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+
+#include "base/pool_allocator.hh"
+
+TEST(SlotPoolTest, SlotSize)
+{
+    SlotPool small(1);
+    EXPECT_EQ(small.slotSize(), alignof(std::max_align_t));
+
+    SlotPool odd(alignof(std::max_align_t) + 1);
+    EXPECT_EQ(odd.slotSize(), 2 * alignof(std::max_align_t));
+}
+
+TEST(SlotPoolTest, ReuseLastReleased)
+{
+    SlotPool pool(24, 4);
+    void *a = pool.allocate();
+    void *b = pool.allocate();
+    EXPECT_NE(a, b);
+    EXPECT_EQ(pool.inUse(), 2u);
+    EXPECT_EQ(pool.capacity(), 4u);
+
+    pool.release(a);
+    EXPECT_EQ(pool.allocate(), a);
+    pool.release(b);
+    pool.release(a);
+    EXPECT_EQ(pool.inUse(), 0u);
+}
+
+TEST(SlotPoolTest, Growth)
+{
+    SlotPool pool(8, 2);
+    pool.reserve(10);
+    EXPECT_EQ(pool.capacity(), 10u);
+
+    std::vector<void *> slots;
+    for (int i = 0; i < 11; i++) {
+        slots.push_back(pool.allocate());
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(slots.back()) %
+                  alignof(std::max_align_t), 0u);
+    }
+    EXPECT_EQ(pool.capacity(), 12u);
+    EXPECT_EQ(pool.inUse(), 11u);
+
+    for (void *slot : slots)
+        pool.release(slot);
+    EXPECT_EQ(pool.capacity(), 12u);
+}
+
+TEST(PoolAllocatorTest, SingleObjects)
+{
+    struct Object { char bytes[40]; };
+
+    PoolAllocator<Object> alloc;
+    Object *a = alloc.allocate(1);
+    EXPECT_EQ(threadSlotPool<sizeof(Object)>().inUse(), 1u);
+    alloc.deallocate(a, 1);
+    EXPECT_EQ(threadSlotPool<sizeof(Object)>().inUse(), 0u);
+    EXPECT_EQ(alloc.allocate(1), a);
+    alloc.deallocate(a, 1);
+
+    // Arrays are not pooled
+    Object *array = alloc.allocate(3);
+    EXPECT_EQ(threadSlotPool<sizeof(Object)>().inUse(), 0u);
+    alloc.deallocate(array, 3);
+}
+
+TEST(PoolAllocatorTest, PooledList)
+{
+    PooledList<int> list;
+    for (int i = 0; i < 1000; i++)
+        list.push_back(i);
+    list.remove_if([](int i) { return i % 2; });
+    for (int i = 0; i < 10; i++)
+        list.push_front(-i);
+
+    EXPECT_EQ(list.size(), 510u);
+    EXPECT_EQ(list.front(), -9);
+    EXPECT_EQ(list.back(), 998);
+
+    PooledList<int> other;
+    other.splice(other.end(), list, list.begin());
+    EXPECT_EQ(other.front(), -9);
+}
+
+TEST(PoolAllocatorTest, AllocateShared)
+{
+    auto ptr = std::allocate_shared<uint64_t>(PoolAllocator<uint64_t>(), 42);
+    EXPECT_EQ(*ptr, 42u);
+
+    std::weak_ptr<uint64_t> weak = ptr;
+    ptr.reset();
+    EXPECT_TRUE(weak.expired());
+}
@@ -0,0 +1,59 @@
+/* @file
+ * Ring buffer of statistics samples with a compact binary output
+ */
+
+#include "base/stats/timeseries.hh"
+
+#include <cassert>
+
+namespace Stats
+{
+
+constexpr char TimeSeries::Magic[];
+
+namespace
+{
+
+template <class T>
+void
+writeRaw(std::ostream &os, const T &value)
+{
+    os.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+} // anonymous namespace
+
+TimeSeries::TimeSeries(const std::vector<std::string> &columns,
+                       size_t capacity, uint64_t frequency)
+    : names(columns), frequency(frequency), ticks(capacity),
+      values(capacity * columns.size()), head(0), count(0), _dropped(0),
+      headerWritten(false)
+{
+    assert(capacity > 0);
+}
+
+void
+TimeSeries::write(std::ostream &os)
+{
+    if (!headerWritten) {
+        os.write(Magic, sizeof(Magic) - 1);
+        writeRaw(os, frequency);
+        writeRaw(os, uint32_t(names.size()));
+        for (const auto &name : names) {
+            writeRaw(os, uint32_t(name.size()));
+            os.write(name.data(), name.size());
+        }
+        headerWritten = true;
+    }
+
+    const size_t width = names.size();
+    for (; count; count--) {
+        writeRaw(os, uint64_t(ticks[head]));
+        os.write(reinterpret_cast<const char *>(&values[head * width]),
+                 width * sizeof(double));
+        head = head + 1 == ticks.size() ? 0 : head + 1;
+    }
+    os.flush();
+}
+
+} // namespace Stats
@@ -0,0 +1,97 @@
+/* @file
+ * Ring buffer of statistics samples with a compact binary output
+ */
+
+#ifndef __BASE_STATS_TIMESERIES_HH__
+#define __BASE_STATS_TIMESERIES_HH__
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace Stats
+{
+
+/**
+ * Samples of a fixed set of columns, held in a ring buffer allocated
+ * once. Appending a sample never allocates: when the buffer is full, the
+ * oldest sample not written yet is dropped.
+ *
+ * The samples are written in the byte order of the host:
+ *   char magic[8] = "M5TSER01"
+ *   uint64_t ticks per second
+ *   uint32_t number of columns
+ *   per column: uint32_t length, then the characters of its name
+ * followed by the samples written so far, each one
+ *   uint64_t tick
+ *   double value per column
+ * so that a file can be decoded while the simulation still appends to it.
+ */
+class TimeSeries
+{
+  public:
+    static constexpr char Magic[] = "M5TSER01";
+
+    /**
+     * @param columns Names of the columns
+     * @param capacity Samples held between two writes
+     * @param frequency Ticks per second, for the decoders
+     */
+    TimeSeries(const std::vector<std::string> &columns, size_t capacity,
+               uint64_t frequency);
+
+    size_t columns() const { return names.size(); }
+    size_t capacity() const { return ticks.size(); }
+
+    /** Samples not written yet */
+    size_t pending() const { return count; }
+
+    /** Samples dropped because the buffer was full */
+    uint64_t dropped() const { return _dropped; }
+
+    /** The row of a new sample at tick, to fill with columns() values */
+    double *
+    append(Tick tick)
+    {
+        size_t slot = head + count;
+        if (slot >= ticks.size())
+            slot -= ticks.size();
+
+        if (count == ticks.size()) {
+            // Full, overwrite the oldest sample
+            head = head + 1 == ticks.size() ? 0 : head + 1;
+            _dropped++;
+        } else {
+            count++;
+        }
+
+        ticks[slot] = tick;
+        return &values[slot * names.size()];
+    }
+
+    /**
+     * Write the pending samples, after the header on the first call, and
+     * empty the buffer
+     */
+    void write(std::ostream &os);
+
+  private:
+    const std::vector<std::string> names;
+    const uint64_t frequency;
+
+    std::vector<Tick> ticks;
+    std::vector<double> values;
+
+    /** Slot of the oldest pending sample */
+    size_t head;
+    size_t count;
+    uint64_t _dropped;
+    bool headerWritten;
+};
+
+} // namespace Stats
+
+#endif // __BASE_STATS_TIMESERIES_HH__
@@ -0,0 +1,127 @@
+/* @file
+ * TimeSeries tests
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/stats/timeseries.hh"
+
+using namespace Stats;
+
+namespace
+{
+
+struct Decoded
+{
+    uint64_t frequency = 0;
+    std::vector<std::string> columns;
+    std::vector<uint64_t> ticks;
+    std::vector<std::vector<double>> rows;
+};
+
+template <class T>
+T
+readRaw(std::istream &is)
+{
+    T value;
+    is.read(reinterpret_cast<char *>(&value), sizeof(value));
+    return value;
+}
+
+Decoded
+decode(const std::string &data)
+{
+    std::istringstream is(data);
+    Decoded d;
+
+    char magic[8];
+    is.read(magic, sizeof(magic));
+    EXPECT_EQ(std::memcmp(magic, TimeSeries::Magic, sizeof(magic)), 0);
+
+    d.frequency = readRaw<uint64_t>(is);
+    uint32_t columns = readRaw<uint32_t>(is);
+    for (uint32_t i = 0; i < columns; i++) {
+        std::string name(readRaw<uint32_t>(is), '\0');
+        is.read(&name[0], name.size());
+        d.columns.push_back(name);
+    }
+
+    while (true) {
+        uint64_t tick = readRaw<uint64_t>(is);
+        if (!is)
+            break;
+        std::vector<double> row(columns);
+        for (auto &value : row)
+            value = readRaw<double>(is);
+        d.ticks.push_back(tick);
+        d.rows.push_back(row);
+    }
+    return d;
+}
+
+} // anonymous namespace
+
+TEST(TimeSeriesTest, HeaderAndSamples)
+{
+    TimeSeries series({"a", "system.b::vnet-1"}, 4, 1000);
+    double *row = series.append(10);
+    row[0] = 1;
+    row[1] = 2.5;
+    row = series.append(20);
+    row[0] = 3;
+    row[1] = 4;
+    EXPECT_EQ(series.pending(), 2u);
+
+    std::ostringstream os;
+    series.write(os);
+    EXPECT_EQ(series.pending(), 0u);
+
+    Decoded d = decode(os.str());
+    EXPECT_EQ(d.frequency, 1000u);
+    ASSERT_EQ(d.columns.size(), 2u);
+    EXPECT_EQ(d.columns[1], "system.b::vnet-1");
+    ASSERT_EQ(d.ticks.size(), 2u);
+    EXPECT_EQ(d.ticks[1], 20u);
+    EXPECT_EQ(d.rows[0][1], 2.5);
+    EXPECT_EQ(d.rows[1][0], 3);
+}
+
+TEST(TimeSeriesTest, IncrementalWrites)
+{
+    TimeSeries series({"a"}, 2, 1);
+    std::ostringstream os;
+
+    // The header goes out once, the samples follow each other
+    for (int i = 0; i < 5; i++) {
+        series.append(i)[0] = i;
+        series.write(os);
+    }
+
+    Decoded d = decode(os.str());
+    ASSERT_EQ(d.ticks.size(), 5u);
+    for (int i = 0; i < 5; i++)
+        EXPECT_EQ(d.rows[i][0], i);
+    EXPECT_EQ(series.dropped(), 0u);
+}
+
+TEST(TimeSeriesTest, DropOldest)
+{
+    TimeSeries series({"a"}, 3, 1);
+    for (int i = 0; i < 7; i++)
+        series.append(i)[0] = 10 * i;
+    EXPECT_EQ(series.pending(), 3u);
+    EXPECT_EQ(series.dropped(), 4u);
+
+    std::ostringstream os;
+    series.write(os);
+    Decoded d = decode(os.str());
+    ASSERT_EQ(d.ticks.size(), 3u);
+    EXPECT_EQ(d.ticks[0], 4u);
+    EXPECT_EQ(d.rows[2][0], 60);
+}
@@ -32,6 +32,7 @@
 #include "base/trace.hh"
 
 #include <cctype>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -42,6 +43,7 @@
 #include "base/logging.hh"
 #include "base/output.hh"
 #include "base/str.hh"
+#include "base/trace_file.hh"
 #include "debug/FmtFlag.hh"
 #include "debug/FmtStackTrace.hh"
 #include "debug/FmtTicksOff.hh"
@@ -168,4 +170,77 @@ OstreamLogger::logMessage(Tick when, const std::string &name,
     }
 }
 
+BinaryLogger::BinaryLogger(std::ostream &stream)
+    : RecordEncoder(256 * 1024),
+      // The fastest compression, which still shrinks the records several
+      // times as they repeat a lot
+      writer(new BlockWriter(stream, 1, 4)),
+      textBuf(*this), textStream(&textBuf)
+{
+    encoder = this;
+
+    // The loggers are never deleted, write out the trace on exit and
+    // fatal errors, panics flush it before aborting
+    static bool registered = false;
+    if (!registered) {
+        std::atexit([]() { getDebugLogger()->flush(); });
+        registered = true;
+    }
+}
+
+BinaryLogger::~BinaryLogger()
+{
+    flush();
+}
+
+uint8_t
+BinaryLogger::style(Tick when, const std::string &flag)
+{
+    uint8_t record_style = 0;
+    if (!DTRACE(FmtTicksOff) && (when != MaxTick))
+        record_style |= Record::ShowTick;
+    if (DTRACE(FmtFlag))
+        record_style |= Record::ShowFlag;
+    return record_style;
+}
+
+void
+BinaryLogger::commit(std::string &block)
+{
+    writer->push(block);
+}
+
+void
+BinaryLogger::logMessage(Tick when, const std::string &name,
+        const std::string &flag, const std::string &message)
+{
+    if (!name.empty() && ignore.match(name))
+        return;
+
+    text(when, name, flag, message);
+}
+
+void
+BinaryLogger::flush()
+{
+    // A panic of the writer itself cannot wait for it
+    if (writer->onWriterThread())
+        return;
+
+    textStream.flush();
+    commitBlock();
+    writer->drain();
+}
+
+int
+BinaryLogger::TextBuf::sync()
+{
+    std::string message = str();
+    if (!message.empty()) {
+        encoder.text(MaxTick, std::string(), std::string(), message);
+        str(std::string());
+    }
+    return 0;
+}
+
 } // namespace Trace
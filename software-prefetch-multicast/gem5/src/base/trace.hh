@@ -32,11 +32,14 @@
 #ifndef __BASE_TRACE_HH__
 #define __BASE_TRACE_HH__
 
+#include <memory>
+#include <sstream>
 #include <string>
 
 #include "base/cprintf.hh"
 #include "base/debug.hh"
 #include "base/match.hh"
+#include "base/trace_record.hh"
 #include "base/types.hh"
 #include "sim/core.hh"
 
@@ -50,6 +53,9 @@ class Logger
     /** Name match for objects to ignore */
     ObjectMatch ignore;
 
+    /** Set by the loggers recording the messages without formatting them */
+    RecordEncoder *encoder = nullptr;
+
   public:
     /** Log a single message */
     template <typename ...Args>
@@ -67,6 +73,10 @@ class Logger
     {
         if (!name.empty() && ignore.match(name))
             return;
+        if (encoder) {
+            encoder->record(when, name, flag, fmt, args...);
+            return;
+        }
         std::ostringstream line;
         ccprintf(line, fmt, args...);
         logMessage(when, name, flag, line.str());
@@ -93,6 +103,9 @@ class Logger
     /** Add objects to ignore */
     void addIgnore(const ObjectMatch &ignore_) { ignore.add(ignore_); }
 
+    /** Write out the messages the logger may still be holding */
+    virtual void flush() { }
+
     virtual ~Logger() { }
 };
 
@@ -113,6 +126,46 @@ class OstreamLogger : public Logger
     std::ostream &getOstream() override { return stream; }
 };
 
+class BlockWriter;
+
+/** Logging to a compressed binary trace file, see Trace::RecordEncoder
+ *  and Trace::BlockWriter. The file is rendered as the text an
+ *  OstreamLogger would print by decodeTraceFile() */
+class BinaryLogger : public Logger, public RecordEncoder
+{
+  protected:
+    /** Records what is written to getOstream() as text, line by line */
+    class TextBuf : public std::stringbuf
+    {
+      public:
+        TextBuf(RecordEncoder &encoder) : encoder(encoder) { }
+
+      protected:
+        int sync() override;
+
+      private:
+        RecordEncoder &encoder;
+    };
+
+    std::unique_ptr<BlockWriter> writer;
+    TextBuf textBuf;
+    std::ostream textStream;
+
+    uint8_t style(Tick when, const std::string &flag) override;
+    void commit(std::string &block) override;
+
+  public:
+    BinaryLogger(std::ostream &stream);
+    ~BinaryLogger();
+
+    void logMessage(Tick when, const std::string &name,
+            const std::string &flag, const std::string &message) override;
+
+    std::ostream &getOstream() override { return textStream; }
+
+    void flush() override;
+};
+
 /** Get the current global debug logger.  This takes ownership of the given
  *  logger which should be allocated using 'new' */
 Logger *getDebugLogger();
@@ -0,0 +1,120 @@
+/* @file
+ * Compressed files of debug trace records
+ */
+
+#include "base/trace_file.hh"
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "base/logging.hh"
+#include "base/trace_record.hh"
+
+namespace Trace {
+
+BlockWriter::BlockWriter(std::ostream &os, int level, size_t max_pending)
+    : os(os), level(level), maxPending(max_pending), busy(false),
+      exiting(false)
+{
+    os.write(TraceFileMagic, sizeof(TraceFileMagic) - 1);
+    thread = std::thread([this]() { run(); });
+}
+
+BlockWriter::~BlockWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    queued.notify_one();
+    thread.join();
+}
+
+void
+BlockWriter::push(std::string &block)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this]() { return pending.size() < maxPending; });
+    pending.emplace_back();
+    pending.back().swap(block);
+    lock.unlock();
+    queued.notify_one();
+}
+
+void
+BlockWriter::drain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this]() { return pending.empty() && !busy; });
+}
+
+void
+BlockWriter::run()
+{
+    std::vector<Bytef> compressed;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        queued.wait(lock, [this]() { return exiting || !pending.empty(); });
+        // The queue is drained before exiting
+        if (pending.empty())
+            return;
+
+        std::string block;
+        block.swap(pending.front());
+        pending.pop_front();
+        busy = true;
+        lock.unlock();
+
+        uLongf size = compressBound(block.size());
+        compressed.resize(size);
+        int ret = compress2(compressed.data(), &size,
+                            reinterpret_cast<const Bytef *>(block.data()),
+                            block.size(), level);
+        panic_if(ret != Z_OK, "Failed to compress a debug trace block: %d",
+                 ret);
+
+        uint32_t header[2] = { uint32_t(block.size()), uint32_t(size) };
+        os.write(reinterpret_cast<const char *>(header), sizeof(header));
+        os.write(reinterpret_cast<const char *>(compressed.data()), size);
+        os.flush();
+
+        lock.lock();
+        busy = false;
+        written.notify_all();
+    }
+}
+
+bool
+decodeTraceFile(std::istream &is, std::ostream &os)
+{
+    char magic[sizeof(TraceFileMagic) - 1];
+    if (!is.read(magic, sizeof(magic)) ||
+        std::memcmp(magic, TraceFileMagic, sizeof(magic)) != 0) {
+        return false;
+    }
+
+    RecordDecoder decoder(os);
+    std::vector<Bytef> compressed;
+    std::vector<char> block;
+    uint32_t header[2];
+    while (is.read(reinterpret_cast<char *>(header), sizeof(header))) {
+        compressed.resize(header[1]);
+        block.resize(header[0]);
+        if (!is.read(reinterpret_cast<char *>(compressed.data()), header[1]))
+            return false;
+
+        uLongf size = header[0];
+        if (uncompress(reinterpret_cast<Bytef *>(block.data()), &size,
+                       compressed.data(), header[1]) != Z_OK ||
+            size != header[0] || !decoder.decode(block.data(), size)) {
+            return false;
+        }
+    }
+    // A partial block header is a truncated file
+    return is.gcount() == 0;
+}
+
+} // namespace Trace
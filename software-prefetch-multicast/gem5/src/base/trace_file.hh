@@ -0,0 +1,82 @@
+/* @file
+ * Compressed files of debug trace records
+ */
+
+#ifndef __BASE_TRACE_FILE_HH__
+#define __BASE_TRACE_FILE_HH__
+
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+namespace Trace {
+
+/**
+ * A trace file starts with the magic, followed by the blocks of records
+ * of a Trace::RecordEncoder, each one
+ *   uint32_t size of the records
+ *   uint32_t size of the compressed records
+ *   the records compressed by zlib
+ * in the byte order of the host.
+ */
+constexpr char TraceFileMagic[] = "M5TRACE1";
+
+/**
+ * Compresses and writes the blocks of records in a thread of its own,
+ * so that the simulation only pays for encoding them. At most a few
+ * blocks wait for the thread: the simulation stalls rather than growing
+ * the memory when the disk does not keep up.
+ */
+class BlockWriter
+{
+  public:
+    /** @param level zlib compression level, from 1 (fastest) to 9 */
+    BlockWriter(std::ostream &os, int level, size_t max_pending);
+    ~BlockWriter();
+
+    /** Queue a block, which is taken from the string */
+    void push(std::string &block);
+
+    /** Wait until the queued blocks are written */
+    void drain();
+
+    /** Whether the caller is the thread writing the blocks */
+    bool
+    onWriterThread() const
+    {
+        return std::this_thread::get_id() == thread.get_id();
+    }
+
+  private:
+    void run();
+
+    std::ostream &os;
+    const int level;
+    const size_t maxPending;
+
+    std::mutex mutex;
+    /** Signaled when a block is queued or on exit */
+    std::condition_variable queued;
+    /** Signaled when a block is written */
+    std::condition_variable written;
+    std::deque<std::string> pending;
+    /** The thread is compressing a block taken from pending */
+    bool busy;
+    bool exiting;
+
+    std::thread thread;
+};
+
+/**
+ * Render a trace file as text
+ * @return false if the file is truncated or malformed
+ */
+bool decodeTraceFile(std::istream &is, std::ostream &os);
+
+} // namespace Trace
+
+#endif // __BASE_TRACE_FILE_HH__
@@ -0,0 +1,255 @@
+/* @file
+ * Structured binary records of debug messages
+ */
+
+#include "base/trace_record.hh"
+
+#include "base/cprintf.hh"
+
+namespace Trace {
+
+RecordEncoder::RecordEncoder(size_t block_size)
+    : blockSize(block_size), lastTick(0)
+{
+    block.reserve(blockSize + blockSize / 4);
+}
+
+uint32_t
+RecordEncoder::stringId(const std::string &str)
+{
+    auto it = strings.find(str);
+    if (it != strings.end())
+        return it->second;
+
+    uint32_t id = strings.size();
+    strings.emplace(str, id);
+    block.push_back(char(Record::DefineString));
+    putString(str.data(), str.size());
+    return id;
+}
+
+uint32_t
+RecordEncoder::formatId(const char *fmt)
+{
+    auto it = formats.find(fmt);
+    if (M5_LIKELY(it != formats.end()) &&
+        std::strcmp(it->second->first.c_str(), fmt) == 0) {
+        return it->second->second;
+    }
+
+    uint32_t id = stringId(fmt);
+    formats[fmt] = &*strings.find(fmt);
+    return id;
+}
+
+void
+RecordEncoder::header(Record::Kind kind, Tick when, const std::string &name,
+                      const std::string &flag)
+{
+    // The strings are defined ahead of the record using them
+    uint32_t flag_id = flag.empty() ? 0 : stringId(flag) + 1;
+    uint32_t name_id = name.empty() ? 0 : stringId(name) + 1;
+    uint8_t record_style = style(when, flag);
+
+    block.push_back(char(kind));
+    block.push_back(char(record_style));
+    if (record_style & Record::ShowTick) {
+        int64_t delta = when - lastTick;
+        putVarint((uint64_t(delta) << 1) ^ uint64_t(delta >> 63));
+        lastTick = when;
+    }
+    putVarint(flag_id);
+    putVarint(name_id);
+}
+
+void
+RecordEncoder::text(Tick when, const std::string &name,
+                    const std::string &flag, const std::string &message)
+{
+    header(Record::Text, when, name, flag);
+    putString(message.data(), message.size());
+    endRecord();
+}
+
+void
+RecordEncoder::commitBlock()
+{
+    if (!block.empty()) {
+        commit(block);
+        block.clear();
+    }
+}
+
+namespace {
+
+/** Reads the fields of a block, failing on the first overrun */
+class Reader
+{
+  public:
+    Reader(const char *data, size_t size)
+        : ptr(data), end(data + size), ok(true)
+    { }
+
+    bool more() const { return ok && ptr < end; }
+    bool good() const { return ok; }
+
+    uint8_t
+    byte()
+    {
+        if (ptr >= end) {
+            ok = false;
+            return 0;
+        }
+        return *ptr++;
+    }
+
+    uint64_t
+    varint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            value |= uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return value;
+        }
+        ok = false;
+        return value;
+    }
+
+    std::string
+    string()
+    {
+        uint64_t len = varint();
+        if (!ok || len > uint64_t(end - ptr)) {
+            ok = false;
+            return std::string();
+        }
+        std::string str(ptr, len);
+        ptr += len;
+        return str;
+    }
+
+    template <typename T>
+    T
+    raw()
+    {
+        T value = T();
+        if (sizeof(T) > size_t(end - ptr)) {
+            ok = false;
+            return value;
+        }
+        std::memcpy(&value, ptr, sizeof(T));
+        ptr += sizeof(T);
+        return value;
+    }
+
+  private:
+    const char *ptr;
+    const char *end;
+    bool ok;
+};
+
+/** Format the next argument of a record with its original type */
+bool
+formatArg(cp::Print &print, Reader &reader)
+{
+    switch (reader.byte()) {
+      case Record::Bool:
+        print.add_arg(reader.raw<bool>());
+        break;
+      case Record::Char:
+        print.add_arg(reader.raw<char>());
+        break;
+      case Record::UChar:
+        print.add_arg(reader.raw<unsigned char>());
+        break;
+      case Record::Int16:
+        print.add_arg(reader.raw<short>());
+        break;
+      case Record::UInt16:
+        print.add_arg(reader.raw<unsigned short>());
+        break;
+      case Record::Int32:
+        print.add_arg(reader.raw<int>());
+        break;
+      case Record::UInt32:
+        print.add_arg(reader.raw<unsigned int>());
+        break;
+      case Record::Int64:
+        print.add_arg(reader.raw<int64_t>());
+        break;
+      case Record::UInt64:
+        print.add_arg(reader.raw<uint64_t>());
+        break;
+      case Record::Double:
+        print.add_arg(reader.raw<double>());
+        break;
+      case Record::String:
+        print.add_arg(reader.string());
+        break;
+      default:
+        return false;
+    }
+    return reader.good();
+}
+
+} // anonymous namespace
+
+bool
+RecordDecoder::decode(const char *data, size_t size)
+{
+    Reader reader(data, size);
+    std::ostringstream line;
+
+    while (reader.more()) {
+        uint8_t kind = reader.byte();
+        if (kind == Record::DefineString) {
+            strings.push_back(reader.string());
+            continue;
+        }
+        if (kind != Record::Print && kind != Record::Text)
+            return false;
+
+        uint8_t record_style = reader.byte();
+        if (record_style & Record::ShowTick) {
+            uint64_t zigzag = reader.varint();
+            lastTick += int64_t(zigzag >> 1) ^ -int64_t(zigzag & 1);
+        }
+        uint64_t flag_id = reader.varint();
+        uint64_t name_id = reader.varint();
+        if (flag_id > strings.size() || name_id > strings.size())
+            return false;
+
+        line.str("");
+        if (kind == Record::Print) {
+            uint64_t fmt_id = reader.varint();
+            uint64_t args = reader.varint();
+            if (fmt_id >= strings.size())
+                return false;
+
+            cp::Print print(line, strings[fmt_id]);
+            for (uint64_t i = 0; i < args; i++) {
+                if (!formatArg(print, reader))
+                    return false;
+            }
+            print.end_args();
+        } else {
+            line << reader.string();
+        }
+        if (!reader.good())
+            return false;
+
+        // As Trace::OstreamLogger::logMessage prints it
+        if (record_style & Record::ShowTick)
+            ccprintf(os, "%7d: ", lastTick);
+        if ((record_style & Record::ShowFlag) && flag_id)
+            os << strings[flag_id - 1] << ": ";
+        if (name_id)
+            os << strings[name_id - 1] << ": ";
+        os << line.str();
+    }
+    return reader.good();
+}
+
+} // namespace Trace
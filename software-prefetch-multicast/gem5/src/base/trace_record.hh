@@ -0,0 +1,299 @@
+/* @file
+ * Structured binary records of debug messages
+ */
+
+#ifndef __BASE_TRACE_RECORD_HH__
+#define __BASE_TRACE_RECORD_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/compiler.hh"
+#include "base/types.hh"
+
+namespace Trace {
+
+/**
+ * The debug messages are encoded as records instead of text: a message
+ * keeps the id of its format string and its arguments, which the
+ * decoder formats with the same cprintf to render the text trace. The
+ * strings (formats, object names and debug flags) are defined in the
+ * stream the first time they are used. Every record starts with its
+ * kind:
+ *   DefineString: varint length, characters
+ *   Print: header, varint format id, varint number of arguments, then
+ *          per argument a type byte and its value, in the byte order of
+ *          the host
+ *   Text:  header, varint length, characters of the formatted message
+ * where the header is a style byte, the zigzag varint difference with
+ * the tick of the previous record when the tick is shown, then the
+ * varint flag and name ids plus one, 0 meaning none.
+ */
+namespace Record {
+
+enum Kind : uint8_t
+{
+    DefineString,
+    Print,
+    Text,
+};
+
+enum Style : uint8_t
+{
+    ShowTick = 0x1,
+    ShowFlag = 0x2,
+};
+
+/** Types of the arguments, which cprintf formats differently */
+enum ArgType : uint8_t
+{
+    Bool,
+    Char,
+    UChar,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Double,
+    String,
+};
+
+/**
+ * Whether a type has a stream operator of its own, rather than printing
+ * as the integer it converts to
+ */
+template <typename T, typename = void>
+struct HasStreamOperator : std::false_type { };
+
+template <typename T>
+struct HasStreamOperator<T, decltype(void(operator<<(
+    std::declval<std::ostream &>(), std::declval<const T &>())))>
+    : std::true_type { };
+
+/** The integer type holding the values of an integer or enum type */
+template <typename T, bool = std::is_enum<T>::value>
+struct IntegerOf { typedef typename std::underlying_type<T>::type type; };
+
+template <typename T>
+struct IntegerOf<T, false> { typedef T type; };
+
+} // namespace Record
+
+/**
+ * Encodes the debug messages in blocks of records, which are handed to
+ * commit() when they grow over the block size. A block always ends with
+ * a whole record.
+ */
+class RecordEncoder
+{
+  public:
+    RecordEncoder(size_t block_size);
+    virtual ~RecordEncoder() { }
+
+    /** Encode a message, without formatting it */
+    template <typename ...Args>
+    void
+    record(Tick when, const std::string &name, const std::string &flag,
+           const char *fmt, const Args &...args)
+    {
+        uint32_t fmt_id = formatId(fmt);
+        header(Record::Print, when, name, flag);
+        putVarint(fmt_id);
+        putVarint(sizeof...(Args));
+        putArgs(args...);
+        endRecord();
+    }
+
+    /** Encode an already formatted message */
+    void text(Tick when, const std::string &name, const std::string &flag,
+              const std::string &message);
+
+  protected:
+    /** The Record::Style of a message, as the text logger would print it */
+    virtual uint8_t style(Tick when, const std::string &flag) = 0;
+
+    /** Take the content of a block of records */
+    virtual void commit(std::string &block) = 0;
+
+    /** Commit the records encoded so far */
+    void commitBlock();
+
+  private:
+    void
+    putVarint(uint64_t value)
+    {
+        while (value >= 0x80) {
+            block.push_back(char(value | 0x80));
+            value >>= 7;
+        }
+        block.push_back(char(value));
+    }
+
+    void
+    putString(const char *str, size_t len)
+    {
+        putVarint(len);
+        block.append(str, len);
+    }
+
+    template <typename T>
+    void
+    putRaw(Record::ArgType type, T value)
+    {
+        block.push_back(char(type));
+        block.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void putArg(bool v) { putRaw(Record::Bool, v); }
+    void putArg(char v) { putRaw(Record::Char, v); }
+    void putArg(signed char v) { putRaw(Record::Char, char(v)); }
+    void putArg(unsigned char v) { putRaw(Record::UChar, v); }
+    void putArg(short v) { putRaw(Record::Int16, v); }
+    void putArg(unsigned short v) { putRaw(Record::UInt16, v); }
+    void putArg(int v) { putRaw(Record::Int32, v); }
+    void putArg(unsigned int v) { putRaw(Record::UInt32, v); }
+    void putArg(long v) { putRaw(Record::Int64, int64_t(v)); }
+    void putArg(unsigned long v) { putRaw(Record::UInt64, uint64_t(v)); }
+    void putArg(long long v) { putRaw(Record::Int64, int64_t(v)); }
+    void
+    putArg(unsigned long long v)
+    {
+        putRaw(Record::UInt64, uint64_t(v));
+    }
+    void putArg(float v) { putRaw(Record::Double, double(v)); }
+    void putArg(double v) { putRaw(Record::Double, v); }
+
+    void
+    putArg(const char *v)
+    {
+        block.push_back(char(Record::String));
+        putString(v, std::strlen(v));
+    }
+
+    void putArg(char *v) { putArg(const_cast<const char *>(v)); }
+
+    void
+    putArg(const std::string &v)
+    {
+        block.push_back(char(Record::String));
+        putString(v.data(), v.size());
+    }
+
+    /**
+     * The other integers, and the enumerations that print as integers,
+     * keep their value so that the decoder applies the flags, width and
+     * precision of the format to it. Anything else, including the
+     * enumerations of the protocols that print their names, is printed
+     * by its stream operator, which is done here as the decoder does not
+     * know the type.
+     */
+    template <typename T>
+    void
+    putArg(const T &v)
+    {
+        putOther(v, std::integral_constant<bool,
+            (std::is_integral<T>::value || std::is_enum<T>::value) &&
+            !Record::HasStreamOperator<T>::value>());
+    }
+
+    template <typename T>
+    void
+    putOther(const T &v, std::true_type)
+    {
+        typedef typename Record::IntegerOf<T>::type Integer;
+        if (std::is_signed<Integer>::value) {
+            if (sizeof(Integer) <= sizeof(int32_t))
+                putRaw(Record::Int32, int32_t(v));
+            else
+                putRaw(Record::Int64, int64_t(v));
+        } else {
+            if (sizeof(Integer) <= sizeof(uint32_t))
+                putRaw(Record::UInt32, uint32_t(v));
+            else
+                putRaw(Record::UInt64, uint64_t(v));
+        }
+    }
+
+    template <typename T>
+    void
+    putOther(const T &v, std::false_type)
+    {
+        std::ostringstream os;
+        os << v;
+        putArg(os.str());
+    }
+
+    void putArgs() { }
+
+    template <typename T, typename ...Args>
+    void
+    putArgs(const T &v, const Args &...args)
+    {
+        putArg(v);
+        putArgs(args...);
+    }
+
+    uint32_t formatId(const char *fmt);
+    uint32_t stringId(const std::string &str);
+
+    void header(Record::Kind kind, Tick when, const std::string &name,
+                const std::string &flag);
+
+    void
+    endRecord()
+    {
+        if (M5_UNLIKELY(block.size() >= blockSize))
+            commitBlock();
+    }
+
+    const size_t blockSize;
+    std::string block;
+
+    /** Ids of the strings defined so far */
+    std::unordered_map<std::string, uint32_t> strings;
+
+    /**
+     * The strings of the formats by address, as they are almost always
+     * literals. The text is compared on every hit in case a format was
+     * built on the fly.
+     */
+    std::unordered_map<const char *,
+        const std::pair<const std::string, uint32_t> *> formats;
+
+    Tick lastTick;
+};
+
+/**
+ * Renders the records of an encoder back into the text a
+ * Trace::OstreamLogger would have printed.
+ */
+class RecordDecoder
+{
+  public:
+    RecordDecoder(std::ostream &os) : os(os), lastTick(0) { }
+
+    /**
+     * Decode a whole block of records
+     * @return false if the block is malformed
+     */
+    bool decode(const char *data, size_t size);
+
+  private:
+    std::ostream &os;
+    std::vector<std::string> strings;
+    Tick lastTick;
+};
+
+} // namespace Trace
+
+#endif // __BASE_TRACE_RECORD_HH__
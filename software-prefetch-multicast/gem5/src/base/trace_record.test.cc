@@ -0,0 +1,212 @@
+/* @file
+ * Debug trace records tests
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "base/trace_file.hh"
+#include "base/trace_record.hh"
+
+using namespace Trace;
+
+namespace
+{
+
+/** Keeps the blocks, showing the ticks and flags like the default
+ *  debug flags do */
+class TestEncoder : public RecordEncoder
+{
+  public:
+    TestEncoder(size_t block_size) : RecordEncoder(block_size) { }
+
+    std::vector<std::string> blocks;
+
+    void done() { commitBlock(); }
+
+    std::string
+    decode()
+    {
+        std::ostringstream os;
+        RecordDecoder decoder(os);
+        for (const auto &block : blocks)
+            EXPECT_TRUE(decoder.decode(block.data(), block.size()));
+        return os.str();
+    }
+
+  protected:
+    uint8_t
+    style(Tick when, const std::string &flag) override
+    {
+        return when != MaxTick ? Record::ShowTick : 0;
+    }
+
+    void commit(std::string &block) override { blocks.push_back(block); }
+};
+
+enum class Color { Red, Green };
+
+/** Prints as an integer */
+enum Level : uint64_t { Low = 3, High = 0xfedcba9876543210 };
+
+std::ostream &
+operator<<(std::ostream &os, Color c)
+{
+    return os << (c == Color::Red ? "Red" : "Green");
+}
+
+/** The text Trace::OstreamLogger prints without FmtFlag */
+template <typename ...Args>
+std::string
+expected(Tick when, const std::string &name, const char *fmt,
+         const Args &...args)
+{
+    std::ostringstream os;
+    if (when != MaxTick)
+        ccprintf(os, "%7d: ", when);
+    if (!name.empty())
+        os << name << ": ";
+    ccprintf(os, fmt, args...);
+    return os.str();
+}
+
+} // anonymous namespace
+
+TEST(TraceRecordTest, ArgumentTypes)
+{
+    TestEncoder encoder(1 << 20);
+    std::string text;
+
+#define CHECK_RECORD(when, name, ...) do {                          \
+        encoder.record(when, name, "Flag", __VA_ARGS__);            \
+        text += expected(when, name, __VA_ARGS__);                  \
+    } while (0)
+
+    CHECK_RECORD(100, "system.cpu", "%d %x %c %s\n", 'a', 'b', 'c', 'd');
+    CHECK_RECORD(120, "system.cpu", "%d %#x\n", (unsigned char)200,
+                 (short)-1);
+    CHECK_RECORD(90, "system.l2", "%5d|%-5d|%05x\n", -3, 7u, 0xabcLL);
+    CHECK_RECORD(90, "", "%#018x %d\n", uint64_t(0xdeadbeef),
+                 -(int64_t(1) << 40));
+    CHECK_RECORD(MaxTick, "", "%*d|%.3f|%e|%g\n", 6, 42, 3.14159, 1e-9,
+                 0.5f);
+    CHECK_RECORD(200, "system.dir", "%s %s %d %s\n", "literal",
+                 std::string("string"), true, Color::Green);
+    CHECK_RECORD(200, "system.dir", "%#x|%8d|%-4d|\n", High, Low, Low);
+    CHECK_RECORD(200, "system.dir", "%4s|%x\n", Color::Red,
+                 (wchar_t)0x41);
+    CHECK_RECORD(200, "system.dir", "missing %d %d\n", 1);
+    CHECK_RECORD(200, "system.dir", "no arguments\n");
+
+#undef CHECK_RECORD
+
+    encoder.text(300, "system.mem", "Flag", "already formatted\n");
+    text += expected(300, "system.mem", "already formatted\n");
+
+    encoder.done();
+    EXPECT_EQ(encoder.decode(), text);
+}
+
+TEST(TraceRecordTest, StringsDefinedOnce)
+{
+    TestEncoder encoder(1 << 20);
+    encoder.record(1, "system.cpu", "Flag", "value %d\n", 1);
+    encoder.done();
+    size_t first = encoder.blocks[0].size();
+
+    encoder.record(2, "system.cpu", "Flag", "value %d\n", 2);
+    encoder.done();
+    EXPECT_LT(encoder.blocks[1].size() * 3, first);
+
+    // Another format at the same address is defined again
+    char fmt[] = "value %d\n";
+    encoder.record(3, "system.cpu", "Flag", fmt, 3);
+    fmt[0] = 'V';
+    encoder.record(4, "system.cpu", "Flag", fmt, 4);
+    encoder.done();
+
+    EXPECT_EQ(encoder.decode(),
+              expected(1, "system.cpu", "value %d\n", 1) +
+              expected(2, "system.cpu", "value %d\n", 2) +
+              expected(3, "system.cpu", "value %d\n", 3) +
+              expected(4, "system.cpu", "Value %d\n", 4));
+}
+
+TEST(TraceRecordTest, BlocksEndWithRecords)
+{
+    TestEncoder encoder(64);
+    std::string text;
+    for (int i = 0; i < 100; i++) {
+        encoder.record(i * 1000, "system.cpu", "Flag", "message %d\n", i);
+        text += expected(i * 1000, "system.cpu", "message %d\n", i);
+    }
+    encoder.done();
+
+    EXPECT_GT(encoder.blocks.size(), 10u);
+    // Every block decodes on its own, once the strings are defined
+    EXPECT_EQ(encoder.decode(), text);
+}
+
+namespace
+{
+
+/** Writes its blocks to a trace file */
+class FileEncoder : public TestEncoder
+{
+  public:
+    FileEncoder(std::ostream &os) : TestEncoder(256), writer(os, 1, 2) { }
+
+    void
+    done()
+    {
+        commitBlock();
+        writer.drain();
+    }
+
+  protected:
+    void commit(std::string &block) override { writer.push(block); }
+
+    BlockWriter writer;
+};
+
+} // anonymous namespace
+
+TEST(TraceFileTest, RoundTrip)
+{
+    std::stringstream file;
+    std::string text;
+    {
+        FileEncoder encoder(file);
+        for (int i = 0; i < 1000; i++) {
+            encoder.record(i * 500, "system.ruby.l1_cntrl0", "Flag",
+                           "addr %#x state %s\n", 0x1000 + i * 64,
+                           Color::Red);
+            text += expected(i * 500, "system.ruby.l1_cntrl0",
+                             "addr %#x state %s\n", 0x1000 + i * 64,
+                             Color::Red);
+        }
+        encoder.done();
+    }
+
+    EXPECT_LT(file.str().size() * 5, text.size());
+
+    std::ostringstream decoded;
+    EXPECT_TRUE(decodeTraceFile(file, decoded));
+    EXPECT_EQ(decoded.str(), text);
+
+    // The blocks written before a crash are still decoded
+    std::string data = file.str();
+    std::istringstream truncated(data.substr(0, data.size() - 10));
+    std::ostringstream partial;
+    EXPECT_FALSE(decodeTraceFile(truncated, partial));
+    EXPECT_FALSE(partial.str().empty());
+    EXPECT_EQ(text.compare(0, partial.str().size(), partial.str()), 0);
+
+    std::istringstream garbage("not a trace");
+    EXPECT_FALSE(decodeTraceFile(garbage, partial));
+}
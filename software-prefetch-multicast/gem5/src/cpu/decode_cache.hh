@@ -29,6 +29,8 @@
 #ifndef __CPU_DECODE_CACHE_HH__
 #define __CPU_DECODE_CACHE_HH__
 
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 
 #include "base/bitfield.hh"
@@ -85,8 +87,9 @@ class AddrMap
     /// address. First check the small cache of recent results, then
     /// actually look in the hash map.
     /// @param addr The address to look up.
+    /// @param create Whether to add the chunk if there is none.
     CacheChunk *
-    getChunk(Addr addr)
+    getChunk(Addr addr, bool create = true)
     {
         Addr chunk_addr = chunkStart(addr);
 
@@ -109,6 +112,9 @@ class AddrMap
             return it->second;
         }
 
+        if (!create)
+            return nullptr;
+
         // Didn't find an existing chunk, so add a new one.
         CacheChunk *newChunk = new CacheChunk;
         typename ChunkMap::value_type to_insert(chunk_addr, newChunk);
@@ -129,6 +135,133 @@ class AddrMap
         CacheChunk *chunk = getChunk(addr);
         return chunk->items[chunkOffset(addr)];
     }
+
+    /// Like lookup, but nullptr rather than a new chunk on a miss.
+    Value *
+    find(Addr addr)
+    {
+        CacheChunk *chunk = getChunk(addr, false);
+        return chunk ? &chunk->items[chunkOffset(addr)] : nullptr;
+    }
+
+    /// Call f(chunk_addr, items) for every chunk of the map.
+    template <class F>
+    void
+    forEachChunk(F f) const
+    {
+        for (const auto &chunk : chunkMap)
+            f(chunk.first, chunk.second->items);
+    }
+};
+
+/// A sparse map from an Addr to a Value shared by the threads of the
+/// simulator. Pages of values are published whole and never change
+/// afterwards, so a lookup takes no lock: the page number indexes a radix
+/// tree of atomic pointers, which only grows, under a mutex, when a page
+/// is published. Addresses past the 48 bits of the tree are not mapped.
+template<class Value, Addr CacheChunkShift = 12>
+class SharedAddrMap
+{
+  protected:
+    static constexpr Addr CacheChunkBytes = 1ULL << CacheChunkShift;
+    static constexpr unsigned LevelBits = 12;
+    static constexpr Addr LevelSize = 1ULL << LevelBits;
+
+    struct Leaf
+    {
+        std::atomic<const Value *> pages[LevelSize];
+
+        Leaf()
+        {
+            for (auto &page : pages)
+                page.store(nullptr, std::memory_order_relaxed);
+        }
+    };
+    struct Middle
+    {
+        std::atomic<Leaf *> leaves[LevelSize];
+
+        Middle()
+        {
+            for (auto &leaf : leaves)
+                leaf.store(nullptr, std::memory_order_relaxed);
+        }
+    };
+    std::atomic<Middle *> root[LevelSize];
+
+    // Serializes the publishers, lookups don't take it.
+    std::mutex publishLock;
+
+    static constexpr Addr
+    levelIndex(Addr addr, unsigned level)
+    {
+        return (addr >> (CacheChunkShift + level * LevelBits)) &
+            (LevelSize - 1);
+    }
+
+    static constexpr bool
+    mapped(Addr addr)
+    {
+        return (addr >> (CacheChunkShift + 3 * LevelBits)) == 0;
+    }
+
+  public:
+    SharedAddrMap()
+    {
+        for (auto &middle : root)
+            middle.store(nullptr, std::memory_order_relaxed);
+    }
+
+    SharedAddrMap(const SharedAddrMap &) = delete;
+    SharedAddrMap &operator=(const SharedAddrMap &) = delete;
+
+    /// The published value of addr, nullptr if its page isn't published.
+    const Value *
+    find(Addr addr) const
+    {
+        if (!mapped(addr))
+            return nullptr;
+        const Middle *middle =
+            root[levelIndex(addr, 2)].load(std::memory_order_acquire);
+        if (!middle)
+            return nullptr;
+        const Leaf *leaf = middle->leaves[levelIndex(addr, 1)].load(
+                std::memory_order_acquire);
+        if (!leaf)
+            return nullptr;
+        const Value *items = leaf->pages[levelIndex(addr, 0)].load(
+                std::memory_order_acquire);
+        return items ? &items[addr & (CacheChunkBytes - 1)] : nullptr;
+    }
+
+    /// Publish the CacheChunkBytes values of the page starting at
+    /// chunk_addr, which must outlive the map and not change anymore.
+    /// @retval false if the page is already published or not mapped.
+    bool
+    publish(Addr chunk_addr, const Value *items)
+    {
+        if (!mapped(chunk_addr))
+            return false;
+
+        std::lock_guard<std::mutex> lock(publishLock);
+        auto &middle_ptr = root[levelIndex(chunk_addr, 2)];
+        Middle *middle = middle_ptr.load(std::memory_order_relaxed);
+        if (!middle) {
+            middle = new Middle;
+            middle_ptr.store(middle, std::memory_order_release);
+        }
+        auto &leaf_ptr = middle->leaves[levelIndex(chunk_addr, 1)];
+        Leaf *leaf = leaf_ptr.load(std::memory_order_relaxed);
+        if (!leaf) {
+            leaf = new Leaf;
+            leaf_ptr.store(leaf, std::memory_order_release);
+        }
+        auto &page = leaf->pages[levelIndex(chunk_addr, 0)];
+        if (page.load(std::memory_order_relaxed))
+            return false;
+        page.store(items, std::memory_order_release);
+        return true;
+    }
 };
 
 } // namespace DecodeCache
@@ -177,6 +177,15 @@ class DerivO3CPU(BaseCPU):
     needsTSO = Param.Bool(buildEnv['TARGET_ISA'] == 'x86',
                           "Enable TSO Memory model")
 
+    spinQuiesce = Param.Bool(False, "Suspend threads spinning on an "
+                             "unchanged cache line until it is written")
+    spinQuiesceMaxOps = Param.Unsigned(32, "Maximum number of ops in the "
+                                       "body of a spin-wait loop")
+    spinQuiesceIterations = Param.Unsigned(64, "Identical spin-wait "
+                                           "iterations before quiescing")
+    spinQuiesceMaxCycles = Param.Cycles(100000, "Maximum number of cycles "
+                                        "a spin-wait quiesce can last")
+
     def addCheckerCpu(self):
         if buildEnv['TARGET_ISA'] in ['arm']:
             from m5.objects.ArmTLB import ArmMMU
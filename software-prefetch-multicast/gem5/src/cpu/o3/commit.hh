@@ -42,6 +42,8 @@
 #define __CPU_O3_COMMIT_HH__
 
 #include <queue>
+#include <utility>
+#include <vector>
 
 #include "base/statistics.hh"
 #include "cpu/exetrace.hh"
@@ -281,6 +283,38 @@ class DefaultCommit
      */
     void squashAfter(ThreadID tid, const DynInstPtr &head_inst);
 
+    /**
+     * Tracks the loop bodies committed by a thread to detect spin-wait
+     * loops: a short backward loop that only loads one cache line and
+     * keeps reading the same value. Once it has spun spinQuiesceIterations
+     * times, the thread is squashed after the loop branch, fetch is
+     * stalled and the line is armed in the address monitor of the thread
+     * so that the invalidation of the line by its writer wakes it up.
+     */
+    void detectSpinWait(ThreadID tid, const DynInstPtr &inst);
+
+    /** Stalls a spinning thread and arms its address monitor. */
+    void startSpinWait(ThreadID tid, const DynInstPtr &inst);
+
+    /**
+     * Suspends the spinning threads whose pipeline has drained and
+     * resumes the ones that were woken up, called at the end of tick().
+     */
+    void processSpinWaits();
+
+    /**
+     * Reads the spin-wait line functionally and tells whether the loaded
+     * bytes still hash to the value the loop spins on, since a write
+     * before the monitor was armed does not wake the thread up.
+     */
+    bool spinValueUnchanged(ThreadID tid);
+
+    /** Wakes up a quiesced thread that waited for spinQuiesceMaxCycles. */
+    void processSpinWaitTimeout(ThreadID tid, uint64_t generation);
+
+    /** Releases fetch and the address monitor of a spinning thread. */
+    void endSpinWait(ThreadID tid);
+
     /** Handles processing an interrupt. */
     void handleInterrupt();
 
@@ -434,6 +468,62 @@ class DefaultCommit
      */
     const Cycles trapLatency;
 
+    /** Are spin-wait loops detected and quiesced? */
+    const bool spinQuiesce;
+
+    /** Maximum number of ops in the body of a spin-wait loop. */
+    const unsigned spinQuiesceMaxOps;
+
+    /** Number of identical iterations before a spin-wait is quiesced. */
+    const unsigned spinQuiesceIterations;
+
+    /** Maximum number of cycles a thread stays quiesced. */
+    const Cycles spinQuiesceMaxCycles;
+
+    /** Spin-wait detection state of a thread. */
+    struct SpinWait {
+        enum State {
+            Idle,       // looking for a spin-wait loop
+            Stalling,   // waiting for the pipeline of the thread to drain
+            Quiesced    // suspended until the line is written
+        };
+
+        State state = Idle;
+        /** Loop body being committed. */
+        bool bodyValid = true;
+        unsigned bodyOps = 0;
+        unsigned bodyLoads = 0;
+        Addr bodyLine = 0;
+        Addr bodyPhysLine = 0;
+        uint64_t bodyHash = 0;
+        /** Line offset and size of each load of the body, in order. */
+        std::vector<std::pair<unsigned, unsigned>> bodyAccesses;
+        /** Last identical iterations. */
+        unsigned iterations = 0;
+        Addr branchPC = 0;
+        Addr targetPC = 0;
+        Addr line = 0;
+        Addr physLine = 0;
+        uint64_t valueHash = 0;
+        std::vector<std::pair<unsigned, unsigned>> accesses;
+        /** Start of the quiesce, and generation of its timeout event. */
+        Cycles quiesceStart = Cycles(0);
+        uint64_t generation = 0;
+
+        /** Starts a new loop body. */
+        void
+        resetBody()
+        {
+            bodyValid = true;
+            bodyOps = 0;
+            bodyLoads = 0;
+            bodyHash = 0;
+            bodyAccesses.clear();
+        }
+    };
+
+    SpinWait spinWait[Impl::MaxThreads];
+
     /** The interrupt fault. */
     Fault interrupt;
 
@@ -524,6 +614,15 @@ class DefaultCommit
 
         /** Number of cycles where the commit bandwidth limit is reached. */
         Stats::Scalar commitEligibleSamples;
+
+        /** Number of spin-wait loops that suspended their thread. */
+        Stats::Scalar spinQuiesces;
+        /** Number of cycles the spin-wait quiesced threads slept. */
+        Stats::Scalar spinQuiesceCycles;
+        /** Number of spin-wait quiesces ended by their timeout. */
+        Stats::Scalar spinQuiesceTimeouts;
+        /** Number of spin-waits whose line was written before quiescing. */
+        Stats::Scalar spinQuiesceAborts;
     } stats;
 };
 
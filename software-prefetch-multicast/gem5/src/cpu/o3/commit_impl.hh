@@ -63,6 +63,8 @@
 #include "debug/ExecFaulting.hh"
 #include "debug/HtmCpu.hh"
 #include "debug/O3PipeView.hh"
+#include "mem/packet.hh"
+#include "mem/request.hh"
 #include "params/DerivO3CPU.hh"
 #include "sim/faults.hh"
 #include "sim/full_system.hh"
@@ -92,6 +94,10 @@ DefaultCommit<Impl>::DefaultCommit(O3CPU *_cpu, const DerivO3CPUParams &params)
       drainPending(false),
       drainImminent(false),
       trapLatency(params.trapLatency),
+      spinQuiesce(params.spinQuiesce),
+      spinQuiesceMaxOps(params.spinQuiesceMaxOps),
+      spinQuiesceIterations(params.spinQuiesceIterations),
+      spinQuiesceMaxCycles(params.spinQuiesceMaxCycles),
       canHandleInterrupts(true),
       avoidQuiesceLiveLock(false),
       stats(_cpu, this)
@@ -171,7 +177,15 @@ DefaultCommit<Impl>::CommitStats::CommitStats(O3CPU *cpu,
       ADD_STAT(functionCalls, "Number of function calls committed."),
       ADD_STAT(committedInstType, "Class of committed instruction"),
       ADD_STAT(commitEligibleSamples, "number cycles where commit BW limit"
-          " reached")
+          " reached"),
+      ADD_STAT(spinQuiesces, "Number of spin-wait loops that suspended"
+          " their thread"),
+      ADD_STAT(spinQuiesceCycles, "Number of cycles spin-wait quiesced"
+          " threads slept"),
+      ADD_STAT(spinQuiesceTimeouts, "Number of spin-wait quiesces ended by"
+          " their timeout"),
+      ADD_STAT(spinQuiesceAborts, "Number of spin-waits whose line was"
+          " written before quiescing")
 {
     using namespace Stats;
 
@@ -355,6 +369,21 @@ void
 DefaultCommit<Impl>::drain()
 {
     drainPending = true;
+
+    // Spinning threads are released so that they can drain, a quiesced
+    // thread will spin again after the drain if the line is unchanged
+    for (ThreadID tid = 0; tid < numThreads; tid++) {
+        if (spinWait[tid].state == SpinWait::Idle)
+            continue;
+
+        bool quiesced = spinWait[tid].state == SpinWait::Quiesced;
+        if (quiesced)
+            stats.spinQuiesceCycles +=
+                cpu->curCycle() - spinWait[tid].quiesceStart;
+        endSpinWait(tid);
+        if (quiesced)
+            cpu->wakeup(tid);
+    }
 }
 
 template <class Impl>
@@ -723,6 +752,9 @@ DefaultCommit<Impl>::tick()
     }
 
 
+    if (spinQuiesce)
+        processSpinWaits();
+
     if (wroteToTimeBuffer) {
         DPRINTF(Activity, "Activity This Cycle.\n");
         cpu->activityThisCycle();
@@ -731,6 +763,230 @@ DefaultCommit<Impl>::tick()
     updateStatus();
 }
 
+template <class Impl>
+void
+DefaultCommit<Impl>::detectSpinWait(ThreadID tid, const DynInstPtr &inst)
+{
+    SpinWait &spin = spinWait[tid];
+
+    if (spin.state != SpinWait::Idle)
+        return;
+
+    // The body may only read a single cache line, anything with a side
+    // effect or an ordering constraint makes it a regular loop
+    if (inst->isStore() || inst->isAtomic() || inst->isSerializing() ||
+        inst->isNonSpeculative() || inst->isFullMemBarrier() ||
+        inst->isWriteBarrier() || inst->isSyscall() || inst->isQuiesce()) {
+        spin.bodyValid = false;
+    } else if (inst->isLoad()) {
+        Addr mask = ~Addr(cpu->cacheLineSize() - 1);
+        Addr line = inst->effAddr & mask;
+
+        if (inst->strictlyOrdered() || !inst->memData ||
+            inst->effSize == 0 ||
+            ((inst->effAddr + inst->effSize - 1) & mask) != line ||
+            (spin.bodyLoads > 0 && spin.bodyLine != line)) {
+            spin.bodyValid = false;
+        } else {
+            // FNV-1a over the loaded bytes
+            uint64_t hash = spin.bodyLoads > 0 ? spin.bodyHash :
+                0xcbf29ce484222325ULL;
+            for (unsigned i = 0; i < inst->effSize; i++) {
+                hash ^= inst->memData[i];
+                hash *= 0x100000001b3ULL;
+            }
+            spin.bodyHash = hash;
+            spin.bodyAccesses.emplace_back(inst->effAddr - line,
+                                           inst->effSize);
+            spin.bodyLine = line;
+            spin.bodyPhysLine = inst->physEffAddr & mask;
+            spin.bodyLoads++;
+        }
+    }
+    spin.bodyOps++;
+
+    // A committed backward control transfer closes the loop body
+    if (!inst->isControl() || pc[tid].microPC() != 0 ||
+        pc[tid].instAddr() > inst->instAddr())
+        return;
+
+    bool spinning = spin.bodyValid && spin.bodyLoads > 0 &&
+                    spin.bodyOps <= spinQuiesceMaxOps;
+
+    if (spinning && spin.iterations > 0 &&
+        spin.branchPC == inst->instAddr() &&
+        spin.targetPC == pc[tid].instAddr() &&
+        spin.line == spin.bodyLine && spin.valueHash == spin.bodyHash) {
+        spin.iterations++;
+        spin.accesses = spin.bodyAccesses;
+    } else if (spinning) {
+        spin.iterations = 1;
+        spin.branchPC = inst->instAddr();
+        spin.targetPC = pc[tid].instAddr();
+        spin.line = spin.bodyLine;
+        spin.physLine = spin.bodyPhysLine;
+        spin.valueHash = spin.bodyHash;
+        spin.accesses = spin.bodyAccesses;
+    } else {
+        spin.iterations = 0;
+    }
+    spin.resetBody();
+
+    if (spin.iterations >= spinQuiesceIterations)
+        startSpinWait(tid, inst);
+}
+
+template <class Impl>
+void
+DefaultCommit<Impl>::startSpinWait(ThreadID tid, const DynInstPtr &inst)
+{
+    SpinWait &spin = spinWait[tid];
+    AddressMonitor *monitor = cpu->getCpuAddrMonitor(tid);
+
+    // The monitor may already be used by a MONITOR/MWAIT pair
+    if (monitor->armed || drainPending || cpu->isDraining()) {
+        spin.iterations = 0;
+        return;
+    }
+
+    DPRINTF(Commit, "[tid:%i] Spin-wait loop at PC %#x on line %#x, "
+            "stalling fetch\n", tid, spin.branchPC, spin.line);
+
+    monitor->armed = true;
+    monitor->vAddr = spin.line;
+    monitor->pAddr = spin.physLine;
+    monitor->waiting = true;
+    monitor->gotWakeup = false;
+
+    // Refetch from the loop head once woken up
+    squashAfter(tid, inst);
+    cpu->spinStall(tid, true);
+    spin.state = SpinWait::Stalling;
+}
+
+template <class Impl>
+void
+DefaultCommit<Impl>::processSpinWaits()
+{
+    for (ThreadID tid = 0; tid < numThreads; tid++) {
+        SpinWait &spin = spinWait[tid];
+
+        if (spin.state == SpinWait::Stalling) {
+            if (!cpu->getCpuAddrMonitor(tid)->waiting) {
+                // The line was written while the pipeline drained
+                DPRINTF(Commit, "[tid:%i] Spin-wait line %#x written, "
+                        "resuming\n", tid, spin.line);
+                ++stats.spinQuiesceAborts;
+                endSpinWait(tid);
+            } else if (rob->isEmpty(tid) &&
+                       !iewStage->ldstQueue.hasStoresToWB(tid) &&
+                       (commitStatus[tid] == Running ||
+                        commitStatus[tid] == Idle)) {
+                if (!spinValueUnchanged(tid)) {
+                    // Written between the last load and the arming of the
+                    // monitor, the write was not snooped
+                    DPRINTF(Commit, "[tid:%i] Spin-wait line %#x changed "
+                            "before the monitor was armed, resuming\n",
+                            tid, spin.line);
+                    ++stats.spinQuiesceAborts;
+                    endSpinWait(tid);
+                    continue;
+                }
+
+                DPRINTF(Commit, "[tid:%i] Quiescing on spin-wait line "
+                        "%#x\n", tid, spin.line);
+                ++stats.spinQuiesces;
+                spin.state = SpinWait::Quiesced;
+                spin.quiesceStart = cpu->curCycle();
+
+                uint64_t generation = ++spin.generation;
+                cpu->schedule(new EventFunctionWrapper(
+                    [this, tid, generation]{
+                        processSpinWaitTimeout(tid, generation); },
+                    "SpinQuiesceTimeout", true, Event::CPU_Tick_Pri),
+                    cpu->clockEdge(spinQuiesceMaxCycles));
+
+                thread[tid]->getTC()->suspend();
+            } else {
+                // Keep ticking until the thread has drained
+                cpu->activityThisCycle();
+            }
+        } else if (spin.state == SpinWait::Quiesced &&
+                   thread[tid]->status() == ThreadContext::Active) {
+            DPRINTF(Commit, "[tid:%i] Woken up from spin-wait line %#x\n",
+                    tid, spin.line);
+            stats.spinQuiesceCycles += cpu->curCycle() - spin.quiesceStart;
+            endSpinWait(tid);
+        }
+    }
+}
+
+template <class Impl>
+bool
+DefaultCommit<Impl>::spinValueUnchanged(ThreadID tid)
+{
+    SpinWait &spin = spinWait[tid];
+    unsigned line_size = cpu->cacheLineSize();
+    std::vector<uint8_t> data(line_size);
+
+    RequestPtr req = std::make_shared<Request>(spin.physLine, line_size, 0,
+                                               cpu->dataRequestorId());
+    Packet pkt(req, MemCmd::ReadReq);
+    pkt.dataStatic(data.data());
+    pkt.setSuppressFuncError();
+    iewStage->ldstQueue.getDataPort().sendFunctional(&pkt);
+
+    // Assume the line changed if no copy could be read
+    if (!pkt.isResponse() || pkt.isError())
+        return false;
+
+    // Same FNV-1a over the same loads as detectSpinWait()
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (const auto &access : spin.accesses) {
+        for (unsigned i = 0; i < access.second; i++) {
+            hash ^= data[access.first + i];
+            hash *= 0x100000001b3ULL;
+        }
+    }
+    return hash == spin.valueHash;
+}
+
+template <class Impl>
+void
+DefaultCommit<Impl>::processSpinWaitTimeout(ThreadID tid,
+                                            uint64_t generation)
+{
+    SpinWait &spin = spinWait[tid];
+
+    if (spin.state != SpinWait::Quiesced || spin.generation != generation)
+        return;
+
+    DPRINTF(Commit, "[tid:%i] Spin-wait on line %#x timed out\n", tid,
+            spin.line);
+    ++stats.spinQuiesceTimeouts;
+    cpu->getCpuAddrMonitor(tid)->waiting = false;
+    cpu->wakeup(tid);
+}
+
+template <class Impl>
+void
+DefaultCommit<Impl>::endSpinWait(ThreadID tid)
+{
+    SpinWait &spin = spinWait[tid];
+    AddressMonitor *monitor = cpu->getCpuAddrMonitor(tid);
+
+    monitor->armed = false;
+    monitor->waiting = false;
+    cpu->spinStall(tid, false);
+
+    // Invalidates any pending timeout
+    spin.generation++;
+    spin.state = SpinWait::Idle;
+    spin.iterations = 0;
+    spin.accesses.clear();
+    spin.resetBody();
+}
+
 template <class Impl>
 void
 DefaultCommit<Impl>::handleInterrupt()
@@ -1144,6 +1400,9 @@ DefaultCommit<Impl>::commitInsts()
                     }
                 }
 
+                if (spinQuiesce)
+                    detectSpinWait(tid, head_inst);
+
                 bool onInstBoundary = !head_inst->isMicroop() ||
                                       head_inst->isLastMicroop() ||
                                       !head_inst->isDelayedCommit();
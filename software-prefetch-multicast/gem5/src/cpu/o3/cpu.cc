@@ -83,6 +83,7 @@ FullO3CPU<Impl>::FullO3CPU(const DerivO3CPUParams &params)
 #ifndef NDEBUG
       instcount(0),
 #endif
+      dynInstPool(Impl::DynInst::poolSlotSize()),
       removeInstsThisCycle(false),
       fetch(this, params),
       decode(this, params),
@@ -145,6 +146,12 @@ FullO3CPU<Impl>::FullO3CPU(const DerivO3CPUParams &params)
         checker = NULL;
     }
 
+    // The IQ and LSQ entries are in the ROB as well, counting them again
+    // leaves room for the front end and the squashed instructions still
+    // in the time buffers
+    dynInstPool.reserve(params.numROBEntries + params.numIQEntries +
+                        params.LQEntries + params.SQEntries);
+
     if (!FullSystem) {
         thread.resize(numThreads);
         tids.resize(numThreads);
@@ -1061,6 +1068,13 @@ FullO3CPU<Impl>::commitDrained(ThreadID tid)
     fetch.drainStall(tid);
 }
 
+template <class Impl>
+void
+FullO3CPU<Impl>::spinStall(ThreadID tid, bool stall)
+{
+    fetch.spinStall(tid, stall);
+}
+
 template <class Impl>
 void
 FullO3CPU<Impl>::drainResume()
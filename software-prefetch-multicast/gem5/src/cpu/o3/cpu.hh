@@ -51,6 +51,7 @@
 
 #include "arch/generic/types.hh"
 #include "arch/types.hh"
+#include "base/pool_allocator.hh"
 #include "base/statistics.hh"
 #include "config/the_isa.hh"
 #include "cpu/o3/comm.hh"
@@ -104,7 +105,7 @@ class FullO3CPU : public BaseO3CPU
     typedef O3ThreadState<Impl> ImplState;
     typedef O3ThreadState<Impl> Thread;
 
-    typedef typename std::list<DynInstPtr>::iterator ListIt;
+    typedef typename PooledList<DynInstPtr>::iterator ListIt;
 
     friend class O3ThreadContext<Impl>;
 
@@ -276,6 +277,14 @@ class FullO3CPU : public BaseO3CPU
      */
     void commitDrained(ThreadID tid);
 
+    /**
+     * Commit has detected a spin-wait loop (or its end) in a thread.
+     *
+     * Stalls or releases the fetch stage of that thread while commit
+     * quiesces it, see DefaultCommit::detectSpinWait().
+     */
+    void spinStall(ThreadID tid, bool stall);
+
     /** Switches out this CPU. */
     void switchOut() override;
 
@@ -515,8 +524,15 @@ class FullO3CPU : public BaseO3CPU
     int instcount;
 #endif
 
+    /**
+     * Arena of the dynamic instructions of the CPU, sized for the
+     * instructions that can be in flight. It must outlive every holder
+     * of an instruction, i.e. be declared before them.
+     */
+    SlotPool dynInstPool;
+
     /** List of all the instructions in flight. */
-    std::list<DynInstPtr> instList;
+    PooledList<DynInstPtr> instList;
 
     /** List of all the instructions that will be removed at the end of this
      *  cycle.
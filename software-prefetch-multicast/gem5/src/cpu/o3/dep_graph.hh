@@ -41,6 +41,9 @@
 #ifndef __CPU_O3_DEP_GRAPH_HH__
 #define __CPU_O3_DEP_GRAPH_HH__
 
+#include <cassert>
+
+#include "base/pool_allocator.hh"
 #include "cpu/o3/comm.hh"
 
 /** Node in a linked list. */
@@ -52,6 +55,20 @@ class DependencyEntry
         : inst(NULL), next(NULL)
     { }
 
+    /** Chained entries come from the slot pool of the thread */
+    static void *
+    operator new(size_t count)
+    {
+        assert(count == sizeof(DependencyEntry));
+        return threadSlotPool<sizeof(DependencyEntry)>().allocate();
+    }
+
+    static void
+    operator delete(void *ptr)
+    {
+        threadSlotPool<sizeof(DependencyEntry)>().release(ptr);
+    }
+
     DynInstPtr inst;
     //Might want to include data about what arch. register the
     //dependence is waiting on.
@@ -43,7 +43,9 @@
 #define __CPU_O3_DYN_INST_HH__
 
 #include <array>
+#include <cstddef>
 
+#include "base/pool_allocator.hh"
 #include "config/the_isa.hh"
 #include "cpu/o3/cpu.hh"
 #include "cpu/o3/isa_specific.hh"
@@ -85,6 +87,30 @@ class BaseO3DynInst : public BaseDynInst<Impl>
 
     ~BaseO3DynInst();
 
+    /**
+     * Instructions are allocated from the arena of their CPU, see
+     * FullO3CPU::dynInstPool, and return to it when the last reference
+     * goes away. A slot starts with the arena it belongs to.
+     * @{
+     */
+    static void *operator new(size_t count, O3CPU *cpu);
+    static void operator delete(void *ptr, O3CPU *cpu);
+    static void operator delete(void *ptr);
+
+    /** Size of a slot of the arena */
+    static size_t
+    poolSlotSize()
+    {
+        return PoolHeader + sizeof(BaseO3DynInst);
+    }
+    /** @} */
+
+  private:
+    static constexpr size_t PoolHeader = alignof(std::max_align_t);
+    static_assert(sizeof(SlotPool *) <= PoolHeader,
+                  "The arena of an instruction does not fit its header");
+
+  public:
     /** Executes the instruction.*/
     Fault execute();
 
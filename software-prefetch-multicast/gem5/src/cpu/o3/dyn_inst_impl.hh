@@ -62,6 +62,31 @@ BaseO3DynInst<Impl>::BaseO3DynInst(const StaticInstPtr &_staticInst,
     initVars();
 }
 
+template <class Impl>
+void *
+BaseO3DynInst<Impl>::operator new(size_t count, O3CPU *cpu)
+{
+    assert(PoolHeader + count <= cpu->dynInstPool.slotSize());
+    char *slot = static_cast<char *>(cpu->dynInstPool.allocate());
+    *reinterpret_cast<SlotPool **>(slot) = &cpu->dynInstPool;
+    return slot + PoolHeader;
+}
+
+template <class Impl>
+void
+BaseO3DynInst<Impl>::operator delete(void *ptr, O3CPU *cpu)
+{
+    operator delete(ptr);
+}
+
+template <class Impl>
+void
+BaseO3DynInst<Impl>::operator delete(void *ptr)
+{
+    char *slot = static_cast<char *>(ptr) - PoolHeader;
+    (*reinterpret_cast<SlotPool **>(slot))->release(slot);
+}
+
 template <class Impl>BaseO3DynInst<Impl>::~BaseO3DynInst()
 {
 #if TRACING_ON
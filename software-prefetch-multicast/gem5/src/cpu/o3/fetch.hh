@@ -270,6 +270,12 @@ class DefaultFetch
      */
     void drainStall(ThreadID tid);
 
+    /**
+     * Stall or release the fetch stage of a thread quiescing on a
+     * spin-wait loop, see DefaultCommit::detectSpinWait().
+     */
+    void spinStall(ThreadID tid, bool stall);
+
     /** Tells fetch to wake up from a quiesce instruction. */
     void wakeFromQuiesce();
 
@@ -455,6 +461,7 @@ class DefaultFetch
     struct Stalls {
         bool decode;
         bool drain;
+        bool spin;
     };
 
     /** Tracks which stages are telling fetch to stall. */
@@ -121,7 +121,7 @@ DefaultFetch<Impl>::DefaultFetch(O3CPU *_cpu, const DerivO3CPUParams &params)
         macroop[i] = nullptr;
         delayedCommit[i] = false;
         memReq[i] = nullptr;
-        stalls[i] = {false, false};
+        stalls[i] = {false, false, false};
         fetchBuffer[i] = NULL;
         fetchBufferPC[i] = 0;
         fetchBufferValid[i] = false;
@@ -302,6 +302,7 @@ DefaultFetch<Impl>::clearStates(ThreadID tid)
     memReq[tid] = NULL;
     stalls[tid].decode = false;
     stalls[tid].drain = false;
+    stalls[tid].spin = false;
     fetchBufferPC[tid] = 0;
     fetchBufferValid[tid] = false;
     fetchQueue[tid].clear();
@@ -332,6 +333,7 @@ DefaultFetch<Impl>::resetStage()
 
         stalls[tid].decode = false;
         stalls[tid].drain = false;
+        stalls[tid].spin = false;
 
         fetchBufferPC[tid] = 0;
         fetchBufferValid[tid] = false;
@@ -467,6 +469,15 @@ DefaultFetch<Impl>::drainStall(ThreadID tid)
     stalls[tid].drain = true;
 }
 
+template <class Impl>
+void
+DefaultFetch<Impl>::spinStall(ThreadID tid, bool stall)
+{
+    DPRINTF(Fetch, "[tid:%i] Spin-wait stall %s.\n", tid,
+            stall ? "set" : "cleared");
+    stalls[tid].spin = stall;
+}
+
 template <class Impl>
 void
 DefaultFetch<Impl>::wakeFromQuiesce()
@@ -796,6 +807,11 @@ DefaultFetch<Impl>::checkStall(ThreadID tid) const
         ret_val = true;
     }
 
+    if (stalls[tid].spin) {
+        DPRINTF(Fetch,"[tid:%i] Spin-wait stall detected.\n",tid);
+        ret_val = true;
+    }
+
     return ret_val;
 }
 
@@ -1071,7 +1087,7 @@ DefaultFetch<Impl>::buildInst(ThreadID tid, StaticInstPtr staticInst,
 
     // Create a new DynInst from the instruction fetched.
     DynInstPtr instruction =
-        new DynInst(staticInst, curMacroop, thisPC, nextPC, seq, cpu);
+        new (cpu) DynInst(staticInst, curMacroop, thisPC, nextPC, seq, cpu);
     instruction->setTid(tid);
 
     instruction->setThreadState(cpu->thread[tid]);
@@ -47,6 +47,7 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "base/pool_allocator.hh"
 #include "base/statistics.hh"
 #include "cpu/inst_seq.hh"
 #include "debug/MemDepUnit.hh"
@@ -163,7 +164,7 @@ class MemDepUnit
     /** Wakes any dependents of a memory instruction. */
     void wakeDependents(const DynInstPtr &inst);
 
-    typedef typename std::list<DynInstPtr>::iterator ListIt;
+    typedef typename PooledList<DynInstPtr>::iterator ListIt;
 
     class MemDepEntry;
 
@@ -245,10 +246,10 @@ class MemDepUnit
     MemDepHash memDepHash;
 
     /** A list of all instructions in the memory dependence unit. */
-    std::list<DynInstPtr> instList[Impl::MaxThreads];
+    PooledList<DynInstPtr> instList[Impl::MaxThreads];
 
     /** A list of all instructions that are going to be replayed. */
-    std::list<DynInstPtr> instsToReplay;
+    PooledList<DynInstPtr> instsToReplay;
 
     /** The memory dependence predictor.  It is accessed upon new
      *  instructions being added to the IQ, and responds by telling
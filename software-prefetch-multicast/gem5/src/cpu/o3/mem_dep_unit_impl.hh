@@ -205,7 +205,8 @@ MemDepUnit<MemDepPred, Impl>::insert(const DynInstPtr &inst)
 {
     ThreadID tid = inst->threadNumber;
 
-    MemDepEntryPtr inst_entry = std::make_shared<MemDepEntry>(inst);
+    MemDepEntryPtr inst_entry = std::allocate_shared<MemDepEntry>(
+        PoolAllocator<MemDepEntry>(), inst);
 
     // Add the MemDepEntry to the hash.
     memDepHash.insert(
@@ -338,7 +339,8 @@ MemDepUnit<MemDepPred, Impl>::insertBarrier(const DynInstPtr &barr_inst)
 {
     ThreadID tid = barr_inst->threadNumber;
 
-    MemDepEntryPtr inst_entry = std::make_shared<MemDepEntry>(barr_inst);
+    MemDepEntryPtr inst_entry = std::allocate_shared<MemDepEntry>(
+        PoolAllocator<MemDepEntry>(), barr_inst);
 
     // Add the MemDepEntry to the hash.
     memDepHash.insert(
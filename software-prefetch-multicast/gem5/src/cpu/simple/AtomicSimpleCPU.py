@@ -60,7 +60,12 @@ class AtomicSimpleCPU(BaseSimpleCPU):
     simulate_data_stalls = Param.Bool(False, "Simulate dcache stall cycles")
     simulate_inst_stalls = Param.Bool(False, "Simulate icache stall cycles")
 
-    def addSimPointProbe(self, interval):
+    def addSimPointProbe(self, interval, roi_manager=None, thread_id=0):
         simpoint = SimPoint()
         simpoint.interval = interval
+        simpoint.thread_id = thread_id
+        if roi_manager is not None:
+            simpoint.roi_only = True
+            simpoint.roi_manager = roi_manager
+            simpoint.inst_file = "simpoint.insts"
         self.probeListener = simpoint
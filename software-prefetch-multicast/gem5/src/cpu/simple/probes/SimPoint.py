@@ -44,3 +44,13 @@ class SimPoint(ProbeListenerObject):
 
     interval = Param.UInt64(100000000, "Interval Size (insts)")
     profile_file = Param.String("simpoint.bb.gz", "BBV (output) file")
+    roi_only = Param.Bool(False, "Only profile inside the prepush (ROI) "
+                          "window")
+    roi_manager = Param.SimObject(NULL, "Object whose PrepushWindow probe "
+                                  "point opens and closes the ROI, the "
+                                  "system of the prepush pseudo-ops")
+    thread_id = Param.Unsigned(0, "Thread (CPU) index, the BBVs of all "
+                               "threads are written by thread 0 and the "
+                               "interval size counts thread 0 insts")
+    inst_file = Param.String("", "Start inst count of each interval "
+                             "(output) file, thread 0 count")
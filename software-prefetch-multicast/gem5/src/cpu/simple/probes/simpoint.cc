@@ -38,9 +38,20 @@
 #include "cpu/simple/probes/simpoint.hh"
 
 #include "base/output.hh"
+#include "sim/system.hh"
+
+std::vector<SimPoint *> SimPoint::threadProbes;
 
 SimPoint::SimPoint(const SimPointParams &p)
     : ProbeListenerObject(p),
+      leader(NULL),
+      roiOnly(p.roi_only),
+      roiManager(p.roi_manager),
+      inROI(false),
+      threadId(p.thread_id),
+      threadInsts(0),
+      intervalStartInst(0),
+      instStream(NULL),
       intervalSize(p.interval),
       intervalCount(0),
       intervalDrift(0),
@@ -48,19 +59,48 @@ SimPoint::SimPoint(const SimPointParams &p)
       currentBBV(0, 0),
       currentBBVInstCount(0)
 {
+    fatal_if(roiOnly && !roiManager,
+             "SimPoint roi_only needs the roi_manager system");
+
+    threadProbes.push_back(this);
+
+    // All threads share the BBV file of thread 0
+    if (threadId != 0)
+        return;
+
     simpointStream = simout.create(p.profile_file, false);
     if (!simpointStream)
         fatal("unable to open SimPoint profile_file");
+
+    if (!p.inst_file.empty()) {
+        instStream = simout.create(p.inst_file, false);
+        if (!instStream)
+            fatal("unable to open SimPoint inst_file");
+    }
 }
 
 SimPoint::~SimPoint()
 {
-    simout.close(simpointStream);
+    if (simpointStream)
+        simout.close(simpointStream);
+    if (instStream)
+        simout.close(instStream);
 }
 
 void
 SimPoint::init()
-{}
+{
+    for (auto probe : threadProbes) {
+        if (probe->threadId >= threadProbes.size())
+            fatal("SimPoint thread_id %d out of range (%d probes)",
+                  probe->threadId, threadProbes.size());
+        if (probe != this && probe->threadId == threadId)
+            fatal("Duplicated SimPoint thread_id %d", threadId);
+        if (probe->threadId == 0)
+            leader = probe;
+    }
+    assert(leader);
+}
 
 void
 SimPoint::regProbeListeners()
@@ -69,6 +109,14 @@ SimPoint::regProbeListeners()
         SimPointListener;
     listeners.push_back(new SimPointListener(this, "Commit",
                                              &SimPoint::profile));
+    if (roiOnly)
+        listeners.push_back(new WindowListener(*this, roiManager));
+}
+
+void
+SimPoint::window(bool open)
+{
+    inROI = open;
 }
 
 void
@@ -80,10 +128,27 @@ SimPoint::profile(const std::pair<SimpleThread*, StaticInstPtr>& p)
     if (inst->isMicroop() && !inst->isLastMicroop())
         return;
 
+    ++threadInsts;
+
+    // Outside of the ROI, drop the partial basic block so that the first
+    // block profiled in the next window starts at a real instruction.
+    if (roiOnly && !inROI) {
+        currentBBVInstCount = 0;
+        return;
+    }
+
     if (!currentBBVInstCount)
         currentBBV.first = thread->pcState().instAddr();
 
-    ++intervalCount;
+    // Intervals are measured in the instructions of thread 0 only, the
+    // unit of the simpoint_start_insts of cpu[0] that the checkpoints are
+    // taken and restored at. The other threads add their blocks to the
+    // BBV of the interval that thread 0 is in.
+    if (this == leader) {
+        if (!intervalCount)
+            intervalStartInst = threadInsts;
+        ++intervalCount;
+    }
     ++currentBBVInstCount;
 
     // If inst is control inst, assume end of basic block.
@@ -111,30 +176,46 @@ SimPoint::profile(const std::pair<SimpleThread*, StaticInstPtr>& p)
         // Reached end of interval if the sum of the current inst count
         // (intervalCount) and the excessive inst count from the previous
         // interval (intervalDrift) is greater than/equal to the interval size.
-        if (intervalCount + intervalDrift >= intervalSize) {
-            // summarize interval and display BBV info
-            std::vector<std::pair<uint64_t, uint64_t> > counts;
-            for (auto map_itr = bbMap.begin(); map_itr != bbMap.end();
-                    ++map_itr) {
-                BBInfo& info = map_itr->second;
-                if (info.count != 0) {
-                    counts.push_back(std::make_pair(info.id, info.count));
-                    info.count = 0;
-                }
-            }
-            std::sort(counts.begin(), counts.end());
-
-            // Print output BBV info
-            *simpointStream->stream() << "T";
-            for (auto cnt_itr = counts.begin(); cnt_itr != counts.end();
-                    ++cnt_itr) {
-                *simpointStream->stream() << ":" << cnt_itr->first
-                                << ":" << cnt_itr->second << " ";
-            }
-            *simpointStream->stream() << "\n";
+        if (this == leader && intervalCount + intervalDrift >= intervalSize)
+            dumpInterval();
+    }
+}
+
+void
+SimPoint::dumpInterval()
+{
+    assert(this == leader);
 
-            intervalDrift = (intervalCount + intervalDrift) - intervalSize;
-            intervalCount = 0;
+    // summarize interval and display BBV info, the basic block ids of the
+    // threads are interleaved so that a single thread keeps its own ids
+    const uint64_t num_threads = threadProbes.size();
+    std::vector<std::pair<uint64_t, uint64_t> > counts;
+    for (auto probe : threadProbes) {
+        for (auto map_itr = probe->bbMap.begin();
+                map_itr != probe->bbMap.end(); ++map_itr) {
+            BBInfo& info = map_itr->second;
+            if (info.count != 0) {
+                uint64_t id = (info.id - 1) * num_threads +
+                              probe->threadId + 1;
+                counts.push_back(std::make_pair(id, info.count));
+                info.count = 0;
+            }
         }
     }
+    std::sort(counts.begin(), counts.end());
+
+    // Print output BBV info
+    *simpointStream->stream() << "T";
+    for (auto cnt_itr = counts.begin(); cnt_itr != counts.end();
+            ++cnt_itr) {
+        *simpointStream->stream() << ":" << cnt_itr->first
+                        << ":" << cnt_itr->second << " ";
+    }
+    *simpointStream->stream() << "\n";
+
+    if (instStream)
+        *instStream->stream() << intervalStartInst << "\n";
+
+    intervalDrift = (intervalCount + intervalDrift) - intervalSize;
+    intervalCount = 0;
 }
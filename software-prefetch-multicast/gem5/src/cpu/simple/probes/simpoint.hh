@@ -39,6 +39,7 @@
 #define __CPU_SIMPLE_PROBES_SIMPOINT_HH__
 
 #include <unordered_map>
+#include <vector>
 
 #include "base/output.hh"
 #include "cpu/simple_thread.hh"
@@ -87,10 +88,54 @@ class SimPoint : public ProbeListenerObject
     void profile(const std::pair<SimpleThread*, StaticInstPtr>&);
 
   private:
+    /** Follows the PrepushWindow probe point of the ROI manager */
+    class WindowListener : public ProbeListenerArgBase<bool>
+    {
+      public:
+        WindowListener(SimPoint &_parent, SimObject *obj)
+            : ProbeListenerArgBase<bool>(obj->getProbeManager(),
+                                        "PrepushWindow"),
+              parent(_parent)
+        {}
+        void notify(const bool &open) override { parent.window(open); }
+
+      private:
+        SimPoint &parent;
+    };
+
+    /** Open or close the profiled (ROI) window */
+    void window(bool open);
+
+    /**
+     * Write the BBV of the current interval, gathered from the probes of
+     * all threads, and start a new interval. Only called on the leader.
+     */
+    void dumpInterval();
+
+    /** Probes of all threads, the one of thread 0 leads the intervals */
+    static std::vector<SimPoint *> threadProbes;
+    /** Probe owning the output streams and the interval counts */
+    SimPoint *leader;
+
+    /** Only profile inside the prepush (ROI) window */
+    const bool roiOnly;
+    /** Object whose PrepushWindow probe point bounds the ROI */
+    SimObject *const roiManager;
+    /** Currently inside the ROI */
+    bool inROI;
+    /** Thread (CPU) index of this probe */
+    const unsigned threadId;
+    /** Committed insts on this thread, including those not profiled */
+    uint64_t threadInsts;
+    /** Thread 0 inst count at the start of the current interval */
+    uint64_t intervalStartInst;
+    /** Pointer to the interval start inst output stream (optional) */
+    OutputStream *instStream;
+
     /** SimPoint profiling interval size in instructions */
     const uint64_t intervalSize;
 
-    /** Inst count in current basic block */
+    /** Profiled thread 0 inst count in the current interval */
     uint64_t intervalCount;
     /** Excess inst count from previous interval*/
     uint64_t intervalDrift;
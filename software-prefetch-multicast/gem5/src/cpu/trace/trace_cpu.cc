@@ -591,7 +591,7 @@ TraceCPU::ElasticDataGen::executeMemReq(GraphNode* node_ptr)
     req->setReqInstSeqNum(node_ptr->seqNum);
 
     // If this is not done it triggers assert in L1 cache for invalid contextId
-    req->setContext(ContextID(0));
+    req->setContext(ContextID(owner.cpuId()));
 
     req->setPC(node_ptr->pc);
     // If virtual address is valid, set the virtual address field
@@ -1071,7 +1071,7 @@ TraceCPU::FixedRetryGen::send(Addr addr, unsigned size, const MemCmd& cmd,
     req->setPC(pc);
 
     // If this is not done it triggers assert in L1 cache for invalid contextId
-    req->setContext(ContextID(0));
+    req->setContext(ContextID(owner.cpuId()));
 
     // Embed it in a packet
     PacketPtr pkt = new Packet(req, cmd);
@@ -43,8 +43,10 @@ from m5.proxy import *
 from m5.objects.QoSMemCtrl import *
 
 # Enum for memory scheduling algorithms, currently First-Come
-# First-Served and a First-Row Hit then First-Come First-Served
-class MemSched(Enum): vals = ['fcfs', 'frfcfs']
+# First-Served, a First-Row Hit then First-Come First-Served, and the
+# latter with the prepush reads of the Ruby directories batched per row
+# behind the demand reads
+class MemSched(Enum): vals = ['fcfs', 'frfcfs', 'frfcfs_prepush']
 
 # MemCtrl is a single-channel single-ported Memory controller model
 # that aims to model the most important system-level performance
@@ -82,6 +84,14 @@ class MemCtrl(QoSMemCtrl):
     # scheduler, address map and page policy
     mem_sched_policy = Param.MemSched('frfcfs', "Memory scheduling policy")
 
+    # with frfcfs_prepush, the prepush reads to the row of the last one
+    # issue back to back, up to a batch, and the others wait for the
+    # demand reads unless they waited too long already
+    prepush_batch_size = Param.Unsigned(8, "Prepush reads to a row issued "
+                                        "ahead of the demand reads")
+    prepush_max_delay = Param.Latency("1us", "Delay after which a prepush "
+                                      "read is scheduled as a demand read")
+
     # pipeline latency of the controller and PHY, split into a
     # frontend part and a backend part, with reads and writes serviced
     # by the queues only seeing the frontend contribution, and reads
@@ -40,6 +40,8 @@
 
 #include "mem/mem_ctrl.hh"
 
+#include <algorithm>
+
 #include "base/trace.hh"
 #include "debug/DRAM.hh"
 #include "debug/Drain.hh"
@@ -67,6 +69,10 @@ MemCtrl::MemCtrl(const MemCtrlParams &p) :
     minWritesPerSwitch(p.min_writes_per_switch),
     writesThisTime(0), readsThisTime(0),
     memSchedPolicy(p.mem_sched_policy),
+    prepushBatchSize(p.prepush_batch_size),
+    prepushMaxDelay(p.prepush_max_delay),
+    prepushBatchRank(0), prepushBatchBank(0), prepushBatchRow(0),
+    prepushBatchCount(0),
     frontendLatency(p.static_frontend_latency),
     backendLatency(p.static_backend_latency),
     commandWindow(p.command_window),
@@ -581,6 +587,8 @@ MemCtrl::chooseNext(MemPacketQueue& queue, Tick extra_col_delay)
             }
         } else if (memSchedPolicy == Enums::frfcfs) {
             ret = chooseNextFRFCFS(queue, extra_col_delay);
+        } else if (memSchedPolicy == Enums::frfcfs_prepush) {
+            ret = chooseNextPrepush(queue, extra_col_delay);
         } else {
             panic("No scheduling policy chosen\n");
         }
@@ -630,6 +638,44 @@ MemCtrl::chooseNextFRFCFS(MemPacketQueue& queue, Tick extra_col_delay)
     return selected_pkt_it;
 }
 
+MemPacketQueue::iterator
+MemCtrl::chooseNextPrepush(MemPacketQueue& queue, Tick extra_col_delay)
+{
+    // keep reading the row of the last prepush read, oldest first
+    if (prepushBatchCount > 0 && prepushBatchCount < prepushBatchSize) {
+        for (auto i = queue.begin(); i != queue.end(); ++i) {
+            MemPacket* mem_pkt = *i;
+            if (mem_pkt->isPrepush() && mem_pkt->isDram() &&
+                mem_pkt->rank == prepushBatchRank &&
+                mem_pkt->bank == prepushBatchBank &&
+                mem_pkt->row == prepushBatchRow && packetReady(mem_pkt)) {
+                DPRINTF(MemCtrl, "Prepush read %d of the batch to row %d\n",
+                        prepushBatchCount, mem_pkt->row);
+                return i;
+            }
+        }
+    }
+
+    // the prepush reads waiting too long compete with the demand ones
+    MemPacketQueue demand;
+    for (auto mem_pkt : queue) {
+        if (!mem_pkt->isPrepush() ||
+            curTick() - mem_pkt->entryTime >= prepushMaxDelay) {
+            demand.push_back(mem_pkt);
+        }
+    }
+
+    if (!demand.empty() && demand.size() < queue.size()) {
+        auto selected_pkt_it = chooseNextFRFCFS(demand, extra_col_delay);
+        if (selected_pkt_it != demand.end()) {
+            return std::find(queue.begin(), queue.end(), *selected_pkt_it);
+        }
+    }
+
+    // no demand packet can issue, do not leave the bus idle
+    return chooseNextFRFCFS(queue, extra_col_delay);
+}
+
 void
 MemCtrl::accessAndRespond(PacketPtr pkt, Tick static_latency)
 {
@@ -850,6 +896,24 @@ MemCtrl::doBurstAccess(MemPacket* mem_pkt)
                                         nvm->commandOffset());
 
 
+    // Follow the row of the prepush reads, any other burst ending the
+    // batch
+    if (mem_pkt->isPrepush() && mem_pkt->isDram()) {
+        if (prepushBatchCount > 0 && mem_pkt->rank == prepushBatchRank &&
+            mem_pkt->bank == prepushBatchBank &&
+            mem_pkt->row == prepushBatchRow) {
+            ++prepushBatchCount;
+        } else {
+            prepushBatchRank = mem_pkt->rank;
+            prepushBatchBank = mem_pkt->bank;
+            prepushBatchRow = mem_pkt->row;
+            prepushBatchCount = 1;
+            ++stats.prepushBatches;
+        }
+    } else {
+        prepushBatchCount = 0;
+    }
+
     // Update the common bus stats
     if (mem_pkt->isRead()) {
         ++readsThisTime;
@@ -857,6 +921,15 @@ MemCtrl::doBurstAccess(MemPacket* mem_pkt)
         stats.requestorReadTotalLat[mem_pkt->requestorId()] +=
             mem_pkt->readyTime - mem_pkt->entryTime;
         stats.requestorReadBytes[mem_pkt->requestorId()] += mem_pkt->size;
+        if (mem_pkt->isPrepush()) {
+            ++stats.prepushReadBursts;
+            stats.prepushReadTotalLat +=
+                mem_pkt->readyTime - mem_pkt->entryTime;
+        } else {
+            ++stats.demandReadBursts;
+            stats.demandReadTotalLat +=
+                mem_pkt->readyTime - mem_pkt->entryTime;
+        }
     } else {
         ++writesThisTime;
         stats.requestorWriteBytes[mem_pkt->requestorId()] += mem_pkt->size;
@@ -1249,7 +1322,20 @@ MemCtrl::CtrlStats::CtrlStats(MemCtrl &_ctrl)
     ADD_STAT(requestorReadAvgLat,
              "Per-requestor read average memory access latency"),
     ADD_STAT(requestorWriteAvgLat,
-             "Per-requestor write average memory access latency")
+             "Per-requestor write average memory access latency"),
+
+    ADD_STAT(prepushReadBursts,
+             "Read bursts of the prepush streams of the directories"),
+    ADD_STAT(demandReadBursts, "Read bursts other than prepush reads"),
+    ADD_STAT(prepushReadTotalLat,
+             "Total memory access latency of the prepush reads"),
+    ADD_STAT(demandReadTotalLat,
+             "Total memory access latency of the other reads"),
+    ADD_STAT(prepushReadAvgLat,
+             "Average memory access latency of the prepush reads"),
+    ADD_STAT(demandReadAvgLat,
+             "Average memory access latency of the other reads"),
+    ADD_STAT(prepushBatches, "Rows opened by a batch of prepush reads")
 
 {
 }
@@ -1348,6 +1434,11 @@ MemCtrl::CtrlStats::regStats()
     requestorWriteRate = requestorWriteBytes / simSeconds;
     requestorReadAvgLat = requestorReadTotalLat / requestorReadAccesses;
     requestorWriteAvgLat = requestorWriteTotalLat / requestorWriteAccesses;
+
+    prepushReadAvgLat.precision(2);
+    demandReadAvgLat.precision(2);
+    prepushReadAvgLat = prepushReadTotalLat / prepushReadBursts;
+    demandReadAvgLat = demandReadTotalLat / demandReadBursts;
 }
 
 void
@@ -109,6 +109,9 @@ class MemPacket
     /** Does this packet access DRAM?*/
     const bool dram;
 
+    /** Is this a prepush read of a Ruby directory stream?*/
+    const bool prepush;
+
     /** Will be populated by address decoder */
     const uint8_t rank;
     const uint8_t bank;
@@ -193,12 +196,20 @@ class MemPacket
      */
     inline bool isDram() const { return dram; }
 
+    /**
+     * Return true if it reads ahead of a prepush stream, tagged with the
+     * share group and the sequence of the stream
+     */
+    inline bool isPrepush() const { return prepush; }
+
     MemPacket(PacketPtr _pkt, bool is_read, bool is_dram, uint8_t _rank,
                uint8_t _bank, uint32_t _row, uint16_t bank_id, Addr _addr,
                unsigned int _size)
         : entryTime(curTick()), readyTime(curTick()), pkt(_pkt),
           _requestorId(pkt->requestorId()),
-          read(is_read), dram(is_dram), rank(_rank), bank(_bank), row(_row),
+          read(is_read), dram(is_dram),
+          prepush(_pkt->req->isPrefetch() && _pkt->req->hasStreamId()),
+          rank(_rank), bank(_bank), row(_row),
           bankId(bank_id), addr(_addr), size(_size), burstHelper(NULL),
           _qosValue(_pkt->qosValue())
     { }
@@ -404,6 +415,18 @@ class MemCtrl : public QoS::MemCtrl
     MemPacketQueue::iterator chooseNextFRFCFS(MemPacketQueue& queue,
             Tick extra_col_delay);
 
+    /**
+     * For the frfcfs_prepush policy, the next prepush read of the open
+     * batch, else the next demand packet by FR-FCFS, else the next
+     * prepush read by FR-FCFS.
+     *
+     * @param queue Queued requests to consider
+     * @param extra_col_delay Any extra delay due to a read/write switch
+     * @return an iterator to the selected packet, else queue.end()
+     */
+    MemPacketQueue::iterator chooseNextPrepush(MemPacketQueue& queue,
+            Tick extra_col_delay);
+
     /**
      * Calculate burst window aligned tick
      *
@@ -490,6 +513,22 @@ class MemCtrl : public QoS::MemCtrl
      */
     Enums::MemSched memSchedPolicy;
 
+    /**
+     * Prepush reads to a row issued ahead of the demand reads, and the
+     * delay after which a prepush read counts as a demand read
+     */
+    const uint32_t prepushBatchSize;
+    const Tick prepushMaxDelay;
+
+    /**
+     * Row of the last prepush read, and the prepush reads issued to it
+     * since the last other burst
+     */
+    uint8_t prepushBatchRank;
+    uint8_t prepushBatchBank;
+    uint32_t prepushBatchRow;
+    uint32_t prepushBatchCount;
+
     /**
      * Pipeline latency of the controller frontend. The frontend
      * contribution is added to writes (that complete when they are in
@@ -583,6 +622,15 @@ class MemCtrl : public QoS::MemCtrl
         // per-requestor raed and write average memory access latency
         Stats::Formula requestorReadAvgLat;
         Stats::Formula requestorWriteAvgLat;
+
+        // prepush reads of the Ruby directories and the demand reads
+        Stats::Scalar prepushReadBursts;
+        Stats::Scalar demandReadBursts;
+        Stats::Scalar prepushReadTotalLat;
+        Stats::Scalar demandReadTotalLat;
+        Stats::Formula prepushReadAvgLat;
+        Stats::Formula demandReadAvgLat;
+        Stats::Scalar prepushBatches;
     };
 
     CtrlStats stats;
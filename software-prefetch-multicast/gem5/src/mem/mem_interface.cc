@@ -676,6 +676,11 @@ DRAMInterface::doBurstAccess(MemPacket* mem_pkt, Tick next_burst_at,
         stats.readBursts++;
         if (row_hit)
             stats.readRowHits++;
+        if (mem_pkt->isPrepush()) {
+            stats.prepushReadBursts++;
+            if (row_hit)
+                stats.prepushReadRowHits++;
+        }
         stats.bytesRead += burstSize;
         stats.perBankRdBursts[mem_pkt->bankId]++;
 
@@ -1870,6 +1875,13 @@ DRAMInterface::DRAMStats::DRAMStats(DRAMInterface &_dram)
     ADD_STAT(readRowHitRate, "Row buffer hit rate for reads"),
     ADD_STAT(writeRowHitRate, "Row buffer hit rate for writes"),
 
+    ADD_STAT(prepushReadBursts, "Number of DRAM read bursts of prepushes"),
+    ADD_STAT(prepushReadRowHits,
+             "Number of row buffer hits during prepush reads"),
+    ADD_STAT(prepushReadRowHitRate, "Row buffer hit rate for prepush reads"),
+    ADD_STAT(demandReadRowHitRate,
+             "Row buffer hit rate for the other reads"),
+
     ADD_STAT(bytesPerActivate, "Bytes accessed per row activation"),
     ADD_STAT(bytesRead, "Total number of bytes read from DRAM"),
     ADD_STAT(bytesWritten, "Total number of bytes written to DRAM"),
@@ -1897,6 +1909,8 @@ DRAMInterface::DRAMStats::regStats()
 
     readRowHitRate.precision(2);
     writeRowHitRate.precision(2);
+    prepushReadRowHitRate.precision(2);
+    demandReadRowHitRate.precision(2);
 
     perBankRdBursts.init(dram.banksPerRank * dram.ranksPerChannel);
     perBankWrBursts.init(dram.banksPerRank * dram.ranksPerChannel);
@@ -1920,6 +1934,9 @@ DRAMInterface::DRAMStats::regStats()
 
     readRowHitRate = (readRowHits / readBursts) * 100;
     writeRowHitRate = (writeRowHits / writeBursts) * 100;
+    prepushReadRowHitRate = (prepushReadRowHits / prepushReadBursts) * 100;
+    demandReadRowHitRate = ((readRowHits - prepushReadRowHits) /
+                            (readBursts - prepushReadBursts)) * 100;
 
     avgRdBW = (bytesRead / 1000000) / simSeconds;
     avgWrBW = (bytesWritten / 1000000) / simSeconds;
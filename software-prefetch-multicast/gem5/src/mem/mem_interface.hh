@@ -831,6 +831,12 @@ class DRAMInterface : public MemInterface
         Stats::Scalar writeRowHits;
         Stats::Formula readRowHitRate;
         Stats::Formula writeRowHitRate;
+
+        // Row hits of the prepush reads of the Ruby directories
+        Stats::Scalar prepushReadBursts;
+        Stats::Scalar prepushReadRowHits;
+        Stats::Formula prepushReadRowHitRate;
+        Stats::Formula demandReadRowHitRate;
         Stats::Histogram bytesPerActivate;
         // Number of bytes transferred to/from DRAM
         Stats::Scalar bytesRead;
@@ -28,6 +28,8 @@
 
 #include "mem/ruby/common/Address.hh"
 
+#include <algorithm>
+
 #include "base/bitfield.hh"
 #include "mem/ruby/system/RubySystem.hh"
 
@@ -70,6 +72,17 @@ makeNextStrideAddress(Addr addr, int stride)
         static_cast<int>(RubySystem::getBlockSizeBytes()) * stride;
 }
 
+// returns the lines of a range, from addr on, left in its 4 KB page, as the
+// next page need not follow it physically
+int
+linesInPage(Addr addr, int lines)
+{
+    const Addr page_bytes = 4096;
+    int left = (page_bytes - (addr & (page_bytes - 1))) /
+        RubySystem::getBlockSizeBytes();
+    return std::min(lines, left);
+}
+
 std::string
 printAddress(Addr addr)
 {
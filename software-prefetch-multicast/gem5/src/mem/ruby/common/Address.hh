@@ -42,6 +42,7 @@ Addr getOffset(Addr addr);
 Addr makeLineAddress(Addr addr);
 Addr makeLineAddress(Addr addr, int cacheLineBits);
 Addr makeNextStrideAddress(Addr addr, int stride);
+int linesInPage(Addr addr, int lines);
 std::string printAddress(Addr addr);
 
 int ReturnBits(Addr addr);
@@ -29,7 +29,13 @@
 
 #include "mem/ruby/network/Topology.hh"
 
+#include <algorithm>
 #include <cassert>
+#include <climits>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <thread>
 
 #include "base/trace.hh"
 #include "debug/RubyNetwork.hh"
@@ -119,36 +125,20 @@ Topology::createLinks(Network *net)
         max_switch_id = max(max_switch_id, src_dest.second);
     }
 
-    // Initialize weight, latency, and inter switched vectors
     int num_switches = max_switch_id+1;
-    Matrix topology_weights(m_vnets,
-            vector<vector<int>>(num_switches,
-            vector<int>(num_switches, INFINITE_LATENCY)));
-    Matrix component_latencies(num_switches,
-            vector<vector<int>>(num_switches,
-            vector<int>(m_vnets, -1)));
-    Matrix component_inter_switches(num_switches,
-            vector<vector<int>>(num_switches,
-            vector<int>(m_vnets, 0)));
-
-    // Set identity weights to zero
-    for (int i = 0; i < topology_weights[0].size(); i++) {
-        for (int v = 0; v < m_vnets; v++) {
-            topology_weights[v][i][i] = 0;
-        }
-    }
 
-    // Fill in the topology weights and bandwidth multipliers
-    for (auto link_group : m_link_map) {
-        std::pair<int, int> src_dest = link_group.first;
+    // Fill in the topology weights of every link, per vnet
+    vector<vector<int>> link_weights;
+    link_weights.reserve(m_link_map.size());
+    for (const auto &link_group : m_link_map) {
         vector<bool> vnet_done(m_vnets, 0);
-        int src = src_dest.first;
-        int dst = src_dest.second;
+        vector<int> weights(m_vnets, INFINITE_LATENCY);
 
         // Iterate over all links for this source and destination
-        std::vector<LinkEntry> link_entries = link_group.second;
+        const std::vector<LinkEntry> &link_entries = link_group.second;
         for (int l = 0; l < link_entries.size(); l++) {
             BasicLink* link = link_entries[l].link;
+            fatal_if(link->m_weight < 0, "Link weights cannot be negative");
             if (link->mVnets.size() == 0) {
                 for (int v = 0; v < m_vnets; v++) {
                     // Two links connecting same src and destination
@@ -156,8 +146,7 @@ Topology::createLinks(Network *net)
                     fatal_if(vnet_done[v], "Two links connecting same src"
                     " and destination cannot support same vnets");
 
-                    component_latencies[src][dst][v] = link->m_latency;
-                    topology_weights[v][src][dst] = link->m_weight;
+                    weights[v] = link->m_weight;
                     vnet_done[v] = true;
                 }
             } else {
@@ -170,43 +159,63 @@ Topology::createLinks(Network *net)
                     fatal_if(vnet_done[vnet], "Two links connecting same src"
                     " and destination cannot support same vnets");
 
-                    component_latencies[src][dst][vnet] = link->m_latency;
-                    topology_weights[vnet][src][dst] = link->m_weight;
+                    weights[vnet] = link->m_weight;
                     vnet_done[vnet] = true;
                 }
             }
         }
+        link_weights.push_back(weights);
+    }
+
+    // Vnets carried by the same links with the same weights have the same
+    // shortest paths, compute them once per group of such vnets
+    vector<int> vnet_group(m_vnets);
+    vector<int> group_vnets;
+    for (int v = 0; v < m_vnets; v++) {
+        int g = 0;
+        for (; g < group_vnets.size(); g++) {
+            int u = group_vnets[g];
+            if (std::all_of(link_weights.begin(), link_weights.end(),
+                    [u, v](const vector<int> &w) { return w[u] == w[v]; }))
+                break;
+        }
+        if (g == group_vnets.size())
+            group_vnets.push_back(v);
+        vnet_group[v] = g;
     }
 
+    vector<DistMatrix> dist;
+    for (int v : group_vnets)
+        dist.push_back(shortest_path(link_weights, v, num_switches));
+
     // Walk topology and hookup the links
-    Matrix dist = shortest_path(topology_weights, component_latencies,
-                                component_inter_switches);
-
-    for (int i = 0; i < topology_weights[0].size(); i++) {
-        for (int j = 0; j < topology_weights[0][i].size(); j++) {
-            std::vector<NetDest> routingMap;
-            routingMap.resize(m_vnets);
-
-            // Not all sources and destinations are connected
-            // by direct links. We only construct the links
-            // which have been configured in topology.
-            bool realLink = false;
-
-            for (int v = 0; v < m_vnets; v++) {
-                int weight = topology_weights[v][i][j];
-                if (weight > 0 && weight != INFINITE_LATENCY) {
-                    realLink = true;
-                    routingMap[v] =
-                        shortest_path_to_node(i, j, topology_weights, dist, v);
-                }
-            }
-            // Make one link for each set of vnets between
-            // a given source and destination. We do not
-            // want to create one link for each vnet.
-            if (realLink) {
-                makeLink(net, i, j, routingMap);
+    int l = 0;
+    for (const auto &link_group : m_link_map) {
+        SwitchID i = link_group.first.first;
+        SwitchID j = link_group.first.second;
+        std::vector<NetDest> routingMap;
+        routingMap.resize(m_vnets);
+
+        // Not all sources and destinations are connected
+        // by direct links. We only construct the links
+        // which have been configured in topology.
+        bool realLink = false;
+
+        for (int v = 0; v < m_vnets; v++) {
+            int weight = link_weights[l][v];
+            if (weight > 0 && weight != INFINITE_LATENCY) {
+                realLink = true;
+                routingMap[v] = shortest_path_to_node(i, j, weight,
+                                    dist[vnet_group[v]], v);
             }
         }
+        // Make one link for each set of vnets between
+        // a given source and destination. We do not
+        // want to create one link for each vnet.
+        if (realLink) {
+            makeLink(net, i, j, routingMap);
+        }
+        l++;
     }
 }
 
@@ -326,89 +335,105 @@ Topology::makeLink(Network *net, SwitchID src, SwitchID dest,
     }
 }
 
-// The following all-pairs shortest path algorithm is based on the
-// discussion from Cormen et al., Chapter 26.1.
-void
-Topology::extend_shortest_path(Matrix &current_dist, Matrix &latencies,
-    Matrix &inter_switches)
+// Shortest paths from every switch to the output endpoints, one
+// single-source search per switch (BFS when all the links weigh one,
+// Dijkstra otherwise) over the links carrying the vnet. The topology is
+// sparse, so this is much cheaper than an all-pairs relaxation over the
+// full switch matrix, and the sources are split over host threads.
+DistMatrix
+Topology::shortest_path(const std::vector<std::vector<int>> &link_weights,
+                        int vnet, int num_switches)
 {
-    int nodes = current_dist[0].size();
+    typedef std::pair<int, SwitchID> DistEntry;
+
+    // Adjacency lists of the links carrying the vnet
+    std::vector<std::vector<std::pair<SwitchID, int>>> adj(num_switches);
+    bool unit_weights = true;
+    int l = 0;
+    for (const auto &link_group : m_link_map) {
+        int weight = link_weights[l++][vnet];
+        if (weight >= INFINITE_LATENCY)
+            continue;
+        adj[link_group.first.first].emplace_back(link_group.first.second,
+                                                 weight);
+        unit_weights = unit_weights && (weight == 1);
+    }
 
-    // We find the shortest path for each vnet for a given pair of
-    // source and destinations. This is done simply by traversing via
-    // all other nodes and finding the minimum distance.
-    for (int v = 0; v < m_vnets; v++) {
-        // There is a different topology for each vnet. Here we try to
-        // build a topology by finding the minimum number of intermediate
-        // switches needed to reach the destination
-        bool change = true;
-        while (change) {
-            change = false;
-            for (int i = 0; i < nodes; i++) {
-                for (int j = 0; j < nodes; j++) {
-                    // We follow an iterative process to build the shortest
-                    // path tree:
-                    // 1. Start from the direct connection (if there is one,
-                    // otherwise assume a hypothetical infinite weight link).
-                    // 2. Then we iterate through all other nodes considering
-                    // new potential intermediate switches. If we find any
-                    // lesser weight combination, we set(update) that as the
-                    // new weight between the source and destination.
-                    // 3. Repeat for all pairs of nodes.
-                    // 4. Go to step 1 if there was any new update done in
-                    // Step 2.
-                    int minimum = current_dist[v][i][j];
-                    int previous_minimum = minimum;
-                    int intermediate_switch = -1;
-                    for (int k = 0; k < nodes; k++) {
-                        minimum = min(minimum,
-                            current_dist[v][i][k] + current_dist[v][k][j]);
-                        if (previous_minimum != minimum) {
-                            intermediate_switch = k;
-                            inter_switches[i][j][v] =
-                                inter_switches[i][k][v] +
-                                inter_switches[k][j][v] + 1;
+    // Only the distances to the output endpoints are kept, see
+    // shortest_path_to_node. Paths as long as INFINITE_LATENCY are
+    // unreachable, as with the original relaxation.
+    DistMatrix dist((size_t)num_switches * m_nodes, INFINITE_LATENCY);
+
+    auto search = [&](SwitchID first, SwitchID last) {
+        std::vector<int> d(num_switches);
+        std::deque<SwitchID> fifo;
+        std::priority_queue<DistEntry, std::vector<DistEntry>,
+                            std::greater<DistEntry>> heap;
+
+        for (SwitchID src = first; src < last; src++) {
+            std::fill(d.begin(), d.end(), INT_MAX);
+            d[src] = 0;
+            if (unit_weights) {
+                fifo.push_back(src);
+                while (!fifo.empty()) {
+                    SwitchID u = fifo.front();
+                    fifo.pop_front();
+                    for (const auto &e : adj[u]) {
+                        if (d[e.first] == INT_MAX) {
+                            d[e.first] = d[u] + 1;
+                            fifo.push_back(e.first);
                         }
-                        previous_minimum = minimum;
                     }
-                    if (current_dist[v][i][j] != minimum) {
-                        change = true;
-                        current_dist[v][i][j] = minimum;
-                        assert(intermediate_switch >= 0);
-                        assert(intermediate_switch < latencies[i].size());
-                        latencies[i][j][v] =
-                            latencies[i][intermediate_switch][v] +
-                            latencies[intermediate_switch][j][v];
+                }
+            } else {
+                heap.emplace(0, src);
+                while (!heap.empty()) {
+                    DistEntry top = heap.top();
+                    heap.pop();
+                    if (top.first > d[top.second])
+                        continue;
+                    for (const auto &e : adj[top.second]) {
+                        int nd = top.first + e.second;
+                        if (nd < d[e.first]) {
+                            d[e.first] = nd;
+                            heap.emplace(nd, e.first);
+                        }
                     }
                 }
             }
+
+            int *row = &dist[(size_t)src * m_nodes];
+            for (int f = 0; f < m_nodes; f++)
+                row[f] = std::min(d[f + m_nodes], INFINITE_LATENCY);
+        }
+    };
+
+    int num_threads = std::min<int>(std::thread::hardware_concurrency(),
+                                    num_switches / 64);
+    if (num_threads <= 1) {
+        search(0, num_switches);
+    } else {
+        std::vector<std::thread> threads;
+        int chunk = (num_switches + num_threads - 1) / num_threads;
+        for (int t = 0; t < num_threads; t++) {
+            SwitchID first = t * chunk;
+            SwitchID last = std::min(num_switches, (int)first + chunk);
+            threads.emplace_back(search, first, last);
         }
+        for (auto &thread : threads)
+            thread.join();
     }
-}
 
-Matrix
-Topology::shortest_path(const Matrix &weights, Matrix &latencies,
-                        Matrix &inter_switches)
-{
-    Matrix dist = weights;
-    extend_shortest_path(dist, latencies, inter_switches);
     return dist;
 }
 
-bool
-Topology::link_is_shortest_path_to_node(SwitchID src, SwitchID next,
-                                        SwitchID final, const Matrix &weights,
-                                        const Matrix &dist, int vnet)
-{
-    return weights[vnet][src][next] + dist[vnet][next][final] ==
-        dist[vnet][src][final];
-}
-
 NetDest
-Topology::shortest_path_to_node(SwitchID src, SwitchID next,
-                                const Matrix &weights, const Matrix &dist,
-                                int vnet)
+Topology::shortest_path_to_node(SwitchID src, SwitchID next, int weight,
+                                const DistMatrix &dist, int vnet)
 {
+    const int *src_dist = &dist[(size_t)src * m_nodes];
+    const int *next_dist = &dist[(size_t)next * m_nodes];
+
     NetDest result;
     int d = 0;
     int machines;
@@ -424,8 +449,7 @@ Topology::shortest_path_to_node(SwitchID src, SwitchID next,
             // [MachineType_base_number(MachineType_NUM)...
             //  2*MachineType_base_number(MachineType_NUM)-1] for the
             // component network
-            if (link_is_shortest_path_to_node(src, next, d + max_machines,
-                    weights, dist, vnet)) {
+            if (weight + next_dist[d] == src_dist[d]) {
                 MachineID mach = {(MachineType)m, i};
                 result.add(mach);
             }
@@ -53,12 +53,11 @@ class NetDest;
 class Network;
 
 /*
- * We use a three-dimensional vector matrix for calculating
- * the shortest paths for each pair of source and destination
- * and for each type of virtual network. The three dimensions
- * represent the source ID, destination ID, and vnet number.
+ * Shortest path distances of one group of virtual networks, kept in a
+ * flat row-major matrix. The rows are the source switch IDs and the
+ * columns the output endpoints (switch ID - number of nodes).
  */
-typedef std::vector<std::vector<std::vector<int>>> Matrix;
+typedef std::vector<int> DistMatrix;
 typedef std::string PortDirection;
 
 struct LinkEntry
@@ -89,20 +88,12 @@ class Topology
     void makeLink(Network *net, SwitchID src, SwitchID dest,
                   std::vector<NetDest>& routing_table_entry);
 
-    // Helper functions based on chapter 29 of Cormen et al.
-    void extend_shortest_path(Matrix &current_dist, Matrix &latencies,
-                              Matrix &inter_switches);
+    DistMatrix shortest_path(
+            const std::vector<std::vector<int>> &link_weights, int vnet,
+            int num_switches);
 
-    Matrix shortest_path(const Matrix &weights,
-            Matrix &latencies, Matrix &inter_switches);
-
-    bool link_is_shortest_path_to_node(SwitchID src, SwitchID next,
-            SwitchID final, const Matrix &weights, const Matrix &dist,
-            int vnet);
-
-    NetDest shortest_path_to_node(SwitchID src, SwitchID next,
-                                  const Matrix &weights, const Matrix &dist,
-                                  int vnet);
+    NetDest shortest_path_to_node(SwitchID src, SwitchID next, int weight,
+                                  const DistMatrix &dist, int vnet);
 
     const uint32_t m_nodes;
     const uint32_t m_number_of_switches;
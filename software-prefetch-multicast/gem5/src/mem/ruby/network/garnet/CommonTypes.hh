@@ -49,6 +49,8 @@ enum RoutingAlgorithm { TABLE_ = 0, XY_ = 1, CUSTOM_ = 2, YX_ = 3, XY_YX_ = 4,
                         NUM_ROUTING_ALGORITHM_};
 enum CoherenceConstraint { UNORDERED_ = 0, ORDERED_VNET_ = 1,
     ORDERED_PREPUSH_INV_ = 2, NUM_COHERENCE_CONSTRAINT_ };
+enum MulticastRouting { DETERMINISTIC_MULTICAST_ = 0,
+    WEST_FIRST_MULTICAST_ = 1, NUM_MULTICAST_ROUTING_ };
 
 struct RouteInfo
 {
@@ -81,4 +83,8 @@ struct RouteInfo
 
 #define INFINITE_ 10000
 
+// Output VC of the multicast replicas written into the staging buffer of a
+// blocked output port, see OutputUnit
+#define STAGING_VC_ -2
+
 #endif //__MEM_RUBY_NETWORK_GARNET_0_COMMONTYPES_HH__
@@ -31,6 +31,7 @@
 
 #include "mem/ruby/network/garnet/GarnetNetwork.hh"
 
+#include <algorithm>
 #include <cassert>
 
 #include "base/cast.hh"
@@ -46,6 +47,7 @@
 #include "mem/ruby/protocol/CoherenceRequestType.hh"
 #include "mem/ruby/protocol/CoherenceResponseType.hh"
 #include "mem/ruby/system/RubySystem.hh"
+#include "sim/stats_sampler.hh"
 
 using namespace std;
 
@@ -56,7 +58,10 @@ using namespace std;
  */
 
 GarnetNetwork::GarnetNetwork(const Params &p)
-    : Network(p)
+    : Network(p),
+      latencyIntervalEvent([this]{ writeLatencyInterval(); },
+                           "GarnetNetwork latency interval"),
+      latencyCsvInterval(p.latency_csv_interval)
 {
     m_num_rows = p.num_rows;
     m_ni_flit_size = p.ni_flit_size;
@@ -72,9 +77,18 @@ GarnetNetwork::GarnetNetwork(const Params &p)
     enableMulticast = p.enableMulticast;
     doubleChannelMulticast = p.doubleChannelMulticast;
     asynchronousMulticast = p.asynchronousMulticast;
+    multicastVcsPerVnet = p.multicastVcsPerVnet;
+    multicastStagingFlits = p.multicastStagingFlits;
     holdSWForMulticastOnly = p.holdSwitchForMulticastOnly;
     prepushFilter = p.prepushFilter;
     prepushFilterNoDrop = p.prepushFilterNoDrop;
+    ackCombining = p.ackCombining;
+
+    if (!p.latency_csv.empty()) {
+        fatal_if(latencyCsvInterval == 0,
+                 "The latency CSV needs a sampling interval");
+        latencyBreakdown.openCsv(p.latency_csv);
+    }
 
     if (p.coherenceConstraint == "unordered") {
         coherenceConstraint = UNORDERED_;
@@ -87,6 +101,30 @@ GarnetNetwork::GarnetNetwork(const Params &p)
               p.coherenceConstraint);
     }
 
+    if (p.multicastRouting == "deterministic") {
+        multicastRouting = DETERMINISTIC_MULTICAST_;
+    } else if (p.multicastRouting == "west-first") {
+        multicastRouting = WEST_FIRST_MULTICAST_;
+    } else {
+        panic("Unknown multicast routing: %s", p.multicastRouting);
+    }
+
+    if (multicastRouting == WEST_FIRST_MULTICAST_) {
+        fatal_if(!enableMulticast || m_num_rows <= 0,
+                 "West-first multicast routing needs enableMulticast and a "
+                 "mesh");
+        // The adaptive branches use all the turns but those into the west:
+        // they share the VCs with the unicast packets only if the unicast
+        // routes take no such turn either
+        fatal_if(multicastVcsPerVnet == 0 && m_routing_algorithm != XY_ &&
+                 m_routing_algorithm != TABLE_,
+                 "West-first multicast routing needs multicastVcsPerVnet "
+                 "with the routing algorithm %d", m_routing_algorithm);
+        warn_if(multicastVcsPerVnet == 0 && m_routing_algorithm == TABLE_,
+                "West-first multicast routing with the routing table, the "
+                "table routes must be XY or west-first for deadlock freedom");
+    }
+
     if (enableMulticast) {
         panic_if(!doubleChannelMulticast && !asynchronousMulticast,
                  "At least either doubleChannelMulticast or "
@@ -101,6 +139,17 @@ GarnetNetwork::GarnetNetwork(const Params &p)
                 "number of flits per data packet is %d but number of buffers "
                 "per data vc is %d, use \'--buffers-per-data-vc\' to specify "
                 "the buffer size!\n", num_flits, m_buffers_per_data_vc);
+        fatal_if(multicastVcsPerVnet >= p.vcs_per_vnet,
+                 "%d of the %d VCs per vnet reserved for multicast, the "
+                 "unicast packets need at least one", multicastVcsPerVnet,
+                 p.vcs_per_vnet);
+        fatal_if(multicastStagingFlits > 0 &&
+                 multicastStagingFlits < num_flits,
+                 "The multicast staging buffers need room for a data packet "
+                 "of %d flits", num_flits);
+    } else {
+        fatal_if(multicastVcsPerVnet > 0 || multicastStagingFlits > 0,
+                 "Multicast VCs and staging buffers need enableMulticast");
     }
 
     m_vnet_type.resize(m_virtual_networks);
@@ -147,6 +196,22 @@ GarnetNetwork::GarnetNetwork(const Params &p)
     inform("Garnet version %s\n", garnetVersion);
 }
 
+void
+GarnetNetwork::startup()
+{
+    Network::startup();
+
+    if (latencyBreakdown.csvEnabled())
+        schedule(latencyIntervalEvent, clockEdge(latencyCsvInterval));
+}
+
+void
+GarnetNetwork::writeLatencyInterval()
+{
+    latencyBreakdown.writeInterval(curTick());
+    schedule(latencyIntervalEvent, clockEdge(latencyCsvInterval));
+}
+
 void
 GarnetNetwork::init()
 {
@@ -488,6 +553,38 @@ GarnetNetwork::regStats()
     m_avg_packet_latency
         = m_avg_packet_network_latency + m_avg_packet_queueing_latency;
 
+    // Latency breakdown
+    m_packet_contention_latency
+        .init(m_virtual_networks)
+        .name(name() + ".packet_contention_latency")
+        .flags(Stats::oneline)
+        ;
+
+    m_packet_replica_latency
+        .init(m_virtual_networks)
+        .name(name() + ".packet_replica_latency")
+        .flags(Stats::oneline)
+        ;
+
+    for (int i = 0; i < m_virtual_networks; i++) {
+        m_packet_contention_latency.subname(i, csprintf("vnet-%i", i));
+        m_packet_replica_latency.subname(i, csprintf("vnet-%i", i));
+    }
+
+    m_avg_packet_vcontention_latency
+        .name(name() + ".average_packet_vcontention_latency")
+        .flags(Stats::oneline);
+    m_avg_packet_vcontention_latency =
+        m_packet_contention_latency / m_packets_received;
+
+    m_avg_packet_vreplica_latency
+        .name(name() + ".average_packet_vreplica_latency")
+        .flags(Stats::oneline);
+    m_avg_packet_vreplica_latency =
+        m_packet_replica_latency / m_packets_received;
+
+    latencyBreakdown.regStats(name(), m_virtual_networks);
+
     // Flits
     m_flits_received
         .init(m_virtual_networks)
@@ -724,6 +821,183 @@ GarnetNetwork::regStats()
         .name(name() + ".llc_prepush_filter_activity")
         .flags(Stats::nozero)
         ;
+
+    routerAcksCombined
+        .name(name() + ".router_acks_combined")
+        .desc("Prepush acks merged into another one in the routers")
+        .flags(Stats::nozero)
+        ;
+
+    routerMulticastVcHoldCycles
+        .name(name() + ".router_multicast_vc_hold_cycles")
+        .desc("Cycles from the first replica of the multicast packets to "
+              "the release of their input VC in the routers")
+        .flags(Stats::nozero)
+        ;
+
+    routerMulticastStagedFlits
+        .name(name() + ".router_multicast_staged_flits")
+        .desc("Multicast replica flits staged at a blocked output")
+        .flags(Stats::nozero)
+        ;
+
+    routerMulticastAdaptiveRoutes
+        .name(name() + ".router_multicast_adaptive_routes")
+        .desc("Multicast destinations with several productive outports")
+        .flags(Stats::nozero)
+        ;
+
+    routerMulticastAdaptiveDeviations
+        .name(name() + ".router_multicast_adaptive_deviations")
+        .desc("Multicast destinations routed off the routing algorithm")
+        .flags(Stats::nozero)
+        ;
+
+    regLiveStats();
+}
+
+void
+GarnetNetwork::regLiveStats()
+{
+    // Same sums as collateStats(), over the counters of the routers, NIs
+    // and links as they are now
+    auto routers = [this](double (Router::*live)()) {
+        return [this, live]() {
+            double sum = 0;
+            for (auto router : m_routers)
+                sum += (router->*live)();
+            return sum;
+        };
+    };
+    StatsSampler::addLiveScalar(routerPrepushFilterQueries,
+        routers(&Router::livePrepushFilterQueries));
+    StatsSampler::addLiveScalar(routerPrepushFilterRegistries,
+        routers(&Router::livePrepushFilterRegistries));
+    StatsSampler::addLiveScalar(routerPrepushFilterActivity,
+        routers(&Router::livePrepushFilterActivity));
+    StatsSampler::addLiveScalar(routerAcksCombined,
+        routers(&Router::liveAcksCombined));
+    StatsSampler::addLiveScalar(routerMulticastVcHoldCycles,
+        routers(&Router::liveMulticastVcHoldCycles));
+    StatsSampler::addLiveScalar(routerMulticastStagedFlits,
+        routers(&Router::liveMulticastStagedFlits));
+    StatsSampler::addLiveScalar(routerMulticastAdaptiveRoutes,
+        routers(&Router::liveMulticastAdaptiveRoutes));
+    StatsSampler::addLiveScalar(routerMulticastAdaptiveDeviations,
+        routers(&Router::liveMulticastAdaptiveDeviations));
+
+    auto nis = [this](auto live) {
+        return [this, live]() {
+            double sum = 0;
+            for (auto ni : m_nis)
+                sum += (ni->*live)();
+            return sum;
+        };
+    };
+    StatsSampler::addLiveScalar(coreNIPrepushFilterActivity,
+        nis(&NetworkInterface::getCoreNIPrepushFilterActivity));
+    StatsSampler::addLiveScalar(llcNIPrepushFilterActivity,
+        nis(&NetworkInterface::getLLCNIPrepushFilterActivity));
+    StatsSampler::addLiveScalar(corePrepushFilterActivity,
+        nis(&NetworkInterface::getCorePrepushFilterActivity));
+    StatsSampler::addLiveScalar(llcPrepushFilterActivity,
+        nis(&NetworkInterface::getLLCPrepushFilterActivity));
+
+    auto links = [this](link_type type, auto live) {
+        return [this, type, live]() {
+            double sum = 0;
+            for (auto link : m_networklinks) {
+                if (link->getType() == type)
+                    sum += (link->*live)();
+            }
+            return sum;
+        };
+    };
+    const std::pair<link_type, Stats::Scalar *> totals[] = {
+        {EXT_IN_, &m_total_ext_in_link_utilization},
+        {EXT_OUT_, &m_total_ext_out_link_utilization},
+        {INT_, &m_total_int_link_utilization},
+    };
+    for (const auto &total : totals) {
+        StatsSampler::addLiveScalar(*total.second,
+            links(total.first, &NetworkLink::getLinkUtilization));
+    }
+    const std::pair<link_type, Stats::Scalar *> ctrls[] = {
+        {EXT_IN_, &extInLinkCtrlUtilization},
+        {EXT_OUT_, &extOutLinkCtrlUtilization},
+        {INT_, &intLinkCtrlUtilization},
+    };
+    for (const auto &ctrl : ctrls) {
+        StatsSampler::addLiveScalar(*ctrl.second,
+            links(ctrl.first, &NetworkLink::getLinkCtrlUtilization));
+    }
+    const std::pair<link_type, Stats::Scalar *> datas[] = {
+        {EXT_IN_, &extInLinkDataUtilization},
+        {EXT_OUT_, &extOutLinkDataUtilization},
+        {INT_, &intLinkDataUtilization},
+    };
+    for (const auto &data : datas) {
+        StatsSampler::addLiveScalar(*data.second,
+            links(data.first, &NetworkLink::getLinkDataUtilization));
+    }
+    const std::pair<link_type, Stats::Scalar *> prepushes[] = {
+        {EXT_IN_, &extInLinkPrepushUtilization},
+        {EXT_OUT_, &extOutLinkPrepushUtilization},
+        {INT_, &intLinkPrepushUtilization},
+    };
+    for (const auto &prepush : prepushes) {
+        StatsSampler::addLiveScalar(*prepush.second,
+            links(prepush.first, &NetworkLink::getLinkPrepushUtilization));
+    }
+
+    const std::pair<link_type, Stats::Vector *> breakdowns[] = {
+        {EXT_IN_, &extInLinkUtilization},
+        {EXT_OUT_, &extOutLinkUtilization},
+        {INT_, &intLinkUtilization},
+    };
+    for (const auto &breakdown : breakdowns) {
+        link_type type = breakdown.first;
+        size_t size = breakdown.second->size();
+        StatsSampler::addLiveVector(*breakdown.second,
+            [this, type, size](double *values) {
+                std::fill(values, values + size, 0);
+                for (auto link : m_networklinks) {
+                    if (link->getType() != type)
+                        continue;
+                    const auto &utilized =
+                        link->getLinkUtilizationBreakdown();
+                    for (size_t j = 0; j < std::min(size, utilized.size()); j++)
+                        values[j] += utilized[j];
+                }
+            });
+    }
+
+    StatsSampler::addLiveScalar(m_average_link_utilization,
+        [this]() {
+            RubySystem *rs = params().ruby_system;
+            double time_delta = double(curCycle() - rs->getStartCycle());
+            double sum = 0;
+            // No cycle elapsed yet at a sample right after a reset
+            if (time_delta == 0)
+                return sum;
+            for (auto link : m_networklinks)
+                sum += double(link->getLinkUtilization()) / time_delta;
+            return sum;
+        });
+    size_t vcs = m_average_vc_load.size();
+    StatsSampler::addLiveVector(m_average_vc_load,
+        [this, vcs](double *values) {
+            RubySystem *rs = params().ruby_system;
+            double time_delta = double(curCycle() - rs->getStartCycle());
+            std::fill(values, values + vcs, 0);
+            if (time_delta == 0)
+                return;
+            for (auto link : m_networklinks) {
+                const auto &vc_load = link->getVcLoad();
+                for (size_t j = 0; j < std::min(vcs, vc_load.size()); j++)
+                    values[j] += double(vc_load[j]) / time_delta;
+            }
+        });
 }
 
 void
@@ -790,6 +1064,14 @@ GarnetNetwork::collateStats()
             m_routers[i]->getPrepushFilterRegistries();
         routerPrepushFilterActivity +=
             m_routers[i]->getPrepushFilterActivity();
+        routerAcksCombined += m_routers[i]->getAcksCombined();
+        routerMulticastVcHoldCycles +=
+            m_routers[i]->getMulticastVcHoldCycles();
+        routerMulticastStagedFlits += m_routers[i]->getMulticastStagedFlits();
+        routerMulticastAdaptiveRoutes +=
+            m_routers[i]->getMulticastAdaptiveRoutes();
+        routerMulticastAdaptiveDeviations +=
+            m_routers[i]->getMulticastAdaptiveDeviations();
     }
 
     for (unsigned int i = 0; i < m_nis.size(); ++i) {
@@ -38,7 +38,9 @@
 #include "mem/ruby/network/Network.hh"
 #include "mem/ruby/network/fault_model/FaultModel.hh"
 #include "mem/ruby/network/garnet/CommonTypes.hh"
+#include "mem/ruby/network/garnet/LatencyBreakdown.hh"
 #include "params/GarnetNetwork.hh"
+#include "sim/eventq.hh"
 
 class FaultModel;
 class NetworkInterface;
@@ -55,6 +57,7 @@ class GarnetNetwork : public Network
     ~GarnetNetwork() = default;
 
     void init();
+    void startup() override;
 
     const char *garnetVersion = "3.0";
 
@@ -76,8 +79,14 @@ class GarnetNetwork : public Network
     bool isMulticastEnabled() const { return enableMulticast; }
     bool isDoubleChannelMulticast() const { return doubleChannelMulticast; }
     bool isAsynchronousMulticast() const { return asynchronousMulticast; }
+    uint32_t getMulticastVcsPerVnet() const { return multicastVcsPerVnet; }
+    uint32_t getMulticastStagingFlits() const
+    {
+        return multicastStagingFlits;
+    }
     inline bool isPrepushFilterEnabled() const { return prepushFilter; }
     inline bool isPrepushFilterButNoDrop() const { return prepushFilterNoDrop; };
+    inline bool isAckCombiningEnabled() const { return ackCombining; }
     inline bool holdSwitchForMulticastOnly() const
     {
         return holdSWForMulticastOnly;
@@ -87,6 +96,11 @@ class GarnetNetwork : public Network
     {
         return coherenceConstraint;
     }
+    inline MulticastRouting
+    getMulticastRouting() const
+    {
+        return multicastRouting;
+    }
 
     // Internal configuration
     bool isVNetOrdered(int vnet) const { return m_ordered[vnet]; }
@@ -164,6 +178,17 @@ class GarnetNetwork : public Network
         m_total_hops += hops;
     }
 
+    void
+    sampleLatencyBreakdown(LatencyBreakdown::MsgClass cls, int vnet,
+                           const LatencyBreakdown::Delays &delays)
+    {
+        m_packet_contention_latency[vnet] +=
+            delays[LatencyBreakdown::CONTENTION];
+        m_packet_replica_latency[vnet] +=
+            delays[LatencyBreakdown::REPLICA_STALL];
+        latencyBreakdown.sample(cls, vnet, delays);
+    }
+
   protected:
     // Configuration
     int m_num_rows;
@@ -177,10 +202,14 @@ class GarnetNetwork : public Network
     bool enableMulticast;
     bool doubleChannelMulticast;
     bool asynchronousMulticast;
+    uint32_t multicastVcsPerVnet;
+    uint32_t multicastStagingFlits;
     bool prepushFilter;
     bool prepushFilterNoDrop;
+    bool ackCombining;
     bool holdSWForMulticastOnly;
     CoherenceConstraint coherenceConstraint;
+    MulticastRouting multicastRouting;
 
     // Statistical variables
     Stats::Vector m_packets_received;
@@ -194,6 +223,13 @@ class GarnetNetwork : public Network
     Stats::Formula m_avg_packet_queueing_latency;
     Stats::Formula m_avg_packet_latency;
 
+    // Parts of the network latency, see LatencyBreakdown
+    Stats::Vector m_packet_contention_latency;
+    Stats::Vector m_packet_replica_latency;
+    Stats::Formula m_avg_packet_vcontention_latency;
+    Stats::Formula m_avg_packet_vreplica_latency;
+    LatencyBreakdown latencyBreakdown;
+
     Stats::Vector m_flits_received;
     Stats::Vector m_flits_injected;
     Stats::Vector m_flit_network_latency;
@@ -234,6 +270,19 @@ class GarnetNetwork : public Network
     Stats::Scalar corePrepushFilterActivity;
     Stats::Scalar llcPrepushFilterActivity;
 
+    // Prepush acks merged into another one in the routers
+    Stats::Scalar routerAcksCombined;
+
+    // Input VCs held by the multicast packets, and their replicas staged at
+    // the outputs instead
+    Stats::Scalar routerMulticastVcHoldCycles;
+    Stats::Scalar routerMulticastStagedFlits;
+
+    // Multicast branches routed adaptively, and those of them not taking
+    // the outport of the routing algorithm
+    Stats::Scalar routerMulticastAdaptiveRoutes;
+    Stats::Scalar routerMulticastAdaptiveDeviations;
+
     Stats::Scalar  m_total_hops;
     Stats::Formula m_avg_hops;
 
@@ -241,6 +290,15 @@ class GarnetNetwork : public Network
     GarnetNetwork(const GarnetNetwork& obj);
     GarnetNetwork& operator=(const GarnetNetwork& obj);
 
+    // Gives the statistics sampler the current values of the statistics
+    // that collateStats() only sums up at dumps
+    void regLiveStats();
+
+    // Streams the latency breakdown of every interval
+    void writeLatencyInterval();
+    EventFunctionWrapper latencyIntervalEvent;
+    Cycles latencyCsvInterval;
+
     int requestVnet;
     int forwardRequestVnet;
     int numCoherenceMsgType;
@@ -54,10 +54,23 @@ class GarnetNetwork(RubyNetwork):
     asynchronousMulticast = Param.Bool(False, "send the whole packet one by "
             "one to each output VC without reserving multiple output VCs at "
             "the same time (only reserving one output VC a time)")
+    multicastVcsPerVnet = Param.UInt32(0, "virtual channels of every "
+            "virtual network reserved for the multicast packets, the "
+            "unicast packets use the others (0 to share all of them)")
+    multicastStagingFlits = Param.UInt32(0, "flits buffered at every output "
+            "port for the multicast replicas blocked there, so that they "
+            "release their input VC (0 to disable)")
+    multicastRouting = Param.String("deterministic", "routing of the "
+            "multicast branches: 'deterministic' to follow the routing "
+            "algorithm to every destination, 'west-first' for minimal "
+            "adaptive west-first routing on a mesh, taking the productive "
+            "outport with the most downstream credits")
     prepushFilter = Param.Bool(False, "filter unnecessary data requests when "
             "requests and prepush response meet in network routers")
     prepushFilterNoDrop = Param.Bool(False, "Enable filter but don't filter unnecessary data requests when "
             "requests and prepush response meet in network routers")
+    ackCombining = Param.Bool(False, "combine the prepush acks to the same "
+            "L2 that meet in network routers into one message")
     holdSwitchForMulticastOnly = Param.Bool(False, "hold switch for multicast"
             " data packets only, others will do flit-based arbitration")
     coherenceConstraint = Param.String("unordered", "NoC coherence constraint"
@@ -65,6 +78,11 @@ class GarnetNetwork(RubyNetwork):
             "ordered response and unblock-forward virtual networks, "
             "'ordered-prepush-inv' for only ordered prepush and invalidation "
             "messages")
+    latency_csv = Param.String("", "file of the output directory to stream "
+            "the per interval latency breakdown of the packets to, as CSV "
+            "(empty to disable)")
+    latency_csv_interval = Param.Cycles(10000, "sampling interval of the "
+            "latency CSV")
 
 class GarnetNetworkInterface(ClockedObject):
     type = 'GarnetNetworkInterface'
@@ -200,6 +200,18 @@ class InputUnit : public Consumer
         return virtualChannels[invc].isMulticast();
     }
 
+    inline void
+    markMulticastGrant(int invc, Tick time)
+    {
+        virtualChannels[invc].markMulticastGrant(time);
+    }
+
+    inline Tick
+    getMulticastGrantTime(int invc)
+    {
+        return virtualChannels[invc].getMulticastGrantTime();
+    }
+
     inline bool
     isMulticastHeadFlit(int invc)
     {
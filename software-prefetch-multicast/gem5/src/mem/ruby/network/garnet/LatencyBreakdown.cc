@@ -0,0 +1,109 @@
+/* @file
+ * Per message class breakdown of the NoC packet latency
+ */
+
+#include "mem/ruby/network/garnet/LatencyBreakdown.hh"
+
+#include "base/cprintf.hh"
+#include "base/output.hh"
+
+const char *
+LatencyBreakdown::className(int cls)
+{
+    static const char *names[NUM_MSG_CLASSES] = {
+        "prepush_response", "filtered_gets", "timeout_request",
+        "host_switch_request", "read_request", "other"
+    };
+    return names[cls];
+}
+
+const char *
+LatencyBreakdown::componentName(int component)
+{
+    static const char *names[NUM_COMPONENTS] = {
+        "ni_queueing", "network", "contention", "replica_stall"
+    };
+    return names[component];
+}
+
+LatencyBreakdown::MsgClass
+LatencyBreakdown::classify(const MsgPtr &msg, bool filtered)
+{
+    if (msg->isPrepushMsg())
+        return PREPUSH_RESPONSE;
+    if (filtered)
+        return FILTERED_GETS;
+    if (msg->isTimeoutRequest())
+        return TIMEOUT_REQUEST;
+    if (msg->isHostSwitchRequest())
+        return HOST_SWITCH_REQUEST;
+    if (msg->isReadRequest())
+        return READ_REQUEST;
+    return OTHER_MSG;
+}
+
+void
+LatencyBreakdown::regStats(const std::string &name, int num_vnets)
+{
+    for (int cls = 0; cls < NUM_MSG_CLASSES; cls++) {
+        for (int c = 0; c < NUM_COMPONENTS; c++) {
+            latency[cls][c]
+                .init(16)
+                .name(csprintf("%s.%s_latency.%s", name, className(cls),
+                               componentName(c)))
+                .desc(csprintf("%s latency of the %s packets (ticks)",
+                               componentName(c), className(cls)))
+                .flags(Stats::nozero | Stats::pdf)
+                ;
+        }
+    }
+
+    numVnets = num_vnets;
+    intervals.assign(NUM_MSG_CLASSES * numVnets, Interval());
+}
+
+void
+LatencyBreakdown::sample(MsgClass cls, int vnet, const Delays &delays)
+{
+    for (int c = 0; c < NUM_COMPONENTS; c++)
+        latency[cls][c].sample(delays[c]);
+
+    if (csv) {
+        Interval &interval = intervals[cls * numVnets + vnet];
+        interval.packets++;
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+            interval.total[c] += delays[c];
+    }
+}
+
+void
+LatencyBreakdown::openCsv(const std::string &file)
+{
+    csv = simout.create(file)->stream();
+    *csv << "tick,class,vnet,packets";
+    for (int c = 0; c < NUM_COMPONENTS; c++)
+        *csv << "," << componentName(c);
+    *csv << "\n";
+}
+
+void
+LatencyBreakdown::writeInterval(Tick now)
+{
+    for (int cls = 0; cls < NUM_MSG_CLASSES; cls++) {
+        for (int vnet = 0; vnet < numVnets; vnet++) {
+            Interval &interval = intervals[cls * numVnets + vnet];
+            if (!interval.packets)
+                continue;
+
+            *csv << now << "," << className(cls) << "," << vnet << ","
+                 << interval.packets;
+            for (int c = 0; c < NUM_COMPONENTS; c++) {
+                ccprintf(*csv, ",%.2f",
+                         double(interval.total[c]) / interval.packets);
+            }
+            *csv << "\n";
+            interval = Interval();
+        }
+    }
+    csv->flush();
+}
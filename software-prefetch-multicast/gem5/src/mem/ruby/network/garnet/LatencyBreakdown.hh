@@ -0,0 +1,95 @@
+/* @file
+ * Per message class breakdown of the NoC packet latency
+ */
+
+#ifndef __MEM_RUBY_NETWORK_GARNET_0_LATENCYBREAKDOWN_HH__
+#define __MEM_RUBY_NETWORK_GARNET_0_LATENCYBREAKDOWN_HH__
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/types.hh"
+#include "mem/ruby/slicc_interface/Message.hh"
+
+/**
+ * Latency of the packets received by the network interfaces, split in
+ * - the NI queueing, at the source and at the destination NI,
+ * - the network traversal, i.e. the router pipelines and the links,
+ * - the router contention, waiting for the switch allocation,
+ * - the replica stall, waiting for the other replicas of a multicast
+ *   flit to be granted,
+ * with a histogram per message class and component.
+ *
+ * Optionally, the mean of each component over the packets of every
+ * sampling interval is streamed as CSV, one row per message class and
+ * vnet which received packets in the interval, so that the latency can
+ * be plotted over time without parsing stats.txt.
+ */
+class LatencyBreakdown
+{
+  public:
+    enum MsgClass
+    {
+        PREPUSH_RESPONSE,
+        FILTERED_GETS,
+        TIMEOUT_REQUEST,
+        HOST_SWITCH_REQUEST,
+        READ_REQUEST,
+        OTHER_MSG,
+        NUM_MSG_CLASSES
+    };
+
+    enum Component
+    {
+        NI_QUEUEING,
+        NETWORK,
+        CONTENTION,
+        REPLICA_STALL,
+        NUM_COMPONENTS
+    };
+
+    typedef Tick Delays[NUM_COMPONENTS];
+
+    static const char *className(int cls);
+    static const char *componentName(int component);
+
+    /**
+     * Class of a message received by a network interface
+     * @param filtered The message is a GetS filtered by the prepush filter
+     *        of the LLC NI
+     */
+    static MsgClass classify(const MsgPtr &msg, bool filtered);
+
+    LatencyBreakdown() : csv(nullptr), numVnets(0) {}
+
+    void regStats(const std::string &name, int num_vnets);
+
+    void sample(MsgClass cls, int vnet, const Delays &delays);
+
+    /** Stream the interval samples to the file in the output directory */
+    void openCsv(const std::string &file);
+
+    bool csvEnabled() const { return csv != nullptr; }
+
+    /** Write the rows of the interval ending at now and start a new one */
+    void writeInterval(Tick now);
+
+  private:
+    struct Interval
+    {
+        uint64_t packets = 0;
+        Delays total = {};
+    };
+
+    Stats::Histogram latency[NUM_MSG_CLASSES][NUM_COMPONENTS];
+
+    std::ostream *csv;
+    int numVnets;
+
+    /** Interval accumulators, indexed by class * numVnets + vnet */
+    std::vector<Interval> intervals;
+};
+
+#endif // __MEM_RUBY_NETWORK_GARNET_0_LATENCYBREAKDOWN_HH__
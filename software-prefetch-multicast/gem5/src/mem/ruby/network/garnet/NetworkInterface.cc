@@ -32,6 +32,7 @@
 
 #include "mem/ruby/network/garnet/NetworkInterface.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -161,7 +162,7 @@ NetworkInterface::dequeueCallback()
 }
 
 void
-NetworkInterface::incrementStats(flit *t_flit)
+NetworkInterface::incrementStats(flit *t_flit, bool filtered)
 {
     int vnet = t_flit->get_vnet();
 
@@ -181,6 +182,21 @@ NetworkInterface::incrementStats(flit *t_flit)
         m_net_ptr->increment_received_packets(vnet);
         m_net_ptr->increment_packet_network_latency(network_delay, vnet);
         m_net_ptr->increment_packet_queueing_latency(queueing_delay, vnet);
+
+        // The network delay less the waits in the routers is the time
+        // spent in the router pipelines and on the links
+        Tick contention_delay = t_flit->get_contention_delay();
+        Tick replica_delay = t_flit->get_replica_delay();
+        LatencyBreakdown::Delays delays;
+        delays[LatencyBreakdown::NI_QUEUEING] = queueing_delay;
+        delays[LatencyBreakdown::CONTENTION] = contention_delay;
+        delays[LatencyBreakdown::REPLICA_STALL] = replica_delay;
+        delays[LatencyBreakdown::NETWORK] =
+            network_delay - std::min(network_delay,
+                                     contention_delay + replica_delay);
+        m_net_ptr->sampleLatencyBreakdown(
+            LatencyBreakdown::classify(t_flit->get_msg_ptr(), filtered),
+            vnet, delays);
     }
 
     // Hops
@@ -329,7 +345,7 @@ NetworkInterface::wakeup()
                                                true, curTick());
                     iPort->sendCredit(cFlit);
                     // Update stats and delete flit pointer
-                    incrementStats(t_flit);
+                    incrementStats(t_flit, filter_flit);
                     delete t_flit;
                 } else if (!iPort->messageEnqueuedThisCycle &&
                     outNode_ptr[vnet]->areNSlotsAvailable(1, curTime)) {
@@ -501,7 +517,7 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         for (int ctr = 0; ctr < dest_nodes.size(); ctr++) {
 
             // this will return a free output virtual channel
-            int vc = calculateVC(vnet);
+            int vc = calculateVC(vnet, false);
 
             if (vc == -1) {
                 return false ;
@@ -554,6 +570,7 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
             // indicate if prepush or not for in-network filtering
             bool prepush = net_msg_ptr->isPrepushMsg();
             bool read_request = net_msg_ptr->isReadRequest();
+            bool prepush_ack = net_msg_ptr->isPrepushAck();
             Addr addr = net_msg_ptr->getLineAddr();
             assert(!prepush || !read_request);
 
@@ -579,6 +596,7 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
 
                 fl->setReadRequest(read_request);
                 fl->setPrepush(prepush);
+                fl->setPrepushAck(prepush_ack);
                 fl->setAddr(addr);
                 fl->set_src_delay(curTick() - msg_ptr->getTime());
                 niOutVcs[vc].insert(fl);
@@ -591,7 +609,7 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
         }
     } else {
         // this will return a free output virtual channel
-        int vc = calculateVC(vnet);
+        int vc = calculateVC(vnet, true);
 
         if (vc == -1) {
             return false ;
@@ -698,16 +716,23 @@ NetworkInterface::flitisizeMessage(MsgPtr msg_ptr, int vnet)
     return true ;
 }
 
-// Looking for a free output vc
+// Looking for a free output vc, among the last multicastVcsPerVnet ones of
+// the vnet for a multicast packet and the others for a unicast one
 int
-NetworkInterface::calculateVC(int vnet)
+NetworkInterface::calculateVC(int vnet, bool multicast)
 {
+    int first_multicast_vc =
+        m_vc_per_vnet - m_net_ptr->getMulticastVcsPerVnet();
     for (int i = 0; i < m_vc_per_vnet; i++) {
         int delta = m_vc_allocator[vnet];
         m_vc_allocator[vnet]++;
         if (m_vc_allocator[vnet] == m_vc_per_vnet)
             m_vc_allocator[vnet] = 0;
 
+        if (first_multicast_vc < m_vc_per_vnet &&
+            (delta >= first_multicast_vc) != multicast)
+            continue;
+
         if (outVcState[(vnet*m_vc_per_vnet) + delta].isInState(
                     IDLE_, curTick())) {
             vc_busy_counter[vnet] = 0;
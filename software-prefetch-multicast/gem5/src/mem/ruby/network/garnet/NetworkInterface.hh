@@ -355,14 +355,14 @@ class NetworkInterface : public ClockedObject, public Consumer
 
     void checkStallQueue();
     bool flitisizeMessage(MsgPtr msg_ptr, int vnet);
-    int calculateVC(int vnet);
+    int calculateVC(int vnet, bool multicast);
 
 
     void scheduleOutputPort(OutputPort *oPort);
     void scheduleOutputLink();
     void checkReschedule();
 
-    void incrementStats(flit *t_flit);
+    void incrementStats(flit *t_flit, bool filtered = false);
 
     InputPort *getInportForVnet(int vnet);
     OutputPort *getOutportForVnet(int vnet) const;
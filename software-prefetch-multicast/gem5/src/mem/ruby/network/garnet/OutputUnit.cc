@@ -31,6 +31,7 @@
 
 #include "mem/ruby/network/garnet/OutputUnit.hh"
 
+#include "debug/GarnetMulticast.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/Credit.hh"
 #include "mem/ruby/network/garnet/CreditLink.hh"
@@ -40,7 +41,10 @@
 OutputUnit::OutputUnit(int id, PortDirection direction, Router *router,
   uint32_t consumerVcs)
   : Consumer(router), m_router(router), m_id(id), m_direction(direction),
-    m_vc_per_vnet(consumerVcs)
+    m_vc_per_vnet(consumerVcs),
+    m_multicast_vcs(m_router->get_net_ptr()->getMulticastVcsPerVnet()),
+    stagingCapacity(m_router->get_net_ptr()->getMulticastStagingFlits()),
+    stagingOutvc(-1), stagingIncomplete(false)
 {
     const int m_num_vcs = consumerVcs * m_router->get_num_vnets();
     outVcState.reserve(m_num_vcs);
@@ -84,12 +88,29 @@ OutputUnit::has_credit(int out_vc)
 }
 
 
+// The last VCs of every vnet are reserved for the multicast packets if
+// multicastVcsPerVnet is set, so that the unicast packets never wait for a
+// VC held by a multicast one
+void
+OutputUnit::vcRange(int vnet, bool multicast, int &vc_begin, int &vc_end)
+{
+    vc_begin = vnet*m_vc_per_vnet;
+    vc_end = vc_begin + m_vc_per_vnet;
+    if (m_multicast_vcs > 0) {
+        if (multicast)
+            vc_begin = vc_end - m_multicast_vcs;
+        else
+            vc_end -= m_multicast_vcs;
+    }
+}
+
 // Check if the output port (i.e., input port at next router) has free VCs.
 bool
-OutputUnit::has_free_vc(int vnet)
+OutputUnit::has_free_vc(int vnet, bool multicast)
 {
-    int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
+    int vc_begin, vc_end;
+    vcRange(vnet, multicast, vc_begin, vc_end);
+    for (int vc = vc_begin; vc < vc_end; vc++) {
         if (is_vc_idle(vc, curTick()))
             return true;
     }
@@ -97,12 +118,26 @@ OutputUnit::has_free_vc(int vnet)
     return false;
 }
 
+// Buffer slots free downstream in the VCs a packet may use in a vnet
+int
+OutputUnit::getFreeCredits(int vnet, bool multicast)
+{
+    int vc_begin, vc_end;
+    vcRange(vnet, multicast, vc_begin, vc_end);
+    int credits = 0;
+    for (int vc = vc_begin; vc < vc_end; vc++)
+        credits += get_credit_count(vc);
+
+    return credits;
+}
+
 // Assign a free output VC to the winner of Switch Allocation
 int
-OutputUnit::select_free_vc(int vnet, uint64_t packet_id)
+OutputUnit::select_free_vc(int vnet, uint64_t packet_id, bool multicast)
 {
-    int vc_base = vnet*m_vc_per_vnet;
-    for (int vc = vc_base; vc < vc_base + m_vc_per_vnet; vc++) {
+    int vc_begin, vc_end;
+    vcRange(vnet, multicast, vc_begin, vc_end);
+    for (int vc = vc_begin; vc < vc_end; vc++) {
         if (is_vc_idle(vc, curTick())) {
             outVcState[vc].setState(ACTIVE_, curTick(), packet_id);
             return vc;
@@ -163,6 +198,76 @@ OutputUnit::insert_flit(flit *t_flit)
     m_out_link->scheduleEventAbsolute(m_router->clockEdge(Cycles(1)));
 }
 
+// A multicast head flit without a free VC here may be staged if the whole
+// packet fits and no other packet is being staged
+bool
+OutputUnit::canStagePacket(int num_flits)
+{
+    return !stagingIncomplete &&
+        stagingBuffer.getSize() + num_flits <= stagingCapacity;
+}
+
+void
+OutputUnit::reserveStaging(int num_flits)
+{
+    assert(canStagePacket(num_flits));
+    stagingIncomplete = true;
+}
+
+void
+OutputUnit::stageFlit(flit *t_flit, Tick time)
+{
+    assert(stagingIncomplete);
+    t_flit->set_time(time);
+    stagingBuffer.insert(t_flit);
+
+    if (t_flit->get_type() == TAIL_ || t_flit->get_type() == HEAD_TAIL_)
+        stagingIncomplete = false;
+}
+
+/*
+ * Send the oldest staged flit out of this output port: a head flit needs a
+ * free multicast VC, the next flits a credit in its VC. The flit takes the
+ * output link of this cycle, the switch allocator grants no input flit to
+ * this output port then.
+ */
+
+bool
+OutputUnit::sendStagedFlit()
+{
+    if (!stagingBuffer.isReady(curTick()))
+        return false;
+
+    flit *t_flit = stagingBuffer.peekTopFlit();
+    flit_type ftype = t_flit->get_type();
+    if (ftype == HEAD_ || ftype == HEAD_TAIL_) {
+        assert(stagingOutvc == -1);
+        stagingOutvc = select_free_vc(t_flit->get_vnet(),
+                                      t_flit->getPacketID(), true);
+        if (stagingOutvc == -1)
+            return false;
+    } else if (!has_credit(stagingOutvc)) {
+        return false;
+    }
+
+    stagingBuffer.getTopFlit();
+    t_flit->set_vc(stagingOutvc);
+    decrement_credit(stagingOutvc);
+
+    t_flit->advance_stage(LT_, m_router->clockEdge(Cycles(1)));
+    t_flit->set_time(m_router->clockEdge(Cycles(1)));
+    insert_flit(t_flit);
+
+    DPRINTF(GarnetMulticast, "Router[%d]: OutputUnit %d (%s): sends staged "
+            "flit %s on outvc %d\n", m_router->get_id(), m_id, m_direction,
+            *t_flit, stagingOutvc);
+
+    if (ftype == TAIL_ || ftype == HEAD_TAIL_)
+        stagingOutvc = -1;
+
+    return true;
+}
+
 std::string
 OutputUnit::printOutputString(int vnet) const
 {
@@ -192,11 +297,13 @@ OutputUnit::printOutputString(int vnet) const
 bool
 OutputUnit::functionalRead(Packet *pkt)
 {
-    return outBuffer.functionalRead(pkt);
+    return outBuffer.functionalRead(pkt) ||
+        stagingBuffer.functionalRead(pkt);
 }
 
 uint32_t
 OutputUnit::functionalWrite(Packet *pkt)
 {
-    return outBuffer.functionalWrite(pkt);
+    return outBuffer.functionalWrite(pkt) +
+        stagingBuffer.functionalWrite(pkt);
 }
@@ -58,8 +58,15 @@ class OutputUnit : public Consumer
     void decrement_credit(int out_vc);
     void increment_credit(int out_vc);
     bool has_credit(int out_vc);
-    bool has_free_vc(int vnet);
-    int select_free_vc(int vnet, uint64_t packet_id);
+    bool has_free_vc(int vnet, bool multicast);
+    int select_free_vc(int vnet, uint64_t packet_id, bool multicast);
+
+    // Staging buffer of the multicast replicas blocked at this output
+    bool canStagePacket(int num_flits);
+    void reserveStaging(int num_flits);
+    void stageFlit(flit *t_flit, Tick time);
+    bool sendStagedFlit();
+    inline bool hasStagedFlits() { return !stagingBuffer.isEmpty(); }
 
     inline PortDirection get_direction() { return m_direction; }
     inline int get_id() { return m_id; }
@@ -70,6 +77,8 @@ class OutputUnit : public Consumer
         return outVcState[vc].get_credit_count();
     }
 
+    int getFreeCredits(int vnet, bool multicast);
+
     inline int
     get_outlink_id()
     {
@@ -114,6 +123,18 @@ class OutputUnit : public Consumer
     flitBuffer outBuffer;
     // vc state of downstream router
     std::vector<OutVcState> outVcState;
+
+    // First and one past the last VC a packet may use in a vnet
+    void vcRange(int vnet, bool multicast, int &vc_begin, int &vc_end);
+    int m_multicast_vcs;
+
+    // Multicast replicas which got the switch but no VC of this output: a
+    // packet is written in whole before the next one, and sent on
+    // stagingOutvc as the VCs free up
+    flitBuffer stagingBuffer;
+    int stagingCapacity;
+    int stagingOutvc;
+    bool stagingIncomplete;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_0_OUTPUTUNIT_HH__
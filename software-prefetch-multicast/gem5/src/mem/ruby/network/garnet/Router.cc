@@ -39,6 +39,7 @@
 #include "mem/ruby/network/garnet/NetworkLink.hh"
 #include "mem/ruby/network/garnet/OutputUnit.hh"
 #include "mem/ruby/network/garnet/PrepushFilter.hh"
+#include "sim/stats_sampler.hh"
 
 using namespace std;
 
@@ -239,11 +240,53 @@ Router::regStats()
         .flags(Stats::nozero)
     ;
 
+    acksCombined
+        .name(name() + ".acks_combined")
+        .flags(Stats::nozero)
+    ;
+
+    multicastVcHoldCycles
+        .name(name() + ".multicast_vc_hold_cycles")
+        .flags(Stats::nozero)
+    ;
+
+    multicastStagedFlits
+        .name(name() + ".multicast_staged_flits")
+        .flags(Stats::nozero)
+    ;
+
+    multicastAdaptiveRoutes
+        .name(name() + ".multicast_adaptive_routes")
+        .flags(Stats::nozero)
+    ;
+
+    multicastAdaptiveDeviations
+        .name(name() + ".multicast_adaptive_deviations")
+        .flags(Stats::nozero)
+    ;
+
     routerFlitLoad
         .name(name() + ".flit_load")
         .desc("router flit load (flits/cycle)")
         .flags(Stats::nozero)
         ;
+
+    StatsSampler::addLiveScalar(prepushFilterQueries,
+        [this]() { return livePrepushFilterQueries(); });
+    StatsSampler::addLiveScalar(prepushFilterRegistries,
+        [this]() { return livePrepushFilterRegistries(); });
+    StatsSampler::addLiveScalar(prepushFilterActivity,
+        [this]() { return livePrepushFilterActivity(); });
+    StatsSampler::addLiveScalar(acksCombined,
+        [this]() { return liveAcksCombined(); });
+    StatsSampler::addLiveScalar(multicastVcHoldCycles,
+        [this]() { return liveMulticastVcHoldCycles(); });
+    StatsSampler::addLiveScalar(multicastStagedFlits,
+        [this]() { return liveMulticastStagedFlits(); });
+    StatsSampler::addLiveScalar(multicastAdaptiveRoutes,
+        [this]() { return liveMulticastAdaptiveRoutes(); });
+    StatsSampler::addLiveScalar(multicastAdaptiveDeviations,
+        [this]() { return liveMulticastAdaptiveDeviations(); });
 }
 
 void
@@ -261,12 +304,34 @@ Router::collateStats()
         switchAllocator.get_output_arbiter_activity();
     m_crossbar_activity = crossbarSwitch.get_crossbar_activity();
 
-    for (auto prepush_filter: prepushFilters) {
-        prepushFilterQueries += prepush_filter->getPrepushFilterQueries();
-        prepushFilterRegistries +=
-            prepush_filter->getPrepushFilterRegistries();
-    }
-    prepushFilterActivity = switchAllocator.getPrepushFilterActivity();
+    // Copied rather than summed, the counters hold everything since the
+    // last reset, so that two dumps without a reset agree with the samples
+    prepushFilterQueries = livePrepushFilterQueries();
+    prepushFilterRegistries = livePrepushFilterRegistries();
+    prepushFilterActivity = livePrepushFilterActivity();
+    acksCombined = liveAcksCombined();
+    multicastVcHoldCycles = liveMulticastVcHoldCycles();
+    multicastStagedFlits = liveMulticastStagedFlits();
+    multicastAdaptiveRoutes = liveMulticastAdaptiveRoutes();
+    multicastAdaptiveDeviations = liveMulticastAdaptiveDeviations();
+}
+
+double
+Router::livePrepushFilterQueries()
+{
+    double queries = 0;
+    for (auto prepush_filter: prepushFilters)
+        queries += prepush_filter->getPrepushFilterQueries();
+    return queries;
+}
+
+double
+Router::livePrepushFilterRegistries()
+{
+    double registries = 0;
+    for (auto prepush_filter: prepushFilters)
+        registries += prepush_filter->getPrepushFilterRegistries();
+    return registries;
 }
 
 void
@@ -276,8 +341,10 @@ Router::resetStats()
             m_input_unit[i]->resetStats();
     }
 
+    // Clears every counter read by the live*() functions
     crossbarSwitch.resetStats();
     switchAllocator.resetStats();
+    routingUnit.resetStats();
 
     for (auto prepush_filter: prepushFilters) {
         prepush_filter->resetStats();
@@ -100,6 +100,12 @@ class Router : public BasicRouter, public Consumer
         return m_network_ptr->isPrepushFilterButNoDrop();
     }
 
+    inline bool
+    isAckCombiningEnabled()
+    {
+        return m_network_ptr->isAckCombiningEnabled();
+    }
+
     InputUnit*
     getInputUnit(unsigned port)
     {
@@ -157,6 +163,57 @@ class Router : public BasicRouter, public Consumer
     {
         return prepushFilterActivity.value();
     }
+    uint64_t getAcksCombined()
+    {
+        return acksCombined.value();
+    }
+    uint64_t getMulticastVcHoldCycles()
+    {
+        return multicastVcHoldCycles.value();
+    }
+    uint64_t getMulticastStagedFlits()
+    {
+        return multicastStagedFlits.value();
+    }
+    uint64_t getMulticastAdaptiveRoutes()
+    {
+        return multicastAdaptiveRoutes.value();
+    }
+    uint64_t getMulticastAdaptiveDeviations()
+    {
+        return multicastAdaptiveDeviations.value();
+    }
+
+    // Current values of the counters above, which collateStats() only
+    // copies into the statistics at dumps
+    double livePrepushFilterQueries();
+    double livePrepushFilterRegistries();
+    double
+    livePrepushFilterActivity()
+    {
+        return switchAllocator.getPrepushFilterActivity();
+    }
+    double liveAcksCombined() { return switchAllocator.getAcksCombined(); }
+    double
+    liveMulticastVcHoldCycles()
+    {
+        return switchAllocator.getMulticastVcHoldCycles();
+    }
+    double
+    liveMulticastStagedFlits()
+    {
+        return switchAllocator.getMulticastStagedFlits();
+    }
+    double
+    liveMulticastAdaptiveRoutes()
+    {
+        return routingUnit.getMulticastAdaptiveRoutes();
+    }
+    double
+    liveMulticastAdaptiveDeviations()
+    {
+        return routingUnit.getMulticastAdaptiveDeviations();
+    }
 
     // For Fault Model:
     bool get_fault_vector(int temperature, float fault_vector[]) {
@@ -205,6 +262,11 @@ class Router : public BasicRouter, public Consumer
     Stats::Scalar prepushFilterQueries;
     Stats::Scalar prepushFilterRegistries;
     Stats::Scalar prepushFilterActivity;
+    Stats::Scalar acksCombined;
+    Stats::Scalar multicastVcHoldCycles;
+    Stats::Scalar multicastStagedFlits;
+    Stats::Scalar multicastAdaptiveRoutes;
+    Stats::Scalar multicastAdaptiveDeviations;
 
     Stats::Scalar routerFlitLoad;
 };
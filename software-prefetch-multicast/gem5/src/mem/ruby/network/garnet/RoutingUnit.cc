@@ -33,6 +33,7 @@
 #include "base/cast.hh"
 #include "debug/RubyNetwork.hh"
 #include "mem/ruby/network/garnet/InputUnit.hh"
+#include "mem/ruby/network/garnet/OutputUnit.hh"
 #include "mem/ruby/network/garnet/Router.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
@@ -41,6 +42,9 @@ RoutingUnit::RoutingUnit(Router *router)
     m_router = router;
     m_routing_table.clear();
     m_weight_table.clear();
+
+    multicastAdaptiveRoutes = 0;
+    multicastAdaptiveDeviations = 0;
 }
 
 void
@@ -360,6 +364,102 @@ RoutingUnit::outportComputeXYYX(RouteInfo route,
     return outport;
 }
 
+/*
+ * West-first turn model on a mesh: a destination to the west is reached by
+ * going west first, any other destination by any of the outports bringing
+ * the packet closer to it. No route turns into the west, which keeps the
+ * adaptive routes free of cyclic channel dependencies.
+ */
+std::vector<int>
+RoutingUnit::outportsWestFirst(int dest_router)
+{
+    int num_cols = m_router->get_net_ptr()->getNumCols();
+    assert(num_cols > 0);
+
+    int my_id = m_router->get_id();
+    int my_x = my_id % num_cols;
+    int my_y = my_id / num_cols;
+
+    int dest_x = dest_router % num_cols;
+    int dest_y = dest_router / num_cols;
+
+    std::vector<PortDirection> outport_dirns;
+    if (dest_x < my_x) {
+        outport_dirns.push_back("West");
+    } else {
+        if (dest_x > my_x)
+            outport_dirns.push_back("East");
+        if (dest_y > my_y)
+            outport_dirns.push_back("North");
+        else if (dest_y < my_y)
+            outport_dirns.push_back("South");
+    }
+
+    std::vector<int> outports;
+    for (auto outport_dirn: outport_dirns) {
+        auto it = m_outports_dirn2idx.find(outport_dirn);
+        assert(it != m_outports_dirn2idx.end());
+        outports.push_back(it->second);
+    }
+    return outports;
+}
+
+/*
+ * Choose the outport of a multicast destination among its productive ones:
+ * an outport another destination of the packet takes first, so that the
+ * packet is not replicated once more, then the one with the most free
+ * credits in the multicast VCs downstream, then the outport of the routing
+ * algorithm.
+ */
+int
+RoutingUnit::outportComputeAdaptive(const std::vector<int> &candidates,
+                                    int default_outport,
+                                    const std::set<int> &branch_outports,
+                                    int vnet)
+{
+    auto score = [&](int outport) {
+        return std::make_pair(branch_outports.count(outport) > 0,
+                m_router->getOutputUnit(outport)->getFreeCredits(vnet, true));
+    };
+
+    int outport = candidates[0];
+    if (std::find(candidates.begin(), candidates.end(), default_outport) !=
+            candidates.end())
+        outport = default_outport;
+
+    auto best_score = score(outport);
+    for (auto candidate: candidates) {
+        auto candidate_score = score(candidate);
+        if (candidate_score > best_score) {
+            outport = candidate;
+            best_score = candidate_score;
+        }
+    }
+
+    multicastAdaptiveRoutes++;
+    if (outport != default_outport)
+        multicastAdaptiveDeviations++;
+
+    return outport;
+}
+
+// Only the unordered vnets may take different routes to a destination
+bool
+RoutingUnit::isAdaptiveMulticast(int vnet)
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    return net_ptr->getMulticastRouting() == WEST_FIRST_MULTICAST_ &&
+        net_ptr->getCoherenceConstraint() == UNORDERED_ &&
+        !net_ptr->isVNetOrdered(vnet);
+}
+
+void
+RoutingUnit::resetStats()
+{
+    multicastAdaptiveRoutes = 0;
+    multicastAdaptiveDeviations = 0;
+}
+
 std::vector<int>
 RoutingUnit::multicastOutportsCompute(RouteInfo &route, int inport,
         PortDirection inport_dirn, int vnet)
@@ -370,6 +470,9 @@ RoutingUnit::multicastOutportsCompute(RouteInfo &route, int inport,
 
     assert(route.demandOutports.empty());
 
+    const bool adaptive = isAdaptiveMulticast(vnet);
+    std::vector<std::vector<int>> candidates(route.destRouters.size());
+
     for (int i = 0; i < route.destRouters.size(); i++) {
         RouteInfo single_route = route;
 
@@ -379,10 +482,26 @@ RoutingUnit::multicastOutportsCompute(RouteInfo &route, int inport,
         int outport =
             outportCompute(single_route, inport, inport_dirn, vnet);
 
-        unique_outport_set.insert(outport);
+        if (adaptive && route.destRouters[i] != m_router->get_id()) {
+            candidates[i] = outportsWestFirst(route.destRouters[i]);
+            if (candidates[i].size() == 1)
+                outport = candidates[i][0];
+        }
+
+        // the adaptive destinations are routed once all the others are
+        if (candidates[i].size() <= 1)
+            unique_outport_set.insert(outport);
         outports.push_back(outport);
     }
 
+    for (int i = 0; i < route.destRouters.size(); i++) {
+        if (candidates[i].size() > 1) {
+            outports[i] = outportComputeAdaptive(candidates[i], outports[i],
+                                                 unique_outport_set, vnet);
+            unique_outport_set.insert(outports[i]);
+        }
+    }
+
     // Construct new route info
     for (auto outport : unique_outport_set) {
         RouteInfo new_route = route;
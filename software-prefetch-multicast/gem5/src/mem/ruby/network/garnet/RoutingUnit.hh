@@ -82,12 +82,33 @@ class RoutingUnit
                          int inport,
                          PortDirection inport_dirn);
 
+    // Minimal adaptive west-first routing of the multicast destinations
+    std::vector<int> outportsWestFirst(int dest_router);
+    int outportComputeAdaptive(const std::vector<int> &candidates,
+                               int default_outport,
+                               const std::set<int> &branch_outports,
+                               int vnet);
+
+    inline double
+    getMulticastAdaptiveRoutes()
+    {
+        return multicastAdaptiveRoutes;
+    }
+    inline double
+    getMulticastAdaptiveDeviations()
+    {
+        return multicastAdaptiveDeviations;
+    }
+    void resetStats();
+
     // Returns true if vnet is present in the vector
     // of vnets or if the vector supports all vnets.
     bool supportsVnet(int vnet, std::vector<int> sVnets);
 
 
   private:
+    bool isAdaptiveMulticast(int vnet);
+
     Router *m_router;
 
     // Routing Table
@@ -99,6 +120,9 @@ class RoutingUnit
     std::map<int, PortDirection> m_inports_idx2dirn;
     std::map<int, PortDirection> m_outports_idx2dirn;
     std::map<PortDirection, int> m_outports_dirn2idx;
+
+    double multicastAdaptiveRoutes;
+    double multicastAdaptiveDeviations;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_0_ROUTINGUNIT_HH__
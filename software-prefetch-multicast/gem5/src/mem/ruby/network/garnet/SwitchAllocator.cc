@@ -31,6 +31,9 @@
 
 #include "mem/ruby/network/garnet/SwitchAllocator.hh"
 
+#include <map>
+#include <tuple>
+
 #include "debug/GarnetMulticast.hh"
 #include "debug/PrepushFilter.hh"
 #include "debug/RubyNetwork.hh"
@@ -51,6 +54,9 @@ SwitchAllocator::SwitchAllocator(Router *router)
     m_output_arbiter_activity = 0;
 
     prepushFilterActivity = 0;
+    acksCombined = 0;
+    multicastVcHoldCycles = 0;
+    multicastStagedFlits = 0;
 }
 
 void
@@ -119,11 +125,15 @@ SwitchAllocator::wakeup()
         checkPrepushFiltering(); // Check and mark for filtering
     }
 
+    if (m_router->isAckCombiningEnabled())
+        combinePrepushAcks(); // Merge and mark the merged acks for dropping
+
     arbitrate_inports(); // First stage of allocation
     arbitrate_outports(); // Second stage of allocation
     grantSwitch();
 
-    if (m_router->isPrepushFilterEnabled())
+    if (m_router->isPrepushFilterEnabled() ||
+        m_router->isAckCombiningEnabled())
         executePrepushFiltering(); // run prepush filtering
 
     clear_request_vector();
@@ -180,6 +190,58 @@ SwitchAllocator::checkPrepushFiltering()
     }
 }
 
+/*
+ * Combine prepush acks loops through all input VCs at every input port, and
+ * merges the single flit prepush acks waiting for the switch that go to the
+ * same L2 for the same line, such as the acks of the L1s of one prepush
+ * multicast meeting on their way back: the ack count of the first one found
+ * is increased by the ack counts of the others, which are marked to be
+ * dropped like the filtered requests. Acks and nacks are not merged together,
+ * nor are the acks of ordered virtual networks.
+ */
+
+void
+SwitchAllocator::combinePrepushAcks()
+{
+    // (vnet, destination NI, line, message type) -> first ack found
+    std::map<std::tuple<int, NodeID, Addr, int>, flit *> acks;
+
+    for (int inport = 0; inport < m_num_inports; inport++) {
+        auto input_unit = m_router->getInputUnit(inport);
+
+        for (int vc = 0; vc < m_num_vcs; vc++) {
+            if (input_unit->isToBeFiltered(vc) ||
+                !input_unit->need_stage(vc, SA_, curTick()))
+                continue;
+
+            flit *t_flit = input_unit->peekTopFlit(vc);
+            int vnet = get_vnet(vc);
+            if (!t_flit->isPrepushAck() || t_flit->get_type() != HEAD_TAIL_ ||
+                m_router->get_net_ptr()->isVNetOrdered(vnet))
+                continue;
+
+            MsgPtr &msg_ptr = t_flit->get_msg_ptr();
+            auto key = std::make_tuple(vnet, t_flit->get_route().dest_ni,
+                                       t_flit->getAddr(),
+                                       msg_ptr->getMessageTypeNum());
+            auto it = acks.find(key);
+            if (it == acks.end()) {
+                acks.emplace(key, t_flit);
+                continue;
+            }
+
+            it->second->get_msg_ptr()->getAckCount() +=
+                msg_ptr->getAckCount();
+            input_unit->setToBeFiltered(vc);
+            acksCombined++;
+
+            DPRINTF(PrepushFilter, "Router[%d]: SwitchAllocator merged ack "
+                    "flit %s at inport %d vc %d into flit %s\n",
+                    m_router->get_id(), *t_flit, inport, vc, *it->second);
+        }
+    }
+}
+
 /*
  * SA-I (or SA-i) loops through all input VCs at every input port,
  * and selects one in a round robin manner.
@@ -229,6 +291,13 @@ SwitchAllocator::arbitrate_inports()
                         bool make_request =
                             send_allowed(inport, invc, outport, outvc);
 
+                        // a head flit without a free VC at the outport may
+                        // be staged there instead of holding the input VC
+                        if (!make_request && is_head_flit && outvc == -1 &&
+                                canStageReplica(inport, invc, outport)) {
+                            make_request = true;
+                        }
+
                         int held_inport_for_outport =
                             heldSwitchInportForOutports[outport];
 
@@ -390,6 +459,14 @@ SwitchAllocator::arbitrate_outports()
     // Again do round robin arbitration on these requests
     // Independent arbiter at each output port
     for (int outport = 0; outport < m_num_outports; outport++) {
+        // The multicast replicas staged at the outport go first when the
+        // switch is not held, they already released their input VC
+        if (heldSwitchInportForOutports[outport] == -1 &&
+                m_router->getOutputUnit(outport)->sendStagedFlit()) {
+            m_output_arbiter_activity++;
+            continue;
+        }
+
         int inport = m_round_robin_inport[outport];
 
         for (int inport_iter = 0; inport_iter < m_num_inports;
@@ -412,8 +489,15 @@ SwitchAllocator::arbitrate_outports()
                 }
 
                 if (outvc == -1) {
-                    // VC Allocation - select any free VC from outport
-                    outvc = vc_allocate(outport, inport, invc);
+                    if (is_multicast &&
+                            !m_router->getOutputUnit(outport)->has_free_vc(
+                                get_vnet(invc), true)) {
+                        // Staging - no free VC, SA-I checked the room
+                        outvc = allocateStaging(outport, inport, invc);
+                    } else {
+                        // VC Allocation - select any free VC from outport
+                        outvc = vc_allocate(outport, inport, invc);
+                    }
                 }
 
                 assert(grantedSwitchInportForOutports[outport] == -1 &&
@@ -462,6 +546,8 @@ SwitchAllocator::grantSwitch()
 
             if (is_multicast) {
                 t_flit = input_unit->peekMulticastFlit(invc);
+                Tick first_grant = t_flit->markSwitchGrant(curTick());
+                input_unit->markMulticastGrant(invc, curTick());
 
                 // Remove the granted outport in invc's remaining outports for
                 // multicast if it is a head flit; meanwhile, insert the
@@ -506,6 +592,7 @@ SwitchAllocator::grantSwitch()
 
                     t_flit = t_flit->makeReplica();
                 }
+                t_flit->addSwitchDelays(first_grant, curTick());
 
                 t_flit->updateMulticastMetadata(
                         input_unit->getMulticastRouteInfoForOutport(
@@ -523,6 +610,8 @@ SwitchAllocator::grantSwitch()
             } else {
                 // remove flit from Input VC
                 t_flit = input_unit->getTopFlit(invc);
+                t_flit->addSwitchDelays(t_flit->markSwitchGrant(curTick()),
+                                        curTick());
 
                 DPRINTF(RubyNetwork, "Router[%d]: SwitchAllocator granted "
                         "outvc %d at outport %d (%s) to invc %d at inport %d "
@@ -533,10 +622,16 @@ SwitchAllocator::grantSwitch()
                         *t_flit);
             }
 
-            bool drop_flit = m_router->isPrepushFilterEnabled() && (!m_router->isPrepushFilterButNoDrop()) && 
-                input_unit->isToBeFiltered(invc);
+            // Only the filtered requests and the merged acks are marked
+            bool drop_flit = input_unit->isToBeFiltered(invc);
 
-            if (!drop_flit) {
+            if (!drop_flit && outvc == STAGING_VC_) {
+                // The replica crosses the switch into the staging buffer of
+                // the outport, which sends it once it gets a VC
+                t_flit->set_outport(outport);
+                output_unit->stageFlit(t_flit, m_router->clockEdge(Cycles(1)));
+                multicastStagedFlits++;
+            } else if (!drop_flit) {
                 // Update outport field in the flit since this is used by
                 // CrossbarSwitch code to send it out of correct outport.
                 // Note: post route compute in InputUnit, outport is updated
@@ -572,6 +667,9 @@ SwitchAllocator::grantSwitch()
 
                     if (is_multicast) {
                         assert(last_multicast_replica);
+                        multicastVcHoldCycles += m_router->ticksToCycles(
+                                curTick() -
+                                input_unit->getMulticastGrantTime(invc));
                         input_unit->clearMulticastInfo(invc);
                     }
                 }
@@ -666,9 +764,10 @@ SwitchAllocator::grantSwitch()
                         t_flit->getAddr(),
                         *t_flit);
 
-                delete t_flit;
+                if (!t_flit->isPrepushAck())
+                    prepushFilterActivity++;
 
-                prepushFilterActivity++;
+                delete t_flit;
             }
 
             // Indicate the credit channel has been used to send a credit to
@@ -712,7 +811,7 @@ SwitchAllocator::executePrepushFiltering()
                 flit *t_flit = input_unit->getTopFlit(invc);
 
                 assert(t_flit->get_type() == HEAD_TAIL_ &&
-                        t_flit->isReadRequest());
+                        (t_flit->isReadRequest() || t_flit->isPrepushAck()));
 
                 DPRINTF(PrepushFilter, "Router[%d]: PrepushFilter %d (%s): "
                         "(addr %#x) drop flit %s from inport %d vc %d\n",
@@ -721,9 +820,10 @@ SwitchAllocator::executePrepushFiltering()
                         t_flit->getAddr(), *t_flit,
                         inport, invc);
 
-                delete t_flit;
+                if (!t_flit->isPrepushAck())
+                    prepushFilterActivity++;
 
-                prepushFilterActivity++;
+                delete t_flit;
 
                 // It should not have the output vc allocated, otherwise the
                 // switch allocaiton should have been successfull and it is
@@ -750,6 +850,9 @@ SwitchAllocator::executePrepushFiltering()
         }
     }
 
+    if (!m_router->isPrepushFilterEnabled())
+        return;
+
     // clear prepush entries 3 cycles after prepush response are sent out
     for (int inport = 0; inport < m_num_inports; inport++) {
         auto prepush_filter = m_router->getPrepushFilter(inport);
@@ -779,6 +882,10 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
     // Check if credit needed (for multi-flit packet)
     // Check if ordering violated (in ordered vnet)
 
+    // The head flit reserved the room of the packet in the staging buffer
+    if (outvc == STAGING_VC_)
+        return true;
+
     int vnet = get_vnet(invc);
     bool has_outvc = (outvc != -1);
     bool has_credit = false;
@@ -789,7 +896,8 @@ SwitchAllocator::send_allowed(int inport, int invc, int outport, int outvc)
         // needs outvc
         // this is only true for HEAD and HEAD_TAIL flits.
 
-        if (output_unit->has_free_vc(vnet)) {
+        if (output_unit->has_free_vc(vnet,
+                    m_router->getInputUnit(inport)->isMulticast(invc))) {
 
             has_outvc = true;
 
@@ -925,7 +1033,8 @@ SwitchAllocator::vc_allocate(int outport, int inport, int invc)
     // Select a free VC from the output port
     int outvc =
         m_router->getOutputUnit(outport)->select_free_vc(get_vnet(invc),
-                input_unit->peekTopFlit(invc)->getPacketID());
+                input_unit->peekTopFlit(invc)->getPacketID(),
+                input_unit->isMulticast(invc));
 
     // has to get a valid VC since it checked before performing SA
     assert(outvc != -1);
@@ -947,6 +1056,45 @@ SwitchAllocator::vc_allocate(int outport, int inport, int invc)
     return outvc;
 }
 
+/*
+ * A multicast head flit blocked at an outport for lack of a free VC may be
+ * staged there if the outport has room for the whole packet, so that the
+ * branch does not hold the input VC. Staging reorders the packets of a vnet
+ * at the outport, it is only done in the unordered vnets.
+ */
+
+bool
+SwitchAllocator::canStageReplica(int inport, int invc, int outport)
+{
+    GarnetNetwork *net_ptr = m_router->get_net_ptr();
+    if (net_ptr->getCoherenceConstraint() != UNORDERED_ ||
+            net_ptr->isVNetOrdered(get_vnet(invc)))
+        return false;
+
+    flit *t_flit = m_router->getInputUnit(inport)->peekMulticastFlit(invc);
+    return m_router->getOutputUnit(outport)->canStagePacket(
+            t_flit->get_size());
+}
+
+// Reserve the staging buffer of the outport to the winner instead of a VC.
+int
+SwitchAllocator::allocateStaging(int outport, int inport, int invc)
+{
+    auto input_unit = m_router->getInputUnit(inport);
+    flit *t_flit = input_unit->peekMulticastFlit(invc);
+
+    m_router->getOutputUnit(outport)->reserveStaging(t_flit->get_size());
+    input_unit->grantMulticastOutvc(invc, outport, STAGING_VC_);
+
+    DPRINTF(GarnetMulticast, "Router[%d]: VCAllocator: staging Flit: PktID=%d"
+            " Id=%d from VC %d at inport %d (%s) at outport %d (%s)\n",
+            m_router->get_id(), t_flit->getPacketID(), t_flit->get_id(),
+            invc, inport, input_unit->get_direction(), outport,
+            m_router->getOutportDirection(outport));
+
+    return STAGING_VC_;
+}
+
 // Wakeup the router next cycle to perform SA again
 // if there are flits ready.
 void
@@ -958,6 +1106,13 @@ SwitchAllocator::check_for_wakeup()
         return;
     }
 
+    for (int i = 0; i < m_num_outports; i++) {
+        if (m_router->getOutputUnit(i)->hasStagedFlits()) {
+            m_router->schedule_wakeup(Cycles(1));
+            return;
+        }
+    }
+
     for (int i = 0; i < m_num_inports; i++) {
         for (int j = 0; j < m_num_vcs; j++) {
             if (m_router->getInputUnit(i)->need_stage(j, SA_, nextCycle)) {
@@ -995,4 +1150,7 @@ SwitchAllocator::resetStats()
     m_input_arbiter_activity = 0;
     m_output_arbiter_activity = 0;
     prepushFilterActivity = 0;
+    acksCombined = 0;
+    multicastVcHoldCycles = 0;
+    multicastStagedFlits = 0;
 }
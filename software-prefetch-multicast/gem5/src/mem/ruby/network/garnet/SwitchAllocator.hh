@@ -56,7 +56,10 @@ class SwitchAllocator : public Consumer
     void arbitrate_outports();
     bool send_allowed(int inport, int invc, int outport, int outvc);
     int vc_allocate(int outport, int inport, int invc);
+    bool canStageReplica(int inport, int invc, int outport);
+    int allocateStaging(int outport, int inport, int invc);
     void checkPrepushFiltering();
+    void combinePrepushAcks();
     void executePrepushFiltering();
     void grantSwitch();
 
@@ -72,6 +75,9 @@ class SwitchAllocator : public Consumer
     }
 
     inline double getPrepushFilterActivity() { return prepushFilterActivity; }
+    inline double getAcksCombined() { return acksCombined; }
+    inline double getMulticastVcHoldCycles() { return multicastVcHoldCycles; }
+    inline double getMulticastStagedFlits() { return multicastStagedFlits; }
 
     void resetStats();
 
@@ -81,6 +87,9 @@ class SwitchAllocator : public Consumer
 
     double m_input_arbiter_activity, m_output_arbiter_activity;
     double prepushFilterActivity;
+    double acksCombined;
+    double multicastVcHoldCycles;
+    double multicastStagedFlits;
 
     Router *m_router;
     std::vector<int> m_round_robin_invc;
@@ -36,7 +36,8 @@
 VirtualChannel::VirtualChannel()
   : inputBuffer(), m_vc_state(IDLE_, Tick(0)), m_output_port(-1),
     m_enqueue_time(INFINITE_), packetID(0), m_output_vc(-1), multicast(false),
-    multicastNthFlit(0), pktSize(0), toBeFiltered(false)
+    multicastNthFlit(0), multicastGrantTime(MaxTick), pktSize(0),
+    toBeFiltered(false)
 {
 }
 
@@ -136,6 +137,7 @@ VirtualChannel::clearMulticastInfo()
     _outportOutvcMap.clear();
     _outportRouteMap.clear();
     _outportMsgPtrsMap.clear();
+    multicastGrantTime = MaxTick;
 }
 
 void
@@ -145,6 +145,16 @@ class VirtualChannel
 
     inline bool isMulticast() { return multicast; }
 
+    // Time of the first replica sent of the multicast packet
+    inline void
+    markMulticastGrant(Tick time)
+    {
+        if (multicastGrantTime == MaxTick)
+            multicastGrantTime = time;
+    }
+
+    inline Tick getMulticastGrantTime() { return multicastGrantTime; }
+
     inline bool
     isMulticastHeadFlit()
     {
@@ -236,6 +246,7 @@ class VirtualChannel
     std::map<int, RouteInfo> _outportRouteMap;
     std::map<int, std::map<NodeID, MsgPtr>> _outportMsgPtrsMap;
     int multicastNthFlit;
+    Tick multicastGrantTime;
     int pktSize;
     bool toBeFiltered;
 };
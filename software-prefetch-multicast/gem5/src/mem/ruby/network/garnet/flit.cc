@@ -52,11 +52,15 @@ flit::flit(int id, int  vc, int vnet, RouteInfo route, int size,
     m_route = route;
     m_stage.first = I_;
     m_stage.second = curTime;
+    m_contention_delay = 0;
+    m_replica_delay = 0;
+    m_first_grant = 0;
     m_width = bWidth;
     msgSize = MsgSize;
 
     _multicast = false;
     _prepush = false;
+    _prepushAck = false;
     _readRequest = false;
     _addr = 0;
 
@@ -110,6 +114,7 @@ flit::makeReplica()
     fl->set_src_delay(src_delay);
     fl->set_enqueue_time(m_enqueue_time);
     fl->set_dequeue_time(m_dequeue_time);
+    fl->set_switch_delays(m_contention_delay, m_replica_delay);
     fl->advance_stage(m_stage.first, m_stage.second);
     fl->setMsgPtrsMap(_msgPtrsMap);
     assert(_multicast);
@@ -134,6 +139,7 @@ flit::serialize(int ser_id, int parts, uint32_t bWidth)
                     new_size, m_msg_ptr, msgSize, bWidth, m_time);
     fl->set_enqueue_time(m_enqueue_time);
     fl->set_src_delay(src_delay);
+    fl->set_switch_delays(m_contention_delay, m_replica_delay);
     return fl;
 }
 
@@ -149,6 +155,7 @@ flit::deserialize(int des_id, int num_flits, uint32_t bWidth)
                     new_size, m_msg_ptr, msgSize, bWidth, m_time);
     fl->set_enqueue_time(m_enqueue_time);
     fl->set_src_delay(src_delay);
+    fl->set_switch_delays(m_contention_delay, m_replica_delay);
     return fl;
 }
 
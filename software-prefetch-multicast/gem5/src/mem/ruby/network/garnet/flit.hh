@@ -62,10 +62,13 @@ class flit
     flit_type get_type() { return m_type; }
     std::pair<flit_stage, Tick> get_stage() { return m_stage; }
     Tick get_src_delay() { return src_delay; }
+    Tick get_contention_delay() { return m_contention_delay; }
+    Tick get_replica_delay() { return m_replica_delay; }
     inline uint64_t getPacketID() { return packetID; }
     inline bool getMulticast() { return _multicast; }
     inline bool isMulticast() { return _multicast; }
     inline bool isPrepush() { return _prepush; }
+    inline bool isPrepushAck() { return _prepushAck; }
     inline bool getPrepush() { return _prepush; }
     inline bool isReadRequest() { return _readRequest; }
     inline bool getReadRequest() { return _readRequest; }
@@ -83,12 +86,45 @@ class flit
     void set_vc(int vc) { m_vc = vc; }
     void set_route(RouteInfo route) { m_route = route; }
     void set_src_delay(Tick delay) { src_delay = delay; }
+
+    void
+    set_switch_delays(Tick contention, Tick replica)
+    {
+        m_contention_delay = contention;
+        m_replica_delay = replica;
+    }
+
+    /**
+     * Record a switch grant of the flit at the current router, which may
+     * grant a multicast flit once per replica. Returns the tick of the
+     * first grant since the flit became ready for switch allocation.
+     */
+    Tick
+    markSwitchGrant(Tick now)
+    {
+        if (m_first_grant < m_stage.second)
+            m_first_grant = now;
+        return m_first_grant;
+    }
+
+    /**
+     * Account the wait of the flit leaving the router at now: up to the
+     * first grant it lost the switch allocation, after that it waited for
+     * the other replicas of the multicast flit.
+     */
+    void
+    addSwitchDelays(Tick first_grant, Tick now)
+    {
+        m_contention_delay += first_grant - m_stage.second;
+        m_replica_delay += now - first_grant;
+    }
     void set_dequeue_time(Tick time) { m_dequeue_time = time; }
     void set_enqueue_time(Tick time) { m_enqueue_time = time; }
     void setPacketID(uint64_t packet_id) { packetID = packet_id; }
     inline void setMulticast() { _multicast = true; }
     inline void clearMulticast() { _multicast = false; }
     inline void setPrepush(bool prepush) { _prepush = prepush; }
+    inline void setPrepushAck(bool ack) { _prepushAck = ack; }
     inline void setReadRequest(bool read) { _readRequest = read; }
     inline void setAddr(Addr addr) { _addr = addr; }
 
@@ -158,10 +194,14 @@ class flit
     MsgPtr m_msg_ptr;
     int m_outport;
     Tick src_delay;
+    Tick m_contention_delay;
+    Tick m_replica_delay;
+    Tick m_first_grant;
     std::pair<flit_stage, Tick> m_stage;
     std::map<NodeID, MsgPtr> _msgPtrsMap;
     bool _multicast;
     bool _prepush;
+    bool _prepushAck;
     bool _readRequest;
     Addr _addr;
 };
@@ -706,13 +706,8 @@ Profiler::collateSharerAccessIntervalStats(CacheMemory *llc)
     }
 
     for (auto i = 0; i < accesses; i++) {
-        sharerAccessInterval[i].insert(sharerAccessInterval[i].end(),
-                llc->sharerAccessInterval[i].begin(),
-                llc->sharerAccessInterval[i].end());
-
-        sharerRequestInterval[i].insert(sharerRequestInterval[i].end(),
-                llc->sharerRequestInterval[i].begin(),
-                llc->sharerRequestInterval[i].end());
+        sharerAccessInterval[i].add(llc->sharerAccessInterval[i]);
+        sharerRequestInterval[i].add(llc->sharerRequestInterval[i]);
     }
 }
 
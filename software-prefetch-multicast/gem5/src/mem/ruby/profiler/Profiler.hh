@@ -51,7 +51,7 @@
 
 #include "base/callback.hh"
 #include "base/statistics.hh"
-#include "mem/ruby/common/IntVec.hh"
+#include "mem/ruby/common/Histogram.hh"
 #include "mem/ruby/common/MachineID.hh"
 #include "mem/ruby/protocol/AccessType.hh"
 #include "mem/ruby/protocol/PrefetchBit.hh"
@@ -160,8 +160,8 @@ class Profiler
     Stats::Histogram sharerMinAccessIntervalHistogram;
     Stats::Histogram sharerMaxAccessIntervalHistogram;
     Stats::Histogram sharerEndAccessIntervalHistogram;
-    std::vector<IntVec> sharerAccessInterval;
-    std::vector<IntVec> sharerRequestInterval;
+    std::vector<Histogram> sharerAccessInterval;
+    std::vector<Histogram> sharerRequestInterval;
 
     // LLC coalescing stats
     Stats::Histogram coalescingHistogram;
@@ -40,6 +40,9 @@
 
 #include "mem/ruby/slicc_interface/AbstractCacheEntry.hh"
 
+#include <algorithm>
+#include <limits>
+
 #include "base/trace.hh"
 #include "debug/RubyCache.hh"
 #include "debug/RubyCacheProfile.hh"
@@ -61,6 +64,9 @@ AbstractCacheEntry::AbstractCacheEntry() : ReplaceableEntry()
     touched = false;
     prepush_entry_llc = false;
     select_victim_sent = false;
+
+    numSharerSlots = 0;
+    clearSharers();
 }
 
 AbstractCacheEntry::~AbstractCacheEntry()
@@ -134,7 +140,38 @@ void
 AbstractCacheEntry::profileCacheEntry(Cycles request_cycle, Cycles
         access_cycle, Addr pc, MachineID mid, int num_llcs)
 {
-    sharerRequestTime.push_back(request_cycle);
-    sharerAccessTime.push_back(access_cycle);
-    sharerNodeID.push_back(mid.getNum());
+    // Allocate the sharer buffers once, a line cannot have more distinct
+    // sharers than there are requestors of that type
+    if (sharerAccessTime.empty()) {
+        uint32_t slots = MachineType_base_count(mid.getType());
+        sharerRequestTime.resize(slots);
+        sharerAccessTime.resize(slots);
+        sharerNodeID.resize(slots);
+    }
+
+    if (numSharerAccesses > 0) {
+        uint32_t interval = access_cycle - sharerLastAccessTime;
+        sharerMinAccessInterval = std::min(sharerMinAccessInterval, interval);
+        sharerMaxAccessInterval = std::max(sharerMaxAccessInterval, interval);
+    } else {
+        sharerFirstAccessTime = access_cycle;
+    }
+    sharerLastAccessTime = access_cycle;
+
+    if (numSharerSlots < sharerAccessTime.size()) {
+        sharerRequestTime[numSharerSlots] = request_cycle;
+        sharerAccessTime[numSharerSlots] = access_cycle;
+        sharerNodeID[numSharerSlots] = mid.getNum();
+        numSharerSlots++;
+    }
+    numSharerAccesses++;
+}
+
+void
+AbstractCacheEntry::clearSharers()
+{
+    numSharerSlots = 0;
+    numSharerAccesses = 0;
+    sharerMinAccessInterval = std::numeric_limits<uint32_t>::max();
+    sharerMaxAccessInterval = 0;
 }
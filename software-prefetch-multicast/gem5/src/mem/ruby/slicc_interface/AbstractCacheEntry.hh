@@ -172,13 +172,22 @@ class AbstractCacheEntry : public ReplaceableEntry
     bool getInHtmWriteSet() const;
     virtual void invalidateEntry() {}
 
-    // sharers access time (cycle)
+    // sharers access time (cycle) of the first numSharerSlots accesses,
+    // the buffers are sized once to the number of requestors; min, max and
+    // end access intervals are streamed over all numSharerAccesses
     std::vector<Cycles> sharerRequestTime;
     std::vector<Cycles> sharerAccessTime;
     std::vector<NodeID> sharerNodeID;
+    uint32_t numSharerSlots;
+    uint32_t numSharerAccesses;
+    uint32_t sharerMinAccessInterval;
+    uint32_t sharerMaxAccessInterval;
+    Cycles sharerFirstAccessTime;
+    Cycles sharerLastAccessTime;
     // profiling methods
     void profileCacheEntry(Cycles request_cycle, Cycles access_cycle, Addr pc,
             MachineID mid, int num_llcs = 0);
+    void clearSharers();
 
   private:
     // hardware transactional memory
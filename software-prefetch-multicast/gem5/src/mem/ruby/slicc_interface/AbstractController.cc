@@ -40,6 +40,8 @@
 
 #include "mem/ruby/slicc_interface/AbstractController.hh"
 
+#include <algorithm>
+
 #include "debug/RubyCharact.hh"
 #include "debug/RubyQueue.hh"
 #include "mem/ruby/network/Network.hh"
@@ -81,10 +83,27 @@ AbstractController::AbstractController(const Params &p)
     }
 
     windowCycles = p.windowCycles;
-    minSharerUpdateCycle = Cycles(0);
     profileLLCSharers = p.profileLLCSharers;
 
     alwaysPrepush = p.alwaysPrepush;
+
+    shadowTimeoutDivision = p.shadow_timeout_division;
+    for (auto threshold : p.shadow_timeout_thresholds) {
+        std::unique_ptr<ShadowTimeout> shadow(new ShadowTimeout());
+        shadow->adaptive = false;
+        shadow->threshold = threshold;
+        shadow->adaptive_threshold = 0;
+        shadowTimeouts.push_back(std::move(shadow));
+    }
+    for (auto upper_bound : p.shadow_adaptive_upper_bounds) {
+        std::unique_ptr<ShadowTimeout> shadow(new ShadowTimeout());
+        shadow->adaptive = true;
+        shadow->threshold = upper_bound;
+        shadow->adaptive_threshold = 0;
+        shadowTimeouts.push_back(std::move(shadow));
+    }
+
+    pcTimeouts.resize(p.pc_timeout_entries, PCTimeout{0, 0});
 }
 
 void
@@ -197,6 +216,240 @@ AbstractController::regStats()
         .name(name() + ".coalescing_histogram")
         .flags(Stats::pdf | Stats::nozero | Stats::oneline)
         ;
+
+    // Shadow timeout evaluators
+    for (auto &shadow : shadowTimeouts) {
+        std::string prefix = csprintf("%s.shadow_timeout.%s_%d", name(),
+            shadow->adaptive ? "adaptive" : "fixed", shadow->threshold);
+        shadow->timeouts
+            .name(prefix + ".timeouts")
+            .desc("Waitlist entries that would have timed out")
+            ;
+        shadow->hostSwitches
+            .name(prefix + ".host_switches")
+            .desc("Host switches that would have released the waitlist")
+            ;
+        shadow->waitCycles
+            .name(prefix + ".wait_cycles")
+            .desc("Cycles that would have been spent in the waitlist")
+            ;
+        shadow->resolved
+            .name(prefix + ".resolved")
+            .desc("Waitlist entries resolved")
+            ;
+        shadow->censored
+            .name(prefix + ".censored")
+            .desc("Entries cut by the real timeout before this threshold")
+            ;
+    }
+
+    // Per PC timeout predictor
+    if (!pcTimeouts.empty()) {
+        pcTimeoutArrivals
+            .name(name() + ".pc_timeout.arrivals")
+            .desc("Multicasts arrived before the deadline of the entry")
+            ;
+        pcTimeoutPremature
+            .name(name() + ".pc_timeout.premature")
+            .desc("Timeouts followed by the multicast of the host")
+            ;
+        pcTimeoutLate
+            .name(name() + ".pc_timeout.late")
+            .desc("Timeouts the multicast of the host never covered")
+            ;
+        pcTimeoutLateCycles
+            .name(name() + ".pc_timeout.late_cycles")
+            .desc("Cycles waited by the entries of the late timeouts")
+            ;
+    }
+}
+
+int
+AbstractController::shadow_threshold(const ShadowTimeout *shadow) const
+{
+    // Divided like the real threshold is in check_timeout
+    int threshold =
+        shadow->adaptive ? shadow->adaptive_threshold : shadow->threshold;
+    if (shadowTimeoutDivision > 0)
+        return threshold / shadowTimeoutDivision;
+    return threshold * shadowTimeoutDivision;
+}
+
+void
+AbstractController::shadow_waitlist_register(Addr addr, Cycles register_cycle)
+{
+    // Same as the real waitlist, a second request for a registered line
+    // keeps the first register cycle
+    for (auto &shadow : shadowTimeouts) {
+        shadow->waitlist.emplace(addr, register_cycle);
+    }
+}
+
+void
+AbstractController::shadow_waitlist_resolve(Addr addr, bool host_switch)
+{
+    // Data or a host switch releases the entry at the current cycle, the
+    // shadow policy would have given up earlier if its threshold elapsed
+    // (the real check fires once register + threshold < now)
+    for (auto &shadow : shadowTimeouts) {
+        auto it = shadow->waitlist.find(addr);
+        if (it == shadow->waitlist.end())
+            continue;
+        Cycles waited = curCycle() - it->second;
+        int threshold = shadow_threshold(shadow.get());
+        if (waited > Cycles(threshold)) {
+            shadow->timeouts++;
+            shadow->waitCycles += threshold;
+        } else {
+            if (host_switch)
+                shadow->hostSwitches++;
+            shadow->waitCycles += uint64_t(waited);
+        }
+        shadow->resolved++;
+        shadow->waitlist.erase(it);
+    }
+}
+
+void
+AbstractController::shadow_waitlist_real_timeout(Addr addr)
+{
+    // The real policy stops waiting here and demands the line, so what a
+    // longer threshold would have seen next is unknown: count it as
+    // censored with the cycles waited so far as a lower bound
+    for (auto &shadow : shadowTimeouts) {
+        auto it = shadow->waitlist.find(addr);
+        if (it == shadow->waitlist.end())
+            continue;
+        Cycles waited = curCycle() - it->second;
+        int threshold = shadow_threshold(shadow.get());
+        if (waited > Cycles(threshold)) {
+            shadow->timeouts++;
+            shadow->waitCycles += threshold;
+        } else {
+            shadow->censored++;
+            shadow->waitCycles += uint64_t(waited);
+        }
+        shadow->resolved++;
+        shadow->waitlist.erase(it);
+    }
+}
+
+void
+AbstractController::shadow_update_adaptive_timeout_threshold(int ticks_used)
+{
+    // Same running average as update_adaptive_timeout_threshold, capped by
+    // the upper bound of each shadow
+    for (auto &shadow : shadowTimeouts) {
+        if (!shadow->adaptive)
+            continue;
+        if (shadow->adaptive_threshold == 0) {
+            shadow->adaptive_threshold = ticks_used / 500;
+        } else {
+            shadow->adaptive_threshold =
+                (shadow->adaptive_threshold + (ticks_used / 500)) / 2;
+        }
+        if (shadow->adaptive_threshold > shadow->threshold) {
+            shadow->adaptive_threshold = shadow->threshold;
+        }
+    }
+}
+
+AbstractController::PCTimeout &
+AbstractController::pc_timeout_entry(Addr pc)
+{
+    return pcTimeouts[pc % pcTimeouts.size()];
+}
+
+Cycles
+AbstractController::pc_timeout_predict(Addr pc, Cycles timeout_threshold)
+{
+    if (pcTimeouts.empty())
+        return timeout_threshold;
+
+    // A PC not seen yet waits the configured threshold, a learned one half
+    // as long again as its average delay, within 1/8 to 4 times the
+    // configured threshold
+    const PCTimeout &entry = pc_timeout_entry(pc);
+    if (entry.pc != pc || entry.delay == 0)
+        return timeout_threshold;
+    int timeout = entry.delay + entry.delay / 2;
+    timeout = std::max(timeout, int(timeout_threshold) / 8);
+    timeout = std::min(timeout, int(timeout_threshold) * 4);
+    return Cycles(timeout);
+}
+
+void
+AbstractController::pc_timeout_train(Addr pc, int delay)
+{
+    PCTimeout &entry = pc_timeout_entry(pc);
+    if (entry.pc != pc || entry.delay == 0) {
+        entry.pc = pc;
+        entry.delay = std::max(delay, 1);
+    } else {
+        entry.delay = std::max((3 * entry.delay + delay) / 4, 1);
+    }
+}
+
+void
+AbstractController::pc_timeout_expired(int id)
+{
+    if (pcTimeouts.empty())
+        return;
+
+    // Resolved by the data the timeout request brings back, or by the
+    // multicast of the host if it was on its way. A line whose data never
+    // comes back is not kept forever: the table holds as many lines as
+    // the PC table, the oldest one is dropped to make room
+    if ((pcTimedOut.size() >= pcTimeouts.size()) &&
+        (pcTimedOut.count(waitlist_addr[id]) == 0)) {
+        auto oldest = pcTimedOut.begin();
+        for (auto it = pcTimedOut.begin(); it != pcTimedOut.end(); it++) {
+            if (it->second.register_cycle < oldest->second.register_cycle)
+                oldest = it;
+        }
+        pcTimedOut.erase(oldest);
+    }
+    pcTimedOut[waitlist_addr[id]] = PCTimeoutWait{waitlist_pc[id],
+        waitlist_register_cycle[id], waitlist_timeout[id]};
+}
+
+void
+AbstractController::pc_timeout_resolve(Addr addr, bool pushed)
+{
+    if (pcTimeouts.empty())
+        return;
+
+    for (int i = 0; i < num_of_listid; i++) {
+        if ((waitlist_addr[i] == addr) && waitlist_valid[i]) {
+            if (pushed) {
+                pcTimeoutArrivals++;
+                pc_timeout_train(waitlist_pc[i],
+                                 curCycle() - waitlist_register_cycle[i]);
+            }
+            return;
+        }
+    }
+
+    auto it = pcTimedOut.find(addr);
+    if (it == pcTimedOut.end())
+        return;
+    const PCTimeoutWait &wait = it->second;
+    if (pushed) {
+        // The duplicate request and multicast could have been avoided
+        pcTimeoutPremature++;
+        pc_timeout_train(wait.pc, curCycle() - wait.register_cycle);
+    } else {
+        // The host never pushed the line, the whole wait was spent for
+        // nothing: wait less next time
+        pcTimeoutLate++;
+        pcTimeoutLateCycles += uint64_t(wait.timeout);
+        PCTimeout &entry = pc_timeout_entry(wait.pc);
+        if (entry.pc == wait.pc && entry.delay > 0)
+            entry.delay = std::max(entry.delay / 2, 1);
+        else
+            pc_timeout_train(wait.pc, wait.timeout / 2);
+    }
+    pcTimedOut.erase(it);
 }
 
 bool
@@ -229,68 +482,27 @@ AbstractController::profileSharerHistogram(const Addr addr)
 {
     Cycles cur_cycle = curCycle();
 
-    // Prune the map for memory
-    if (cur_cycle - minSharerUpdateCycle > windowCycles) {
+    // Sample and prune the lines whose window has ended
+    while (!addrCycleQueue.empty() &&
+           cur_cycle - addrCycleQueue.front().second > windowCycles) {
+        Addr check_addr = addrCycleQueue.front().first;
+        auto it = addrSharersMap.find(check_addr);
+        assert(it != addrSharersMap.end());
         DPRINTF(RubyCharact,
-                "Prune sharer map BEGIN at %lld, min cycle: %lld, size: %d\n",
-                cur_cycle, minSharerUpdateCycle,
-                addrSharersMap.size());
-
-        std::list<Addr> pruned_addr_list;
-        for (auto it: addrCycleMap) {
-            if (cur_cycle - it.second > windowCycles) {
-                pruned_addr_list.push_back(it.first);
-            }
-        }
-
-        if (!pruned_addr_list.empty()) {
-            for (auto it: pruned_addr_list) {
-                Addr check_addr = it;
-                int num_sharers = addrSharersMap[check_addr];
-                DPRINTF(RubyCharact,
-                        " Addr %#x (added @ cycle %lld, %d sharers) pruned\n",
-                        check_addr, addrCycleMap[check_addr], num_sharers);
-                sharerHistogram.sample(num_sharers);
-                addrCycleMap.erase(check_addr);
-                addrSharersMap.erase(check_addr);
-            }
-        } else {
-            DPRINTF(RubyCharact, "   No pruning\n");
-        }
-
-        // Update minSharerUpdateCycle
-        auto min_it = min_element(addrCycleMap.begin(),
-                addrCycleMap.end(),
-                [](decltype(addrCycleMap)::value_type& l,
-                    decltype(addrCycleMap)::value_type& r)
-                -> bool {return l.second < r.second;});
-
-        if (min_it != addrCycleMap.end()) {
-            minSharerUpdateCycle = min_it->second;
-        } else {
-            minSharerUpdateCycle = cur_cycle;
-        }
-        DPRINTF(RubyCharact,
-                "Prune sharer map END, min cycle: %lld, size: %d\n",
-                minSharerUpdateCycle, addrSharersMap.size());
+                " Addr %#x (added @ cycle %lld, %d sharers) pruned\n",
+                check_addr, addrCycleQueue.front().second, it->second);
+        sharerHistogram.sample(it->second);
+        addrSharersMap.erase(it);
+        addrCycleQueue.pop_front();
     }
 
     // Update the sharer info
-    if (addrCycleMap.count(addr) == 0) {
-        assert(addrSharersMap.count(addr) == 0);
-        addrCycleMap[addr] = cur_cycle;
-        addrSharersMap[addr] = 1;
+    auto it = addrSharersMap.find(addr);
+    if (it == addrSharersMap.end()) {
+        addrSharersMap.emplace(addr, 1);
+        addrCycleQueue.emplace_back(addr, cur_cycle);
     } else {
-        assert(addrSharersMap.count(addr) != 0);
-
-        if (cur_cycle - addrCycleMap[addr] <= windowCycles) {
-            addrSharersMap[addr] += 1;
-        } else {
-            int num_sharers = addrSharersMap[addr];
-            sharerHistogram.sample(num_sharers);
-            addrSharersMap[addr] = 1;
-            addrCycleMap[addr] = cur_cycle;
-        }
+        it->second += 1;
     }
 }
 
@@ -483,6 +695,12 @@ AbstractController::serviceMemoryQueue()
 
     RequestPtr req
         = std::make_shared<Request>(mem_msg->m_addr, req_size, 0, m_id);
+    // The memory controller tells the prepush streams by their group
+    if (mem_msg->m_PrepushGroup >= 0) {
+        req->setFlags(Request::PREFETCH);
+        req->setStreamId(mem_msg->m_PrepushGroup);
+        req->setSubstreamId(mem_msg->m_PrepushSeq);
+    }
     PacketPtr pkt;
     if (mem_msg->getType() == MemoryRequestType_MEMORY_WB) {
         pkt = Packet::createWrite(req);
@@ -588,6 +806,12 @@ AbstractController::recvTimingResp(PacketPtr pkt)
     (*msg).m_OriginalRequestorMachId = s->id;
     delete s;
 
+    // Tag the responses to the reads ahead of the prepush streams too
+    if (pkt->req->hasStreamId()) {
+        (*msg).m_PrepushGroup = pkt->req->streamId();
+        (*msg).m_PrepushSeq = pkt->req->substreamId();
+    }
+
     if (pkt->isRead()) {
         (*msg).m_Type = MemoryRequestType_MEMORY_READ;
         (*msg).m_MessageSize = MessageSizeType_Response_Data;
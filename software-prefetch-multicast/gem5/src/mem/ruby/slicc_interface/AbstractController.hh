@@ -41,8 +41,10 @@
 #ifndef __MEM_RUBY_SLICC_INTERFACE_ABSTRACTCONTROLLER_HH__
 #define __MEM_RUBY_SLICC_INTERFACE_ABSTRACTCONTROLLER_HH__
 
+#include <deque>
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -421,12 +423,13 @@ class AbstractController : public ClockedObject, public Consumer
     std::vector<Stats::Histogram *> m_delayVCHistogram;
 
     // For profiling sharers
-    typedef std::unordered_map<Addr, Cycles> AddrCycleMapType;
+    // Sharers of the lines in their time window, the window start cycles
+    // are queued in order so that expired lines are pruned from the front
     typedef std::unordered_map<Addr, int> AddrSharersMapType;
-    AddrCycleMapType   addrCycleMap;
+    typedef std::deque<std::pair<Addr, Cycles>> AddrCycleQueueType;
     AddrSharersMapType addrSharersMap;
+    AddrCycleQueueType addrCycleQueue;
     int windowCycles;
-    Cycles minSharerUpdateCycle;
     // Histogram for number of sharers during a time window
     Stats::Histogram sharerHistogram;
 
@@ -598,6 +601,7 @@ class AbstractController : public ClockedObject, public Consumer
   }
 
   virtual void waitlist_register(Addr addr, Addr vaddr, RubyAccessMode AccessMode, PrefetchBit Prefetch, Addr pc, Cycles register_cycle, Cycles timeout_threshold) {
+    shadow_waitlist_register(addr, register_cycle);
     bool have_entry = false;
     if (num_of_listid > 0) {
       for (int i = 0; i < num_of_listid; i++) {
@@ -606,36 +610,57 @@ class AbstractController : public ClockedObject, public Consumer
         }
       }
       if (!have_entry) {
-        waitlist_addr[num_of_listid] = addr;
-        waitlist_vaddr[num_of_listid] = vaddr;
-        waitlist_AccessMode[num_of_listid] = AccessMode;
-        waitlist_Prefetch[num_of_listid] = Prefetch;
-        waitlist_pc[num_of_listid] = pc;
-        waitlist_register_cycle[num_of_listid] = register_cycle;
-        waitlist_valid[num_of_listid] = true;
+        // The entries are kept in deadline order, check_timeout looking at
+        // the first one: with one threshold for all, this is their order
+        Cycles timeout = pc_timeout_predict(pc, timeout_threshold);
+        int find_waitlist_id = num_of_listid;
+        while ((find_waitlist_id > 0) && (waitlist_register_cycle[find_waitlist_id - 1] + waitlist_timeout[find_waitlist_id - 1] > register_cycle + timeout)) {
+          int i = find_waitlist_id;
+          waitlist_addr[i] = waitlist_addr[i-1];
+          waitlist_vaddr[i] = waitlist_vaddr[i-1];
+          waitlist_AccessMode[i] = waitlist_AccessMode[i-1];
+          waitlist_Prefetch[i] = waitlist_Prefetch[i-1];
+          waitlist_pc[i] = waitlist_pc[i-1];
+          waitlist_register_cycle[i] = waitlist_register_cycle[i-1];
+          waitlist_timeout[i] = waitlist_timeout[i-1];
+          waitlist_valid[i] = waitlist_valid[i-1];
+          switch_host_valid[i] = switch_host_valid[i-1];
+          find_waitlist_id -= 1;
+        }
+        waitlist_addr[find_waitlist_id] = addr;
+        waitlist_vaddr[find_waitlist_id] = vaddr;
+        waitlist_AccessMode[find_waitlist_id] = AccessMode;
+        waitlist_Prefetch[find_waitlist_id] = Prefetch;
+        waitlist_pc[find_waitlist_id] = pc;
+        waitlist_register_cycle[find_waitlist_id] = register_cycle;
+        waitlist_timeout[find_waitlist_id] = timeout;
+        waitlist_valid[find_waitlist_id] = true;
         waitlist_valid[num_of_listid + 1] = false;
-        switch_host_valid[num_of_listid] = false;
+        switch_host_valid[find_waitlist_id] = false;
         switch_host_valid[num_of_listid + 1] = false;
         num_of_listid += 1;
-        scheduleEvent(Cycles(timeout_threshold + 2));
+        scheduleEvent(Cycles(timeout + 2));
       }
     } else if (num_of_listid == 0) {
+      Cycles timeout = pc_timeout_predict(pc, timeout_threshold);
       waitlist_addr[0] = addr;
       waitlist_vaddr[0] = vaddr;
       waitlist_AccessMode[0] = AccessMode;
       waitlist_Prefetch[0] = Prefetch;
       waitlist_pc[0] = pc;
       waitlist_register_cycle[0] = register_cycle;
+      waitlist_timeout[0] = timeout;
       waitlist_valid[0] = true;
       waitlist_valid[1] = false;
       switch_host_valid[0] = false;
       switch_host_valid[1] = false;
       num_of_listid += 1;
-      scheduleEvent(Cycles(timeout_threshold + 2));
+      scheduleEvent(Cycles(timeout + 2));
     }
   }
 
   virtual void waitlist_deregister(Addr addr) {
+    shadow_waitlist_resolve(addr, false);
     if (num_of_listid > 0) {
       bool have_entry = false;
       int find_waitlist_id = 0;
@@ -654,6 +679,7 @@ class AbstractController : public ClockedObject, public Consumer
           waitlist_Prefetch[i] = waitlist_Prefetch[i+1];
           waitlist_pc[i] = waitlist_pc[i+1];
           waitlist_register_cycle[i] = waitlist_register_cycle[i+1];
+          waitlist_timeout[i] = waitlist_timeout[i+1];
           waitlist_valid[i] = waitlist_valid[i+1];
           switch_host_valid[i] = switch_host_valid[i+1];
         }
@@ -676,7 +702,10 @@ class AbstractController : public ClockedObject, public Consumer
 
   virtual bool check_timeout(Cycles curtick, Cycles timeout_threshold, int division, int id) {
     bool timeout = false;
-    if (division > 0) {
+    if (!pcTimeouts.empty()) {
+      // The per PC deadline replaces the fixed or adaptive threshold
+      timeout = ((((waitlist_register_cycle[0] + waitlist_timeout[0]) < curtick) && waitlist_valid[0]) && (curtick > last_check_tick) && (num_of_listid > 0));
+    } else if (division > 0) {
       timeout = ((((waitlist_register_cycle[0] + (timeout_threshold / division)) < curtick) && waitlist_valid[0]) && (curtick > last_check_tick) && (num_of_listid > 0));
     } else {
       timeout = ((((waitlist_register_cycle[0] + (timeout_threshold * division)) < curtick) && waitlist_valid[0]) && (curtick > last_check_tick) && (num_of_listid > 0));
@@ -715,6 +744,7 @@ class AbstractController : public ClockedObject, public Consumer
       // warn("%lld: %s: Check waitlist match!!: mapped_dest = %s; m_id = %s!!\n", curTick(), name(), mapped_dest, m_id);
       if ((mapped_dest == m_id) && (waitlist_valid[i])) {
         switch_host_valid[i] = true;
+        shadow_waitlist_resolve(waitlist_addr[i], true);
         // warn("%lld: %s: Set waitlist True!!: addr = %s; pc = %s; register time = %s!!\n", curTick(), name(), waitlist_addr[i], waitlist_pc[i], waitlist_register_cycle[i]);
         scheduleEvent(Cycles(1));
         scheduleEvent(Cycles(2));
@@ -800,6 +830,7 @@ class AbstractController : public ClockedObject, public Consumer
           waitlist_Prefetch[i] = waitlist_Prefetch[i+1];
           waitlist_pc[i] = waitlist_pc[i+1];
           waitlist_register_cycle[i] = waitlist_register_cycle[i+1];
+          waitlist_timeout[i] = waitlist_timeout[i+1];
           waitlist_valid[i] = waitlist_valid[i+1];
           switch_host_valid[i] = switch_host_valid[i+1];
         }
@@ -814,6 +845,8 @@ class AbstractController : public ClockedObject, public Consumer
   virtual void pop_waitlist(Addr addr) {
     if (num_of_listid > 0) {
       assert((waitlist_addr[0] == addr) && waitlist_valid[0]);
+      shadow_waitlist_real_timeout(addr);
+      pc_timeout_expired(0);
       // warn("%lld: %s: addr = %s, Deregister wait list at 0!\n", curTick(), name(), waitlist_addr[0]);
       for(int i = 0; i < num_of_listid - 1; i++) {
         waitlist_addr[i] = waitlist_addr[i+1];
@@ -822,6 +855,7 @@ class AbstractController : public ClockedObject, public Consumer
         waitlist_Prefetch[i] = waitlist_Prefetch[i+1];
         waitlist_pc[i] = waitlist_pc[i+1];
         waitlist_register_cycle[i] = waitlist_register_cycle[i+1];
+        waitlist_timeout[i] = waitlist_timeout[i+1];
         waitlist_valid[i] = waitlist_valid[i+1];
         switch_host_valid[i] = switch_host_valid[i+1];
       }
@@ -841,12 +875,30 @@ class AbstractController : public ClockedObject, public Consumer
     if (adaptive_timeout_threshold > upper_bound) {
       adaptive_timeout_threshold = upper_bound;
     }
+    shadow_update_adaptive_timeout_threshold(ticks_used);
   }
 
   virtual int get_adaptive_timeout_threshold() {
     return adaptive_timeout_threshold;
   }
 
+  // Data for a line registered in the waitlist or timed out, pushed when
+  // it is the multicast of another core
+  void pc_timeout_resolve(Addr addr, bool pushed);
+
+  // The lines of the last range prepush request of the pc, so that its
+  // prefetcht1 of the next lines are not requested again
+  virtual void set_prepush_range(Addr addr, Addr pc, int lines) {
+    prepush_ranges[pc] = std::make_pair(makeLineAddress(addr),
+                                        makeNextStrideAddress(addr, lines));
+  }
+
+  virtual bool in_prepush_range(Addr addr, Addr pc) {
+    auto it = prepush_ranges.find(pc);
+    return (it != prepush_ranges.end()) && (addr >= it->second.first) &&
+           (addr < it->second.second);
+  }
+
   virtual int return_num_group(MachineID m_id, int numofcores, int numofgroups) {
     return (m_id.getNum() / (numofcores / numofgroups)); 
   }
@@ -872,10 +924,59 @@ private:
   std::unordered_map<int, PrefetchBit> waitlist_Prefetch;       //the host to the corresponding share group id
   std::unordered_map<int, Addr> waitlist_pc;                    //the guest list to the corresponding share group id
   std::unordered_map<int, Cycles> waitlist_register_cycle;         //the request need for the configuration
+  std::unordered_map<int, Cycles> waitlist_timeout;             //cycles the entry waits before its timeout
   std::unordered_map<int, bool> switch_host_valid;              //deregister entry and send prepush request since host switch
   int num_of_listid;                                            //number of the waiting request
   Cycles last_check_tick;                                          //set to avoid checking again in the same tick.
   int adaptive_timeout_threshold;                               //Timeout threshold for current network
+  std::unordered_map<Addr, std::pair<Addr, Addr>> prepush_ranges; //pc -> lines of its last range request
+
+  // Shadow timeout evaluators: other timeout policies replayed on the same
+  // waitlist events as the real one, they only count what would have
+  // happened and never change the protocol behavior.
+  struct ShadowTimeout {
+    bool adaptive;                                              //adaptive or fixed threshold
+    int threshold;                                              //fixed threshold or adaptive upper bound (cycles)
+    int adaptive_threshold;                                     //own running average when adaptive
+    std::unordered_map<Addr, Cycles> waitlist;                  //addr -> register cycle
+    Stats::Scalar timeouts;                                     //waits longer than the threshold
+    Stats::Scalar hostSwitches;                                 //host switches seen before the timeout
+    Stats::Scalar waitCycles;                                   //cycles spent in the waitlist
+    Stats::Scalar resolved;                                     //waitlist entries resolved
+    Stats::Scalar censored;                                     //cut by the real timeout before this one
+  };
+  std::vector<std::unique_ptr<ShadowTimeout>> shadowTimeouts;
+  int shadowTimeoutDivision;                                    //en_adaptive_timeout_division of the L1
+
+  int shadow_threshold(const ShadowTimeout *shadow) const;
+  void shadow_waitlist_register(Addr addr, Cycles register_cycle);
+  void shadow_waitlist_resolve(Addr addr, bool host_switch);
+  void shadow_waitlist_real_timeout(Addr addr);
+  void shadow_update_adaptive_timeout_threshold(int ticks_used);
+
+  // Per PC timeout predictor: the delay between the registration of a
+  // guest in the waitlist and the multicast of its host, learned per
+  // prefetch PC, sets the deadline of every waitlist entry
+  struct PCTimeout {
+    Addr pc;                                                    //tag, the entry is invalid when delay is 0
+    int delay;                                                  //running average of the multicast delay (cycles)
+  };
+  struct PCTimeoutWait {
+    Addr pc;
+    Cycles register_cycle;
+    Cycles timeout;
+  };
+  std::vector<PCTimeout> pcTimeouts;                            //direct mapped by pc, empty when disabled
+  std::unordered_map<Addr, PCTimeoutWait> pcTimedOut;           //timed out lines waiting for their data, at most pcTimeouts.size()
+  Stats::Scalar pcTimeoutArrivals;                              //multicasts arrived before the deadline
+  Stats::Scalar pcTimeoutPremature;                             //timeouts followed by the multicast of the host
+  Stats::Scalar pcTimeoutLate;                                  //timeouts the host never covered
+  Stats::Scalar pcTimeoutLateCycles;                            //cycles waited by the late timeouts
+
+  PCTimeout &pc_timeout_entry(Addr pc);
+  Cycles pc_timeout_predict(Addr pc, Cycles timeout_threshold);
+  void pc_timeout_train(Addr pc, int delay);
+  void pc_timeout_expired(int id);
 //End adding for Software Prepush (Private Cache)
 
 //Start adding for Software Prepush (LLCs)
@@ -955,6 +1056,28 @@ public:
     }
   }
 
+  // Register a share group learned by the LLC, without configuration
+  // requests, under the share id of one of its members
+  virtual void set_share_group(int s_id, MachineID host, const NetDest &guests, int distance, int centerlevel, Cycles current_cycle) {
+    int find_shareid = num_of_shareid;
+    for (int i = 0; i < num_of_shareid; i++) {
+      if (share_id[i] == s_id) {
+        find_shareid = i;
+      }
+    }
+    if (find_shareid == num_of_shareid) {
+      share_id[num_of_shareid] = s_id;
+      num_of_shareid += 1;
+    }
+    hostlist[find_shareid] = host;
+    guestlist[find_shareid] = guests;
+    incoming_req[find_shareid] = 0;
+    min_distance[find_shareid] = distance;
+    max_center_level[find_shareid] = centerlevel;
+    num_of_timeout[find_shareid] = 0;
+    last_host_set_cycle[find_shareid] = current_cycle;
+  }
+
   virtual MachineID &config_ack_host_dest(int s_id) {
       int find_shareid = 0;
       for (int i = 0; i < num_of_shareid; i++) {
@@ -1008,10 +1131,21 @@ public:
               find_shareid = i;
           }
       }
+      MachineID old_host = hostlist[find_shareid];
       guestlist[find_shareid].remove(m_id);
       guestlist[find_shareid].add(hostlist[find_shareid]);
       hostlist[find_shareid] = m_id;
       last_host_set_cycle[find_shareid] = current_cycle;
+      // A learned group is registered under the share id of every member
+      for (int i = 0; i < num_of_shareid; i++) {
+          if ((i != find_shareid) && (hostlist[i] == old_host) &&
+              guestlist[i].isElement(m_id)) {
+              guestlist[i].remove(m_id);
+              guestlist[i].add(old_host);
+              hostlist[i] = m_id;
+              last_host_set_cycle[i] = current_cycle;
+          }
+      }
       // warn("%lld: %s: Switch host for: %s in group %s, distance = %d, centerlevel = %d !\n", curTick(), name(), m_id, s_id);
   }
 
@@ -82,3 +82,14 @@ class RubyController(ClockedObject):
 
     alwaysPrepush = Param.Bool(False, "Prepush upon a shared data request if "
             "prepush is enabled, o.w., only prepush if it has not been done.")
+
+    shadow_timeout_thresholds = VectorParam.Int([], "Fixed waitlist timeout "
+            "thresholds (cycles) evaluated in the shadow of the real one")
+    shadow_adaptive_upper_bounds = VectorParam.Int([], "Upper bounds of "
+            "adaptive waitlist timeouts evaluated in the shadow of the real "
+            "one")
+    shadow_timeout_division = Param.Int(1, "Division applied to the "
+            "shadow thresholds like en_adaptive_timeout_division to the "
+            "real one")
+    pc_timeout_entries = Param.Int(0, "Entries of the per PC waitlist "
+            "timeout predictor, 0 keeps one threshold for all the PCs")
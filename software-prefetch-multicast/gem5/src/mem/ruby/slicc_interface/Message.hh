@@ -104,8 +104,11 @@ class Message
     { panic("getDemandDests() called on wrong message!"); }
 
     virtual bool isPrepushMsg() { return false; }
+    virtual bool isPrepushAck() { return false; }
     virtual bool isReadRequest() { return false; }
     virtual bool isInvRequest() { return false; }
+    virtual bool isTimeoutRequest() { return false; }
+    virtual bool isHostSwitchRequest() { return false; }
     virtual Addr getLineAddr() { return 0; }
 
     virtual const Addr& getpc() const
@@ -120,6 +123,9 @@ class Message
     virtual int getMessageTypeNum()
     { panic("getMessageTypeNum() called on wrong message!"); }
 
+    virtual int& getAckCount()
+    { panic("getAckCount() called on wrong message!"); }
+
     int getIncomingLink() const { return incoming_link; }
     void setIncomingLink(int link) { incoming_link = link; }
     int getVnet() const { return vnet; }
@@ -59,6 +59,36 @@ mapAddressToRange(Addr addr, MachineType type, int low_bit,
     return mach;
 }
 
+/** The machines the lines of a range, from addr on, are mapped to */
+inline NetDest
+mapAddressesToRange(Addr addr, int lines, MachineType type, int low_bit,
+                    int num_bits, int cluster_id = 0)
+{
+    NetDest dest;
+    for (int i = 0; i < lines; i++) {
+        dest.add(mapAddressToRange(makeNextStrideAddress(addr, i), type,
+                                   low_bit, num_bits, cluster_id));
+    }
+    return dest;
+}
+
+/**
+ * The lines of a range, from addr on, before the first one mapped to the
+ * machine, all of them if none is
+ */
+inline int
+linesToNextMapped(Addr addr, int lines, MachineID mach, int low_bit,
+                  int num_bits, int cluster_id = 0)
+{
+    int i = 0;
+    while (i < lines &&
+           mapAddressToRange(makeNextStrideAddress(addr, i), mach.type,
+                             low_bit, num_bits, cluster_id) != mach) {
+        i++;
+    }
+    return i;
+}
+
 inline NodeID
 machineIDToNodeID(MachineID machID)
 {
@@ -61,6 +61,7 @@
  
  bool CacheMemory::staticRegistered = false;
  Stats::Scalar CacheMemory::m_total_prepushes_sent;
+ Stats::Scalar CacheMemory::m_total_push_updates_sent;
  
  Stats::Scalar CacheMemory::m_total_prepushes_received;
  Stats::Scalar CacheMemory::m_total_redundant_prepushes_received;
@@ -88,6 +89,9 @@
  Stats::Scalar CacheMemory::m_total_guest_timeout;
  Stats::Scalar CacheMemory::m_total_demand_send;
  Stats::Scalar CacheMemory::m_total_guest_to_host_request;
+Stats::Scalar CacheMemory::m_total_host_range_prepush;
+Stats::Scalar CacheMemory::m_total_range_prefetches_covered;
+Stats::Scalar CacheMemory::m_total_region_invs_without_line;
  Tick CacheMemory::m_total_load_ticks;
  Stats::Scalar CacheMemory::m_total_load_ticks_out;
  Stats::Formula CacheMemory::m_avg_load_ticks;
@@ -96,6 +100,8 @@
  Stats::Scalar CacheMemory::m_total_prepushes_dropped_for_redundancy_in_prepush_buffer;
  Stats::Scalar CacheMemory::m_total_prepushes_for_demand_received;
  Stats::Scalar CacheMemory::m_total_prepush_buffer_replacement;
+ Stats::Scalar CacheMemory::m_total_prepush_buffer_hits;
+ Stats::Scalar CacheMemory::m_total_prepush_buffer_promotions;
  
  Stats::Scalar CacheMemory::totalPrepushedEntries;
  Stats::Scalar CacheMemory::totalEarlyPrepushedDemandEntries;
@@ -313,6 +319,16 @@
      return true;
  }
  
+ int
+ CacheMemory::absentLines(Addr address, int lines) const
+ {
+     int i = 0;
+     while (i < lines && !isTagPresent(makeNextStrideAddress(address, i))) {
+         i++;
+     }
+     return i;
+ }
+ 
  // Returns true if there is:
  //   a) a tag match on this address or there is
  //   b) an unused line in the same cache "way"
@@ -924,6 +940,12 @@
          .desc("Number of cache prepushes sent")
          .flags(Stats::nozero)
          ;
+
+     m_push_updates_sent
+         .name(name() + ".push_updates_sent")
+         .desc("Number of written blocks pushed to their last sharers")
+         .flags(Stats::nozero)
+         ;
  
      m_prepushes_received
          .name(name() + ".prepushes_received")
@@ -1026,6 +1048,18 @@
          .desc("Number of replacement in prepush buffer")
          .flags(Stats::nozero)
          ;
+
+     m_prepush_buffer_hits
+         .name(name() + ".prepush_buffer_hits")
+         .desc("Number of demand reads served from the prepush buffer")
+         .flags(Stats::nozero)
+         ;
+
+     m_prepush_buffer_promotions
+         .name(name() + ".prepush_buffer_promotions")
+         .desc("Number of prepush buffer lines moved to the cache")
+         .flags(Stats::nozero)
+         ;
  
      prepushedEntries
          .name(name() + ".prepushed_cache_entries")
@@ -1125,12 +1159,38 @@
              .desc("total guest to host request")
              .flags(Stats::nozero);
          ;
+
+         m_total_host_range_prepush
+             .name(ruby_name + ".L1Cache.total_host_range_prepush")
+             .desc("total host range prepush requests")
+             .flags(Stats::nozero);
+         ;
+
+         m_total_range_prefetches_covered
+             .name(ruby_name + ".L1Cache.total_range_prefetches_covered")
+             .desc("total prefetcht1 covered by a range prepush request")
+             .flags(Stats::nozero);
+         ;
+
+         m_total_region_invs_without_line
+             .name(ruby_name + ".L1Cache.total_region_invs_without_line")
+             .desc("total invalidations to the region sharers of a line "
+                   "received without the line")
+             .flags(Stats::nozero);
+         ;
  
          m_total_prepushes_sent
              .name(ruby_name + ".LLC.total_prepushes_sent")
              .desc("Total number of cache prepushes sent")
              .flags(Stats::nozero)
              ;
+
+         m_total_push_updates_sent
+             .name(ruby_name + ".LLC.total_push_updates_sent")
+             .desc("Total number of written blocks pushed to their last "
+                   "sharers")
+             .flags(Stats::nozero)
+             ;
  
          m_total_prepushes_received
              .name(ruby_name + ".L1Cache.total_prepushes_received")
@@ -1246,6 +1306,19 @@
              .desc("Total number of replacement in prepush buffer")
              .flags(Stats::nozero)
              ;
+
+         m_total_prepush_buffer_hits
+             .name(ruby_name + ".L1Cache.total_prepush_buffer_hits")
+             .desc("Total number of demand reads served from the prepush "
+                   "buffer")
+             .flags(Stats::nozero)
+             ;
+
+         m_total_prepush_buffer_promotions
+             .name(ruby_name + ".L1Cache.total_prepush_buffer_promotions")
+             .desc("Total number of prepush buffer lines moved to the cache")
+             .flags(Stats::nozero)
+             ;
  
          totalPrepushedEntries
              .name(ruby_name + ".L1Cache.total_prepushed_cache_entries")
@@ -1469,21 +1542,16 @@
          std::vector<AbstractCacheEntry*> set = *i;
          for (auto j = set.begin(); j != set.end(); ++j) {
              AbstractCacheEntry *line = *j;
-             if (line) {
-                 line->sharerRequestTime.clear();
-                 line->sharerAccessTime.clear();
-                 line->sharerNodeID.clear();
-             }
+             if (line)
+                 line->clearSharers();
          }
      }
  
      for (auto i =  0; i < sharerRequestInterval.size(); i++)
          sharerRequestInterval[i].clear();
-     sharerRequestInterval.clear();
  
      for (auto i =  0; i < sharerAccessInterval.size(); i++)
          sharerAccessInterval[i].clear();
-     sharerAccessInterval.clear();
  }
  
  void
@@ -1705,77 +1773,68 @@
  
      assert(entry);
  
-     std::vector<Cycles> &sharer_request_time = entry->sharerRequestTime;
-     std::sort(sharer_request_time.begin(), sharer_request_time.end());
-     std::vector<Cycles> &sharer_access_time = entry->sharerAccessTime;
-     assert(sharer_request_time.size() == sharer_access_time.size());
-     std::vector<NodeID> &sharer_node_id = entry->sharerNodeID;
-     assert(sharer_request_time.size() == sharer_node_id.size());
+     // The entry streams min/max/end intervals over all its accesses and
+     // keeps the first numSharerSlots of them for the per position intervals
+     uint32_t accesses = entry->numSharerAccesses;
+     uint32_t slots = entry->numSharerSlots;
  
-     if (sharer_access_time.size() == 1) {
+     if (accesses == 1) {
          numSingleSharerEntries++;
-         sharer_request_time.clear();
-         sharer_access_time.clear();
-         sharer_node_id.clear();
-     } else if (sharer_access_time.size() > 1) {
-         uint32_t min_interval = numeric_limits<uint32_t>::max();
-         uint32_t max_interval = 0;
-         uint32_t avg_interval = 0;
-         uint32_t end_interval = 0;
-         uint32_t req_end_interval = 0;
- 
-         uint32_t accesses = sharer_access_time.size();
-         uint32_t size = sharerAccessInterval.size();
-         assert(sharerRequestInterval.size() == sharerAccessInterval.size());
- 
-         if (accesses > size) {
-             sharerRequestInterval.resize(accesses);
-             sharerAccessInterval.resize(accesses);
+     } else if (accesses > 1) {
+         uint32_t end_interval =
+             entry->sharerLastAccessTime - entry->sharerFirstAccessTime;
+         uint32_t avg_interval = end_interval / (accesses - 1);
+ 
+         // Sized once to the largest number of sharer slots
+         if (slots > sharerAccessInterval.size()) {
+             sharerRequestInterval.resize(slots);
+             sharerAccessInterval.resize(slots);
+             sharerIntervals.resize(slots);
+             sharerRequestIntervals.resize(slots);
          }
  
-         std::ostringstream oss;
- 
-         oss << "[ 0 " << sharer_node_id[0];
- 
-         for (auto i = 1; i < sharer_access_time.size(); i++) {
-             uint32_t interval = sharer_access_time[i] -
-                 sharer_access_time[i-1];
- 
-             if (min_interval > interval)
-                 min_interval = interval;
-             if (max_interval < interval)
-                 max_interval = interval;
-             end_interval += interval;
- 
-             sharerAccessInterval[i].push_back(interval);
- 
-             // sharer request intervals
-             uint32_t req_interval = sharer_request_time[i] -
-                 sharer_request_time[i-1];
-             req_end_interval += req_interval;
-             sharerRequestInterval[i].push_back(req_interval);
+         Cycles *access_time = entry->sharerAccessTime.data();
+         Cycles *request_time = entry->sharerRequestTime.data();
+         std::sort(request_time, request_time + slots);
  
-             oss << " | " << interval << " " << sharer_node_id[i];
+         // Bulk reduction of the recorded slots into the scratch buffers
+         uint32_t *intervals = sharerIntervals.data();
+         uint32_t *req_intervals = sharerRequestIntervals.data();
+         for (uint32_t i = 1; i < slots; i++) {
+             intervals[i] = access_time[i] - access_time[i-1];
+             req_intervals[i] = request_time[i] - request_time[i-1];
          }
-         oss << " ]";
  
-         sharerAccessInterval[0].push_back(end_interval);
-         sharerRequestInterval[0].push_back(req_end_interval);
- 
-         avg_interval = end_interval / (sharer_access_time.size() - 1);
+         for (uint32_t i = 1; i < slots; i++) {
+             sharerAccessInterval[i].add(intervals[i]);
+             sharerRequestInterval[i].add(req_intervals[i]);
+         }
+         sharerAccessInterval[0].add(end_interval);
+         sharerRequestInterval[0].add(request_time[slots - 1] -
+                                      request_time[0]);
  
          sharerAvgAccessIntervalHistogram.sample(avg_interval);
-         sharerMinAccessIntervalHistogram.sample(min_interval);
-         sharerMaxAccessIntervalHistogram.sample(max_interval);
+         sharerMinAccessIntervalHistogram.sample(
+             entry->sharerMinAccessInterval);
+         sharerMaxAccessIntervalHistogram.sample(
+             entry->sharerMaxAccessInterval);
          sharerEndAccessIntervalHistogram.sample(end_interval);
  
-         sharer_request_time.clear();
-         sharer_access_time.clear();
-         sharer_node_id.clear();
- 
-         DPRINTF(RubyCacheProfile, "Profile for addr %#llx vaddr %#llx "
-                 "(access-time node-id): %s\n", entry->m_Address,
-                 entry->m_vAddress, oss.str());
+         if (DTRACE(RubyCacheProfile)) {
+             std::ostringstream oss;
+             oss << "[ 0 " << entry->sharerNodeID[0];
+             for (uint32_t i = 1; i < slots; i++)
+                 oss << " | " << intervals[i] << " " << entry->sharerNodeID[i];
+             if (accesses > slots)
+                 oss << " | +" << accesses - slots;
+             oss << " ]";
+ 
+             DPRINTF(RubyCacheProfile, "Profile for addr %#llx vaddr %#llx "
+                     "(access-time node-id): %s\n", entry->m_Address,
+                     entry->m_vAddress, oss.str());
+         }
      }
+ 
+     entry->clearSharers();
  }
  
\ No newline at end of file
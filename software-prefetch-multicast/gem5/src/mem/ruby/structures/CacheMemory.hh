@@ -50,7 +50,7 @@
  #include "mem/cache/replacement_policies/base.hh"
  #include "mem/cache/replacement_policies/replaceable_entry.hh"
  #include "mem/ruby/common/DataBlock.hh"
- #include "mem/ruby/common/IntVec.hh"
+ #include "mem/ruby/common/Histogram.hh"
  #include "mem/ruby/protocol/CacheRequestType.hh"
  #include "mem/ruby/protocol/CacheResourceType.hh"
  #include "mem/ruby/protocol/L1Cache_State.hh"
@@ -83,6 +83,8 @@
  
      // tests to see if an address is present in the cache
      bool isTagPresent(Addr address) const;
+     // the lines, from address on, before the first one present
+     int absentLines(Addr address, int lines) const;
  
      // Returns true if there is:
      //   a) a tag match on this address or there is
@@ -202,6 +204,8 @@
      // LLC stats
      Stats::Scalar m_prepushes_sent;
      static Stats::Scalar m_total_prepushes_sent;
+     Stats::Scalar m_push_updates_sent;
+     static Stats::Scalar m_total_push_updates_sent;
  
      // private cache stats
      Stats::Scalar m_prepushes_received;
@@ -221,6 +225,8 @@
      Stats::Scalar m_prepushes_dropped_for_prepush_buffer_full;
      Stats::Scalar m_prepushes_for_demand_received;
      Stats::Scalar m_prepush_buffer_replacement;
+     Stats::Scalar m_prepush_buffer_hits;
+     Stats::Scalar m_prepush_buffer_promotions;
      Stats::Scalar m_unusedDemandResponse;
  
      static Stats::Scalar m_total_prepushes_received;
@@ -255,11 +261,16 @@
      static Stats::Scalar m_total_guest_timeout;
      static Stats::Scalar m_total_demand_send;
      static Stats::Scalar m_total_guest_to_host_request;
+     static Stats::Scalar m_total_host_range_prepush;
+     static Stats::Scalar m_total_range_prefetches_covered;
+     static Stats::Scalar m_total_region_invs_without_line;
      
      static Stats::Scalar m_total_prepushes_dropped_for_redundancy_in_cache;
      static Stats::Scalar m_total_prepushes_dropped_for_redundancy_in_prepush_buffer;;
      static Stats::Scalar m_total_prepushes_for_demand_received;
      static Stats::Scalar m_total_prepush_buffer_replacement;
+     static Stats::Scalar m_total_prepush_buffer_hits;
+     static Stats::Scalar m_total_prepush_buffer_promotions;
  
      Stats::Scalar prepushedEntries;
      Stats::Scalar earlyPrepushedDemandEntries;
@@ -306,8 +317,11 @@
      Stats::Histogram sharerMinAccessIntervalHistogram;
      Stats::Histogram sharerMaxAccessIntervalHistogram;
      Stats::Histogram sharerEndAccessIntervalHistogram;
-     std::vector<IntVec> sharerAccessInterval;
-     std::vector<IntVec> sharerRequestInterval;
+     std::vector<Histogram> sharerAccessInterval;
+     std::vector<Histogram> sharerRequestInterval;
+     // scratch buffers of the entry interval reduction
+     std::vector<uint32_t> sharerIntervals;
+     std::vector<uint32_t> sharerRequestIntervals;
  
      bool printCacheEvictionDist;
  
@@ -0,0 +1,217 @@
+/* @file
+ * Prepush miss streams prefetched by the directory
+ */
+
+#include "mem/ruby/structures/PrepushStreamTable.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+#include "mem/ruby/slicc_interface/AbstractController.hh"
+#include "mem/ruby/slicc_interface/RubySlicc_Util.hh"
+
+PrepushStreamTable::PrepushStreamTable(AbstractController *controller,
+                                       int degree, int distance,
+                                       int num_streams, int num_lines)
+    : Stats::Group(controller, "prepushStream"),
+      m_controller(controller), m_degree(degree), m_distance(distance),
+      m_num_streams(num_streams), m_num_lines(num_lines), m_use(0),
+      m_prefetches(this, "prefetches", "Lines read ahead of the streams"),
+      m_hits(this, "hits", "Fetches served from the stream buffer"),
+      m_late_hits(this, "lateHits",
+                  "Fetches waiting for the read of a stream"),
+      m_unused_evictions(this, "unusedEvictions",
+                         "Buffered lines replaced before their fetch"),
+      m_invalidations(this, "invalidations",
+                      "Buffered or read lines dropped by a write"),
+      m_stream_allocations(this, "streamAllocations",
+                           "Streams allocated to a group"),
+      m_accuracy(this, "accuracy", "Prefetched lines fetched afterwards",
+                 m_hits / m_prefetches)
+{
+    fatal_if(degree < 0, "A stream degree of %d lines", degree);
+    fatal_if(isEnabled() && (distance <= 0 || num_streams <= 0 ||
+                             num_lines <= 0),
+             "Prepush streams need a distance, streams and lines");
+}
+
+PrepushStreamTable::Stream &
+PrepushStreamTable::lookupStream(int group, Addr addr)
+{
+    auto it = m_streams.find(group);
+    if (it != m_streams.end())
+        return it->second;
+
+    if (m_streams.size() >= m_num_streams) {
+        auto victim = m_streams.begin();
+        for (auto s = m_streams.begin(); s != m_streams.end(); s++) {
+            if (s->second.lastUse < victim->second.lastUse)
+                victim = s;
+        }
+        m_streams.erase(victim);
+    }
+    m_stream_allocations++;
+    return m_streams.emplace(group, Stream{addr, 0, 0, addr, 0, m_use})
+        .first->second;
+}
+
+bool
+PrepushStreamTable::isMapped(Addr addr) const
+{
+    return m_controller->mapAddressToMachine(addr, MachineType_Directory) ==
+           m_controller->getMachineID();
+}
+
+bool
+PrepushStreamTable::isTracked(Addr addr) const
+{
+    return isPending(addr) || isBuffered(addr);
+}
+
+void
+PrepushStreamTable::observe(int group, Addr addr)
+{
+    assert(isEnabled());
+    m_use++;
+    Stream &stream = lookupStream(group, addr);
+    stream.lastUse = m_use;
+
+    int64_t delta = (int64_t)(addr - stream.last);
+    if (delta == 0)
+        return;
+    if (delta == stream.stride) {
+        stream.confidence = std::min(stream.confidence + 1, 3);
+    } else {
+        stream.stride = delta;
+        stream.confidence = 0;
+        stream.frontier = addr;
+    }
+    stream.last = addr;
+    if (stream.confidence == 0)
+        return;
+
+    for (int k = m_distance; k < m_distance + m_degree; k++) {
+        Addr line = addr + k * stream.stride;
+        // Already queued for a previous fetch of the stream
+        if (stream.stride > 0 ? line <= stream.frontier :
+                                line >= stream.frontier) {
+            continue;
+        }
+        stream.frontier = line;
+        if (isMapped(line) && !isTracked(line))
+            m_queue.push_back(Prefetch{line, group, stream.sequence++});
+    }
+}
+
+int
+PrepushStreamTable::nextGroup() const
+{
+    assert(hasPrefetch());
+    return m_queue.front().group;
+}
+
+int
+PrepushStreamTable::nextSequence() const
+{
+    assert(hasPrefetch());
+    return m_queue.front().sequence;
+}
+
+Addr
+PrepushStreamTable::popPrefetch()
+{
+    assert(hasPrefetch());
+    Addr addr = m_queue.front().addr;
+    m_queue.pop_front();
+    return addr;
+}
+
+bool
+PrepushStreamTable::canIssue(Addr addr) const
+{
+    // The buffer makes room for the line when it returns
+    return !isTracked(addr) && m_pending.size() < m_num_lines;
+}
+
+void
+PrepushStreamTable::issue(Addr addr)
+{
+    assert(canIssue(addr));
+    m_pending.emplace(addr, Read{true});
+    m_prefetches++;
+}
+
+bool
+PrepushStreamTable::isPending(Addr addr) const
+{
+    return m_pending.count(addr) > 0;
+}
+
+bool
+PrepushStreamTable::isBuffered(Addr addr) const
+{
+    return m_lines.count(addr) > 0;
+}
+
+void
+PrepushStreamTable::fill(Addr addr, const DataBlock &data)
+{
+    auto it = m_pending.find(addr);
+    assert(it != m_pending.end());
+    bool valid = it->second.valid;
+    m_pending.erase(it);
+    if (!valid)
+        return;
+
+    if (m_lines.size() >= m_num_lines) {
+        auto victim = m_lines.begin();
+        for (auto l = m_lines.begin(); l != m_lines.end(); l++) {
+            if (l->second.lastUse < victim->second.lastUse)
+                victim = l;
+        }
+        m_lines.erase(victim);
+        m_unused_evictions++;
+    }
+    m_lines.emplace(addr, Line{data, ++m_use});
+}
+
+DataBlock
+PrepushStreamTable::consume(Addr addr)
+{
+    auto it = m_lines.find(addr);
+    assert(it != m_lines.end());
+    DataBlock data = it->second.data;
+    m_lines.erase(it);
+    m_hits++;
+    return data;
+}
+
+void
+PrepushStreamTable::invalidate(Addr addr)
+{
+    auto it = m_pending.find(addr);
+    if (it != m_pending.end() && it->second.valid) {
+        it->second.valid = false;
+        m_invalidations++;
+    }
+    if (m_lines.erase(addr) > 0)
+        m_invalidations++;
+}
+
+int
+PrepushStreamTable::functionalWrite(Packet *pkt)
+{
+    int num_functional_writes = 0;
+    for (auto &line : m_lines) {
+        num_functional_writes +=
+            testAndWrite(line.first, line.second.data, pkt);
+    }
+    return num_functional_writes;
+}
+
+void
+PrepushStreamTable::print(std::ostream &out) const
+{
+    out << "[PrepushStreamTable: " << m_streams.size() << " streams, "
+        << m_lines.size() << " lines, " << m_pending.size() << " reads]";
+}
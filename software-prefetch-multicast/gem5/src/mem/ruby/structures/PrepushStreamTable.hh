@@ -0,0 +1,162 @@
+/* @file
+ * Prepush miss streams prefetched by the directory
+ */
+
+#ifndef __MEM_RUBY_STRUCTURES_PREPUSHSTREAMTABLE_HH__
+#define __MEM_RUBY_STRUCTURES_PREPUSHSTREAMTABLE_HH__
+
+#include <deque>
+#include <iostream>
+#include <unordered_map>
+
+#include "base/statistics.hh"
+#include "base/stats/group.hh"
+#include "mem/packet.hh"
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/DataBlock.hh"
+
+class AbstractController;
+
+/**
+ * Streams of the SPM prepush misses of the share groups, detected by a
+ * directory from the fetches of the LLC. A prepush missing in the LLC
+ * costs a DRAM access, and the host requests the next line only after it
+ * issues its next prefetcht1: the directory reads the lines ahead of a
+ * group from memory into a small buffer, to serve its next prepush misses
+ * at directory latency.
+ *
+ * Every group has a stream of the lines it fetched at this directory. Two
+ * consecutive fetches with the same stride confirm it, and every fetch of
+ * a confirmed stream queues the lines from distance to distance + degree
+ * - 1 strides ahead which map to this directory and were not queued yet.
+ * The directory issues the queued lines as its own requests, so that a
+ * line is only read while its directory state is invalid. The buffered
+ * lines are clean copies of memory: a buffered line is handed out by the
+ * next fetch of any L2, dropped by a DMA write, and replaced by LRU.
+ */
+class PrepushStreamTable : public Stats::Group
+{
+  public:
+    /**
+     * @param degree Lines prefetched ahead of a fetch, 0 disables the
+     *        streams
+     * @param distance Strides between a fetch and its first prefetch
+     * @param num_streams Groups tracked at once
+     * @param num_lines Lines buffered or being read at once
+     */
+    PrepushStreamTable(AbstractController *controller, int degree,
+                       int distance, int num_streams, int num_lines);
+
+    bool isEnabled() const { return m_degree > 0; }
+
+    /** A prepush fetch of the group, queueing the lines ahead of it */
+    void observe(int group, Addr addr);
+
+    /** Whether a line is queued to be prefetched */
+    bool hasPrefetch() const { return !m_queue.empty(); }
+
+    /**
+     * Group of the next queued line, and its sequence in the stream of
+     * the group, for the memory controller to tell the streams apart
+     */
+    int nextGroup() const;
+    int nextSequence() const;
+
+    /** The next queued line, no longer queued */
+    Addr popPrefetch();
+
+    /** Whether a queued line is not tracked and a read can be issued */
+    bool canIssue(Addr addr) const;
+
+    /** The memory read of a queued line is issued */
+    void issue(Addr addr);
+
+    /** Whether a read issued by the streams is in flight */
+    bool isPending(Addr addr) const;
+
+    /** Whether the data of a line is buffered */
+    bool isBuffered(Addr addr) const;
+
+    /** The memory read of a line returns */
+    void fill(Addr addr, const DataBlock &data);
+
+    /** The data of a buffered line, no longer buffered */
+    DataBlock consume(Addr addr);
+
+    /** A write to memory, the line is no longer buffered */
+    void invalidate(Addr addr);
+
+    /** Fetch of a line the streams are still reading */
+    void profileLate() { m_late_hits++; }
+
+    int functionalWrite(Packet *pkt);
+
+    void print(std::ostream &out) const;
+
+  private:
+    struct Stream
+    {
+        Addr last;
+        int64_t stride;
+        int confidence;
+        // Last line queued in the direction of the stride
+        Addr frontier;
+        // Lines queued since the allocation of the stream
+        int sequence;
+        uint64_t lastUse;
+    };
+
+    struct Prefetch
+    {
+        Addr addr;
+        int group;
+        int sequence;
+    };
+
+    struct Line
+    {
+        DataBlock data;
+        uint64_t lastUse;
+    };
+
+    struct Read
+    {
+        // Dropped by a write, the data is not buffered
+        bool valid;
+    };
+
+    Stream &lookupStream(int group, Addr addr);
+    bool isMapped(Addr addr) const;
+    bool isTracked(Addr addr) const;
+
+    AbstractController *m_controller;
+    const int m_degree;
+    const int m_distance;
+    const size_t m_num_streams;
+    const size_t m_num_lines;
+
+    uint64_t m_use;
+    std::unordered_map<int, Stream> m_streams;
+    std::deque<Prefetch> m_queue;
+    std::unordered_map<Addr, Read> m_pending;
+    std::unordered_map<Addr, Line> m_lines;
+
+  public:
+    Stats::Scalar m_prefetches;
+    Stats::Scalar m_hits;
+    Stats::Scalar m_late_hits;
+    Stats::Scalar m_unused_evictions;
+    Stats::Scalar m_invalidations;
+    Stats::Scalar m_stream_allocations;
+    Stats::Formula m_accuracy;
+};
+
+inline std::ostream &
+operator<<(std::ostream &out, const PrepushStreamTable &obj)
+{
+    obj.print(out);
+    out << std::flush;
+    return out;
+}
+
+#endif // __MEM_RUBY_STRUCTURES_PREPUSHSTREAMTABLE_HH__
@@ -0,0 +1,143 @@
+/* @file
+ * Sharers of the LLC lines tracked per memory region
+ */
+
+#include "mem/ruby/structures/RegionSharerTable.hh"
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "mem/ruby/system/RubySystem.hh"
+
+RegionSharerTable::RegionSharerTable(Stats::Group *parent, int region_size,
+                                     int num_entries)
+    : Stats::Group(parent, "regionSharers"),
+      m_region_size(region_size), m_region_mask(region_size - 1),
+      m_num_entries(num_entries), m_lines(0),
+      m_allocations(this, "allocations", "Regions allocated"),
+      m_releases(this, "releases", "Regions released by their last line"),
+      m_table_full(this, "tableFull",
+                   "Lines keeping per line sharers, the table being full"),
+      m_tracked_lines(this, "trackedLines", "Lines tracked by a region"),
+      m_lines_per_region(this, "linesPerRegion",
+                         "Lines tracked per region allocated",
+                         m_tracked_lines / m_allocations),
+      m_generations(this, "generations",
+                    "Region generations started by new sharers"),
+      m_pruned(this, "pruned",
+               "Sharers dropped with the last line of their generation"),
+      m_inv_sharers(this, "invSharers",
+                    "L1s invalidated through the sharers of a region"),
+      m_region_bits(this, "regionBits",
+                    "Bits of sharer storage held by the regions"),
+      m_line_bits_saved(this, "lineBitsSaved",
+                        "Bits of per line sharer vectors not kept by the "
+                        "tracked lines")
+{
+    fatal_if(region_size < 0 || (region_size > 0 && !isPowerOf2(region_size)),
+             "Region size %d is not a power of 2", region_size);
+    fatal_if(isEnabled() && num_entries <= 0,
+             "A region sharer table needs entries");
+}
+
+int
+RegionSharerTable::sharerBits() const
+{
+    return MachineType_base_count(MachineType_L1Cache);
+}
+
+void
+RegionSharerTable::updateStorage()
+{
+    // A region is a tag of a 48 bit physical address, two sharer vectors
+    // and two line counts. A tracked line keeps a tracked and a
+    // generation bit instead of its sharer vector.
+    int lines_per_region = m_region_size / RubySystem::getBlockSizeBytes();
+    int region_bits = (48 - floorLog2(m_region_size)) + 2 * sharerBits() +
+                      2 * (floorLog2(lines_per_region) + 1) + 1;
+    m_region_bits = m_regions.size() * region_bits;
+    m_line_bits_saved = m_lines * (sharerBits() - 2);
+}
+
+int
+RegionSharerTable::track(Addr addr, const NetDest &sharers)
+{
+    if (!isEnabled())
+        return -1;
+
+    Addr region = regionAddress(addr);
+    auto it = m_regions.find(region);
+    if (it == m_regions.end()) {
+        if (m_regions.size() >= m_num_entries) {
+            m_table_full++;
+            return -1;
+        }
+        it = m_regions.emplace(region, Region{{}, {0, 0}, 0}).first;
+        m_allocations++;
+    }
+
+    // Sharers the current generation lacks start a new one, if the lines
+    // of the other one have all left
+    Region &r = it->second;
+    int other = 1 - r.current;
+    if (r.lines[other] == 0 && r.lines[r.current] > 0 &&
+        !r.sharers[r.current].isSuperset(sharers)) {
+        r.current = other;
+        m_generations++;
+    }
+
+    r.sharers[r.current].addNetDest(sharers);
+    r.lines[r.current]++;
+    m_tracked_lines++;
+    m_lines++;
+    updateStorage();
+    return r.current;
+}
+
+void
+RegionSharerTable::addSharers(Addr addr, int gen, const NetDest &sharers)
+{
+    auto it = m_regions.find(regionAddress(addr));
+    assert(it != m_regions.end() && it->second.lines[gen] > 0);
+    it->second.sharers[gen].addNetDest(sharers);
+}
+
+void
+RegionSharerTable::untrack(Addr addr, int gen)
+{
+    auto it = m_regions.find(regionAddress(addr));
+    assert(it != m_regions.end() && it->second.lines[gen] > 0);
+    Region &r = it->second;
+    m_lines--;
+    if (--r.lines[gen] == 0) {
+        m_pruned += r.sharers[gen].count();
+        r.sharers[gen].clear();
+        if (r.lines[1 - gen] == 0) {
+            m_regions.erase(it);
+            m_releases++;
+        }
+    }
+    updateStorage();
+}
+
+const NetDest &
+RegionSharerTable::getSharers(Addr addr, int gen) const
+{
+    auto it = m_regions.find(regionAddress(addr));
+    assert(it != m_regions.end() && it->second.lines[gen] > 0);
+    return it->second.sharers[gen];
+}
+
+const NetDest &
+RegionSharerTable::getInvSharers(Addr addr, int gen)
+{
+    const NetDest &sharers = getSharers(addr, gen);
+    m_inv_sharers += sharers.count();
+    return sharers;
+}
+
+void
+RegionSharerTable::print(std::ostream &out) const
+{
+    out << "[RegionSharerTable: " << m_regions.size() << " of "
+        << m_num_entries << " regions, " << m_lines << " lines]";
+}
@@ -0,0 +1,117 @@
+/* @file
+ * Sharers of the LLC lines tracked per memory region
+ */
+
+#ifndef __MEM_RUBY_STRUCTURES_REGIONSHARERTABLE_HH__
+#define __MEM_RUBY_STRUCTURES_REGIONSHARERTABLE_HH__
+
+#include <iostream>
+#include <unordered_map>
+
+#include "base/statistics.hh"
+#include "base/stats/group.hh"
+#include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/NetDest.hh"
+
+/**
+ * Sharers of the lines of a memory region, next to the per line sharers
+ * of the LLC directory. The prepush multicasts add a whole SPM group to
+ * the sharers of a line, and a streaming kernel does so for every line of
+ * the pages the group works on: the LLC records the group once per
+ * region instead of in the sharer vector of every line.
+ *
+ * A tracked line keeps no sharer vector, only the generation of its
+ * region it belongs to. A region holds one sharer set per generation, the
+ * union of the sharers of its lines of that generation, and the sharers
+ * of a line are those of its generation. A new line that brings sharers
+ * its generation lacks starts the other generation once all the lines of
+ * that one have left; the sharers of a generation are dropped with its
+ * last line, so the stale sharers of the region are pruned. A line leaves
+ * its region when its sharers are cleared, and the region is released
+ * with its last line. No region is evicted: when the table is full, the
+ * lines of new regions keep exact per line sharers.
+ *
+ * An invalidation multicast to the sharers of a generation may reach L1s
+ * without the line, which acknowledge it anyway. The invalidations stay
+ * per line: invalidating a whole region at once would take the other
+ * lines of the region out of the LLC states and TBEs they are in.
+ */
+class RegionSharerTable : public Stats::Group
+{
+  public:
+    /**
+     * @param region_size Bytes per region, a power of two, 0 disables
+     *        the region tracking
+     * @param num_entries Regions tracked at once
+     */
+    RegionSharerTable(Stats::Group *parent, int region_size,
+                      int num_entries);
+
+    bool isEnabled() const { return m_region_size > 0; }
+
+    /**
+     * Track the sharers of the line at addr in its region
+     * @return the generation of the line, -1 if the region is not
+     *         tracked, then the line keeps per line sharers
+     */
+    int track(Addr addr, const NetDest &sharers);
+
+    /** Add sharers to the generation of a tracked line */
+    void addSharers(Addr addr, int gen, const NetDest &sharers);
+
+    /** The line at addr of generation gen is no longer tracked */
+    void untrack(Addr addr, int gen);
+
+    /** Sharers of a tracked line, those of its generation */
+    const NetDest &getSharers(Addr addr, int gen) const;
+
+    /** Sharers of a tracked line, to be invalidated */
+    const NetDest &getInvSharers(Addr addr, int gen);
+
+    void print(std::ostream &out) const;
+
+  private:
+    struct Region
+    {
+        NetDest sharers[2];
+        int lines[2];
+        int current;
+    };
+
+    Addr regionAddress(Addr addr) const { return addr & ~m_region_mask; }
+
+    /** Bits of a sharer vector, one per L1 */
+    int sharerBits() const;
+
+    /** Update the storage held by the regions and saved on the lines */
+    void updateStorage();
+
+    const Addr m_region_size;
+    const Addr m_region_mask;
+    const size_t m_num_entries;
+
+    std::unordered_map<Addr, Region> m_regions;
+    int m_lines;
+
+  public:
+    Stats::Scalar m_allocations;
+    Stats::Scalar m_releases;
+    Stats::Scalar m_table_full;
+    Stats::Scalar m_tracked_lines;
+    Stats::Formula m_lines_per_region;
+    Stats::Scalar m_generations;
+    Stats::Scalar m_pruned;
+    Stats::Scalar m_inv_sharers;
+    Stats::Average m_region_bits;
+    Stats::Average m_line_bits_saved;
+};
+
+inline std::ostream &
+operator<<(std::ostream &out, const RegionSharerTable &obj)
+{
+    obj.print(out);
+    out << std::flush;
+    return out;
+}
+
+#endif // __MEM_RUBY_STRUCTURES_REGIONSHARERTABLE_HH__
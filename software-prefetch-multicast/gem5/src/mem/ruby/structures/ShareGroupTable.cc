@@ -0,0 +1,207 @@
+/* @file
+ * SPM share groups learned by the LLC
+ */
+
+#include "mem/ruby/structures/ShareGroupTable.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+#include "mem/ruby/slicc_interface/AbstractController.hh"
+
+ShareGroupTable::ShareGroupTable(AbstractController *controller,
+                                 bool enabled, int num_cores, int threshold,
+                                 int epoch, bool center_level)
+    : Stats::Group(controller, "shareGroups"),
+      m_controller(controller), m_enabled(enabled), m_num_cores(num_cores),
+      m_threshold(threshold), m_max_count(2 * threshold), m_epoch(epoch),
+      m_center_level(center_level), m_observations(0),
+      m_regroups(this, "regroups", "Regroupings changing some group"),
+      m_groups_formed(this, "groupsFormed",
+                      "Groups of several cores formed"),
+      m_groups_dissolved(this, "groupsDissolved",
+                         "Groups of several cores dissolved"),
+      m_notifications(this, "notifications",
+                      "Cores told their new role in their group")
+{
+    if (!enabled)
+        return;
+
+    fatal_if(threshold <= 0 || epoch <= 0,
+             "Learning share groups needs a threshold and an epoch");
+
+    m_counters.resize(num_cores * num_cores, 0);
+    m_groups.resize(num_cores);
+    // The L1s start as hosts of every LLC bank
+    m_told_host.resize(num_cores, true);
+    for (NodeID c = 0; c < num_cores; c++) {
+        MachineID core(MachineType_L1Cache, c);
+        m_groups[c].add(core);
+        m_controller->set_share_group(c, core, NetDest(), 0, 0,
+                                      m_controller->curCycle());
+    }
+}
+
+int &
+ShareGroupTable::counter(NodeID a, NodeID b)
+{
+    return a < b ? m_counters[a * m_num_cores + b] :
+                   m_counters[b * m_num_cores + a];
+}
+
+bool
+ShareGroupTable::isHost(MachineID core) const
+{
+    return m_controller->config_ack_host_dest(core.getNum()) == core;
+}
+
+void
+ShareGroupTable::observe(MachineID requestor, const NetDest &requestors)
+{
+    assert(m_enabled);
+    NodeID r = requestor.getNum();
+    bool guest = !isHost(requestor);
+    for (NodeID c = 0; c < m_num_cores; c++) {
+        MachineID core(MachineType_L1Cache, c);
+        if (c == r)
+            continue;
+        int &count = counter(r, c);
+        if (requestors.isElement(core)) {
+            count = std::min(count + 1, m_max_count);
+        } else if (guest && m_groups[r].isElement(core)) {
+            count = std::max(count - 1, 0);
+        }
+    }
+
+    if (++m_observations >= m_epoch) {
+        m_observations = 0;
+        regroup();
+    }
+}
+
+void
+ShareGroupTable::regroup()
+{
+    // Union find of the pairs over the threshold, the old sharing of the
+    // cores of different groups fading out
+    std::vector<NodeID> root(m_num_cores);
+    for (NodeID c = 0; c < m_num_cores; c++)
+        root[c] = c;
+    auto find = [&root](NodeID c) {
+        while (root[c] != c)
+            c = root[c] = root[root[c]];
+        return c;
+    };
+    for (NodeID a = 0; a < m_num_cores; a++) {
+        for (NodeID b = a + 1; b < m_num_cores; b++) {
+            int &count = counter(a, b);
+            if (!m_groups[a].isElement(MachineID(MachineType_L1Cache, b)))
+                count /= 2;
+            if (count >= m_threshold)
+                root[find(b)] = find(a);
+        }
+    }
+
+    std::vector<NetDest> groups(m_num_cores);
+    for (NodeID c = 0; c < m_num_cores; c++)
+        groups[find(c)].add(MachineID(MachineType_L1Cache, c));
+
+    bool changed = false;
+    for (NodeID c = 0; c < m_num_cores; c++) {
+        const NetDest &group = groups[find(c)];
+        const NetDest &old_group = m_groups[c];
+        if (group == old_group)
+            continue;
+
+        // Every group is visited from its first member
+        if (old_group.smallestElement(MachineType_L1Cache).getNum() == c &&
+            old_group.count() > 1) {
+            m_groups_dissolved++;
+        }
+        if (find(c) == c) {
+            if (group.count() > 1)
+                m_groups_formed++;
+
+            MachineID host = selectHost(group);
+            NetDest guests = group;
+            guests.remove(host);
+            int distance = m_controller->cal_distance(host,
+                m_controller->getMachineID(), m_num_cores);
+            int center_level = m_controller->center_distance(host,
+                                                             m_num_cores);
+            Cycles now = m_controller->curCycle();
+            for (NodeID m = 0; m < m_num_cores; m++) {
+                if (group.isElement(MachineID(MachineType_L1Cache, m))) {
+                    m_controller->set_share_group(m, host, guests, distance,
+                                                  center_level, now);
+                }
+            }
+        }
+        changed = true;
+    }
+
+    if (changed) {
+        // The groups are updated once all of them are visited, a new
+        // group possibly taking cores of several old ones
+        for (NodeID c = 0; c < m_num_cores; c++)
+            m_groups[c] = groups[find(c)];
+        m_regroups++;
+    }
+}
+
+MachineID
+ShareGroupTable::selectHost(const NetDest &members) const
+{
+    MachineID best;
+    int best_level = 0;
+    int best_distance = 0;
+    bool best_host = false;
+    for (NodeID m = 0; m < m_num_cores; m++) {
+        MachineID core(MachineType_L1Cache, m);
+        if (!members.isElement(core))
+            continue;
+
+        int level = m_center_level ?
+            m_controller->center_distance(core, m_num_cores) : 0;
+        int distance = m_controller->cal_distance(core,
+            m_controller->getMachineID(), m_num_cores);
+        // A core already host keeps its role on a tie
+        bool host = m_told_host[m];
+        if (best.getType() == MachineType_NUM || level > best_level ||
+            (level == best_level && (distance < best_distance ||
+             (distance == best_distance && host && !best_host)))) {
+            best = core;
+            best_level = level;
+            best_distance = distance;
+            best_host = host;
+        }
+    }
+    assert(best.getType() != MachineType_NUM);
+    return best;
+}
+
+bool
+ShareGroupTable::notify(MachineID requestor)
+{
+    assert(m_enabled);
+    bool host = isHost(requestor);
+    if (m_told_host[requestor.getNum()] == host)
+        return false;
+
+    m_told_host[requestor.getNum()] = host;
+    m_notifications++;
+    return true;
+}
+
+void
+ShareGroupTable::hostSwitched(MachineID old_host, MachineID new_host)
+{
+    m_told_host[old_host.getNum()] = false;
+    m_told_host[new_host.getNum()] = true;
+}
+
+void
+ShareGroupTable::print(std::ostream &out) const
+{
+    out << "[ShareGroupTable: " << m_num_cores << " cores]";
+}
@@ -0,0 +1,105 @@
+/* @file
+ * SPM share groups learned by the LLC
+ */
+
+#ifndef __MEM_RUBY_STRUCTURES_SHAREGROUPTABLE_HH__
+#define __MEM_RUBY_STRUCTURES_SHAREGROUPTABLE_HH__
+
+#include <iostream>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "base/stats/group.hh"
+#include "mem/ruby/common/MachineID.hh"
+#include "mem/ruby/common/NetDest.hh"
+
+class AbstractController;
+
+/**
+ * Share groups of the SPM protocol learned by an LLC bank from the GetS of
+ * the L1s, instead of the Config_Req handshake of every core. Each core
+ * starts as the host of a group of its own, registered under its core id
+ * as share id, and the learned groups are registered under the share id
+ * of every member.
+ *
+ * A saturating counter per pair of cores counts the lines both of them
+ * request. A GetS to a line another core requested since its allocation
+ * increments their counter, and a guest requesting a line its group mates
+ * did not decrements its counters with them, the prepush of its host
+ * having missed it. Every epoch GetS, the counters of the cores of
+ * different groups are halved and the cores are regrouped by the pairs
+ * whose counter reaches the threshold, so that groups form and dissolve
+ * with the sharing of the program. The host of a new group is chosen like
+ * config_register does: closest to the center of the mesh, then to the
+ * LLC bank.
+ */
+class ShareGroupTable : public Stats::Group
+{
+  public:
+    /**
+     * @param num_cores L1 caches, numbered like the share ids
+     * @param threshold Counter of the pairs of cores grouped together
+     * @param epoch GetS observed between two regroupings
+     * @param center_level Choose the hosts by center level first
+     */
+    ShareGroupTable(AbstractController *controller, bool enabled,
+                    int num_cores, int threshold, int epoch,
+                    bool center_level);
+
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * A GetS of requestor to a line requested by requestors since its
+     * allocation
+     */
+    void observe(MachineID requestor, const NetDest &requestors);
+
+    /**
+     * Whether requestor has to be told its role in its group, it is then
+     * considered told
+     */
+    bool notify(MachineID requestor);
+
+    /** The LLC told new_host it replaces old_host as host */
+    void hostSwitched(MachineID old_host, MachineID new_host);
+
+    void print(std::ostream &out) const;
+
+  private:
+    void regroup();
+    MachineID selectHost(const NetDest &members) const;
+    int &counter(NodeID a, NodeID b);
+    bool isHost(MachineID core) const;
+
+    AbstractController *m_controller;
+    const bool m_enabled;
+    const int m_num_cores;
+    const int m_threshold;
+    const int m_max_count;
+    const int m_epoch;
+    const bool m_center_level;
+
+    int m_observations;
+    // Counter of every pair of cores, the lower core id first
+    std::vector<int> m_counters;
+    // Members of the group of every core
+    std::vector<NetDest> m_groups;
+    // Whether every core was last told it is a host
+    std::vector<bool> m_told_host;
+
+  public:
+    Stats::Scalar m_regroups;
+    Stats::Scalar m_groups_formed;
+    Stats::Scalar m_groups_dissolved;
+    Stats::Scalar m_notifications;
+};
+
+inline std::ostream &
+operator<<(std::ostream &out, const ShareGroupTable &obj)
+{
+    obj.print(out);
+    out << std::flush;
+    return out;
+}
+
+#endif // __MEM_RUBY_STRUCTURES_SHAREGROUPTABLE_HH__
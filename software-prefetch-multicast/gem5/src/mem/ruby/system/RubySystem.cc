@@ -345,6 +345,13 @@ RubySystem::serialize(CheckpointOut &cp) const
 
     SERIALIZE_SCALAR(cache_trace_file);
     SERIALIZE_SCALAR(cache_trace_size);
+
+    // The prepush/profiling windows are opened by pseudo-ops in the ROI, so
+    // a checkpoint taken inside the ROI has to carry them along.
+    bool prepush_enabled = AbstractController::isPrepushEnabled();
+    bool profiling_enabled = AbstractController::isProfilingEnabled();
+    SERIALIZE_SCALAR(prepush_enabled);
+    SERIALIZE_SCALAR(profiling_enabled);
 }
 
 void
@@ -407,6 +414,15 @@ RubySystem::unserialize(CheckpointIn &cp)
     UNSERIALIZE_SCALAR(cache_trace_size);
     cache_trace_file = cp.getCptDir() + "/" + cache_trace_file;
 
+    bool prepush_enabled = false;
+    bool profiling_enabled = false;
+    UNSERIALIZE_OPT_SCALAR(prepush_enabled);
+    UNSERIALIZE_OPT_SCALAR(profiling_enabled);
+    if (prepush_enabled)
+        AbstractController::enablePrepush();
+    if (profiling_enabled)
+        AbstractController::enableProfiling();
+
     readCompressedTrace(cache_trace_file, uncompressed_trace,
                         cache_trace_size);
     m_warmup_enabled = true;
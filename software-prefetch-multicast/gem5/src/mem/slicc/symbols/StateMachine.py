@@ -1061,7 +1061,10 @@ $c_ident::recordCacheTrace(int cntrl, CacheRecorder* tr)
         for param in self.config_parameters:
             if param.type_ast.type.ident == "CacheMemory":
                 assert(param.pointer)
-                code('m_${{param.ident}}_ptr->recordCacheContents(cntrl, tr);')
+                code('''
+if (m_${{param.ident}}_ptr != NULL) {
+    m_${{param.ident}}_ptr->recordCacheContents(cntrl, tr);
+}''')
 
         code.dedent()
         code('''
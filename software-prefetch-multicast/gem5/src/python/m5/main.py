@@ -145,7 +145,9 @@ def parse_options():
     option("--debug-end", metavar="TICK", type='int',
         help="End debug output at TICK")
     option("--debug-file", metavar="FILE", default="cout",
-        help="Sets the output file for debug [Default: %default]")
+        help="Sets the output file for debug, a FILE ending in .trc is a "
+        "compressed binary trace to decode with "
+        "util/decode_debug_trace.py [Default: %default]")
     option("--debug-ignore", metavar="EXPR", action='append', split=':',
         help="Ignore EXPR sim objects")
     option("--remote-gdb-port", type='int', default=7000,
@@ -42,12 +42,15 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 
+#include <fstream>
+#include <iostream>
 #include <map>
 #include <vector>
 
 #include "base/debug.hh"
 #include "base/output.hh"
 #include "base/trace.hh"
+#include "base/trace_file.hh"
 #include "sim/debug.hh"
 
 namespace py = pybind11;
@@ -59,6 +62,19 @@ extern int allFlagsVersion;
 static void
 output(const char *filename)
 {
+    const std::string name(filename);
+    const std::string binary_ext(".trc");
+
+    // Binary traces are compressed by the logger
+    if (name.size() > binary_ext.size() &&
+        name.compare(name.size() - binary_ext.size(), binary_ext.size(),
+                     binary_ext) == 0) {
+        OutputStream *file_stream = simout.create(name, true, true);
+        Trace::setDebugLogger(
+            new Trace::BinaryLogger(*file_stream->stream()));
+        return;
+    }
+
     OutputStream *file_stream = simout.find(filename);
 
     if (!file_stream)
@@ -67,6 +83,20 @@ output(const char *filename)
     Trace::setDebugLogger(new Trace::OstreamLogger(*file_stream->stream()));
 }
 
+static bool
+decode(const std::string &in, const std::string &out)
+{
+    std::ifstream is(in, std::ios::binary);
+    if (!is)
+        return false;
+
+    if (out.empty())
+        return Trace::decodeTraceFile(is, std::cout);
+
+    std::ofstream os(out);
+    return Trace::decodeTraceFile(is, os);
+}
+
 static void
 ignore(const char *expr)
 {
@@ -120,6 +150,7 @@ pybind_init_debug(py::module &m_native)
     m_trace
         .def("output", &output)
         .def("ignore", &ignore)
+        .def("decode", &decode)
         .def("enable", &Trace::enable)
         .def("disable", &Trace::disable)
         ;
@@ -73,3 +73,9 @@ class Root(SimObject):
     time_sync_period = Param.Clock("100ms", "how often to sync with real time")
     time_sync_spin_threshold = \
             Param.Clock("100us", "when less than this much time is left, spin")
+
+    # Index the bins of the main event queues in a calendar instead of
+    # walking the sorted bin list on every insertion. The events are
+    # serviced in the same order either way.
+    eventq_calendar = Param.Bool(False,
+            "index the event queue bins in a calendar")
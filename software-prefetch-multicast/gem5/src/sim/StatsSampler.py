@@ -0,0 +1,15 @@
+from m5.params import *
+from m5.objects.ClockedObject import ClockedObject
+
+class StatsSampler(ClockedObject):
+    type = 'StatsSampler'
+    cxx_header = "sim/stats_sampler.hh"
+
+    stats = VectorParam.String([], "Statistics to sample, as ObjectMatch "
+        "expressions: 'system.ruby.network' selects every statistic under "
+        "the network, '*' matches any name component")
+    interval = Param.Cycles(10000, "Sampling interval")
+    capacity = Param.Unsigned(4096, "Samples held between two writes to "
+        "the file, the older ones are dropped")
+    file = Param.String("stats_timeseries.bin",
+        "Binary output file, in the output directory")
@@ -37,6 +37,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "base/bitfield.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "cpu/smt.hh"
@@ -46,6 +47,7 @@
 using namespace std;
 
 Tick simQuantum = 0;
+bool eventQueueCalendar = false;
 
 //
 // Main Event Queues
@@ -108,27 +110,62 @@ Event::insertBefore(Event *event, Event *curr)
     return event;
 }
 
+void
+EventQueue::InsertStats::sample(unsigned d)
+{
+    insertions++;
+    depth += d;
+    maxDepth = std::max<Counter>(maxDepth, d);
+    dist[d ? std::min(findMsbSet(d) + 1, DistBuckets - 1) : 0]++;
+}
+
 void
 EventQueue::insert(Event *event)
 {
+    if (calendar) {
+        insertCalendar(event);
+        return;
+    }
+
     // Deal with the head case
     if (!head || *event <= *head) {
         head = Event::insertBefore(event, head);
+        _insertStats.sample(0);
         return;
     }
 
     // Figure out either which 'in bin' list we are on, or where a new list
     // needs to be inserted
+    unsigned depth = 0;
     Event *prev = head;
     Event *curr = head->nextBin;
     while (curr && *curr < *event) {
         prev = curr;
         curr = curr->nextBin;
+        depth++;
     }
 
     // Note: this operation may render all nextBin pointers on the
     // prev 'in bin' list stale (except for the top one)
     prev->nextBin = Event::insertBefore(event, curr);
+    _insertStats.sample(depth);
+}
+
+void
+EventQueue::insertCalendar(Event *event)
+{
+    if (!head || *event <= *head) {
+        head = Event::insertBefore(event, head);
+        calendar->set(event->when(), event->priority(), head);
+    } else {
+        // The top of the previous bin has an up to date nextBin pointer
+        Event *prev = calendar->before(event->when(), event->priority());
+        assert(prev);
+        prev->nextBin = Event::insertBefore(event, prev->nextBin);
+        calendar->set(event->when(), event->priority(), prev->nextBin);
+    }
+
+    _insertStats.sample(calendar->takeDepth());
 }
 
 Event *
@@ -170,6 +207,11 @@ EventQueue::remove(Event *event)
 
     assert(event->queue == this);
 
+    if (calendar) {
+        removeCalendar(event);
+        return;
+    }
+
     // deal with an event on the head's 'in bin' list (event has the same
     // time as the head)
     if (*head == *event) {
@@ -194,6 +236,31 @@ EventQueue::remove(Event *event)
     prev->nextBin = Event::removeItem(event, curr);
 }
 
+void
+EventQueue::removeCalendar(Event *event)
+{
+    Event *prev = calendar->before(event->when(), event->priority());
+    Event *curr = prev ? prev->nextBin : head;
+
+    if (!curr || *curr != *event)
+        panic("event not found!");
+
+    bool last = event == curr && !curr->nextInBin;
+    Event *top = Event::removeItem(event, curr);
+    if (prev)
+        prev->nextBin = top;
+    else
+        head = top;
+
+    if (last)
+        calendar->erase(event->when(), event->priority());
+    else if (top != curr)
+        calendar->set(event->when(), event->priority(), top);
+
+    // Only the insertion depth is reported
+    calendar->takeDepth();
+}
+
 Event *
 EventQueue::serviceOne()
 {
@@ -214,6 +281,15 @@ EventQueue::serviceOne()
         head = head->nextBin;
     }
 
+    if (calendar) {
+        if (next)
+            calendar->set(event->when(), event->priority(), next);
+        else
+            calendar->erase(event->when(), event->priority());
+        calendar->advance(event->when());
+        calendar->takeDepth();
+    }
+
     // handle action
     if (!event->squashed()) {
         // forward current cycle to the time when this event occurs.
@@ -357,9 +433,31 @@ EventQueue::replaceHead(Event* s)
 {
     Event* t = head;
     head = s;
+    if (calendar)
+        indexBins();
     return t;
 }
 
+void
+EventQueue::indexBins()
+{
+    calendar->clear(head ? head->when() : getCurTick());
+    for (Event *bin = head; bin; bin = bin->nextBin)
+        calendar->set(bin->when(), bin->priority(), bin);
+    calendar->takeDepth();
+}
+
+void
+EventQueue::useCalendar(bool enable)
+{
+    if (enable && !calendar) {
+        calendar.reset(new EventCalendar());
+        indexBins();
+    } else if (!enable) {
+        calendar.reset();
+    }
+}
+
 void
 dumpMainQueue()
 {
@@ -422,6 +520,7 @@ Event::dump() const
 EventQueue::EventQueue(const string &n)
     : objName(n), head(NULL), _curTick(0)
 {
+    useCalendar(eventQueueCalendar);
 }
 
 void
@@ -48,6 +48,7 @@
 #include "base/types.hh"
 #include "base/uncontended_mutex.hh"
 #include "debug/Event.hh"
+#include "sim/eventq_calendar.hh"
 #include "sim/serialize.hh"
 
 class EventQueue;       // forward declaration
@@ -60,6 +61,10 @@ class BaseGlobalEvent;
 //! Queue B should be at least simQuantum ticks away in future.
 extern Tick simQuantum;
 
+//! Whether the main event queues index their bins in a calendar, see
+//! EventQueue::useCalendar(). Set by the Root object.
+extern bool eventQueueCalendar;
+
 //! Current number of allocated main event queues.
 extern uint32_t numMainEventQueues;
 
@@ -621,6 +626,10 @@ class EventQueue
     Event *head;
     Tick _curTick;
 
+    //! Calendar index of the bins, null when insertions walk the bin
+    //! list.
+    std::unique_ptr<EventCalendar> calendar;
+
     //! Mutex to protect async queue.
     UncontendedMutex async_queue_mutex;
 
@@ -654,6 +663,13 @@ class EventQueue
     void insert(Event *event);
     void remove(Event *event);
 
+    //! Insert / remove through the calendar index.
+    void insertCalendar(Event *event);
+    void removeCalendar(Event *event);
+
+    //! Rebuilds the calendar index from the bin list.
+    void indexBins();
+
     //! Function for adding events to the async queue. The added events
     //! are added to main event queue later. Threads, other than the
     //! owning thread, should call this function instead of insert().
@@ -661,6 +677,28 @@ class EventQueue
 
     EventQueue(const EventQueue &);
 
+  public:
+    /**
+     * Insertion depth of the queue: the bins walked by an insertion, or
+     * the calendar entries and bitmap words it visited.
+     */
+    struct InsertStats
+    {
+        //! Depth histogram: 0, then [2^(i-1), 2^i), the last bucket
+        //! holds the deeper insertions.
+        static const int DistBuckets = 12;
+
+        Counter insertions = 0;
+        Counter depth = 0;
+        Counter maxDepth = 0;
+        Counter dist[DistBuckets] = {};
+
+        void sample(unsigned d);
+    };
+
+  private:
+    InsertStats _insertStats;
+
   public:
     class ScopedMigration
     {
@@ -932,6 +970,18 @@ class EventQueue
      */
     Event* replaceHead(Event* s);
 
+    /**
+     * Indexes the bins (when, priority) of the queue in a calendar,
+     * see EventCalendar, instead of walking the sorted bin list to
+     * insert and remove events. The bins and the events in them are
+     * the same either way, so is the order in which they are serviced.
+     */
+    void useCalendar(bool enable);
+    bool usesCalendar() const { return calendar != nullptr; }
+
+    const InsertStats &insertStats() const { return _insertStats; }
+    void resetInsertStats() { _insertStats = InsertStats(); }
+
     /**@{*/
     /**
      * Provide an interface for locking/unlocking the event queue.
@@ -0,0 +1,200 @@
+/* @file
+ * Calendar index over the bins of an EventQueue
+ */
+
+#include "sim/eventq_calendar.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+
+#include "base/bitfield.hh"
+
+EventCalendar::EventCalendar(unsigned tick_shift, unsigned bucket_bits)
+    : tickShift(tick_shift), numBuckets(1ULL << bucket_bits),
+      mask(numBuckets - 1), base(0), buckets(numBuckets),
+      occupied((numBuckets + 63) / 64, 0), _size(0), depth(0)
+{
+}
+
+int64_t
+EventCalendar::lastSet(uint64_t lo, uint64_t hi)
+{
+    while (hi > lo) {
+        uint64_t word = (hi - 1) / 64;
+        uint64_t first = word * 64;
+        uint64_t bits = occupied[word];
+
+        unsigned top = (hi - 1) % 64;
+        if (top != 63)
+            bits &= (1ULL << (top + 1)) - 1;
+        if (lo > first)
+            bits &= ~((1ULL << (lo - first)) - 1);
+
+        depth++;
+        if (bits)
+            return first + findMsbSet(bits);
+        hi = first;
+    }
+    return -1;
+}
+
+int64_t
+EventCalendar::lastBucket(uint64_t n)
+{
+    // The window wraps around the end of the bucket array, look at the
+    // wrapped (later) part first
+    uint64_t start = base & mask;
+    if (start + n > numBuckets) {
+        int64_t b = lastSet(0, start + n - numBuckets);
+        if (b >= 0)
+            return b;
+        return lastSet(start, numBuckets);
+    }
+    return lastSet(start, start + n);
+}
+
+Event *
+EventCalendar::before(Tick when, int priority)
+{
+    Tick b = when >> tickShift;
+    if (b < base)
+        return nullptr;
+
+    if (b - base >= numBuckets) {
+        auto i = topRung.lower_bound(std::make_pair(when, priority));
+        depth++;
+        if (i != topRung.begin())
+            return std::prev(i)->second;
+        int64_t last = lastBucket(numBuckets);
+        return last < 0 ? nullptr : buckets[last].back().top;
+    }
+
+    const auto &bins = bucket(when);
+    for (auto i = bins.rbegin(); i != bins.rend(); ++i) {
+        depth++;
+        if (less(i->when, i->priority, when, priority))
+            return i->top;
+    }
+
+    int64_t last = lastBucket(b - base);
+    return last < 0 ? nullptr : buckets[last].back().top;
+}
+
+bool
+EventCalendar::insertBin(Tick when, int priority, Event *top)
+{
+    if (!inWindow(when)) {
+        auto res = topRung.emplace(std::make_pair(when, priority), top);
+        if (!res.second)
+            res.first->second = top;
+        return res.second;
+    }
+
+    auto &bins = bucket(when);
+    auto i = bins.end();
+    while (i != bins.begin()) {
+        auto prev = std::prev(i);
+        depth++;
+        if (prev->when == when && prev->priority == priority) {
+            prev->top = top;
+            return false;
+        }
+        if (less(prev->when, prev->priority, when, priority))
+            break;
+        i = prev;
+    }
+    bins.insert(i, Bin{when, priority, top});
+
+    uint64_t index = (when >> tickShift) & mask;
+    occupied[index / 64] |= 1ULL << (index % 64);
+    return true;
+}
+
+void
+EventCalendar::set(Tick when, int priority, Event *top)
+{
+    if ((when >> tickShift) < base)
+        rebase(when >> tickShift);
+
+    if (insertBin(when, priority, top))
+        _size++;
+}
+
+void
+EventCalendar::erase(Tick when, int priority)
+{
+    _size--;
+
+    if (!inWindow(when)) {
+        auto erased = topRung.erase(std::make_pair(when, priority));
+        assert(erased == 1);
+        (void)erased;
+        return;
+    }
+
+    auto &bins = bucket(when);
+    for (auto i = bins.begin(); i != bins.end(); ++i) {
+        if (i->when == when && i->priority == priority) {
+            bins.erase(i);
+            if (bins.empty()) {
+                uint64_t index = (when >> tickShift) & mask;
+                occupied[index / 64] &= ~(1ULL << (index % 64));
+            }
+            return;
+        }
+    }
+    assert(false && "bin not in the calendar");
+}
+
+void
+EventCalendar::advance(Tick now)
+{
+    Tick b = now >> tickShift;
+    if (b <= base)
+        return;
+
+    // The buckets left behind are empty, no bin is before now
+    base = b;
+
+    while (!topRung.empty() && inWindow(topRung.begin()->first.first)) {
+        auto i = topRung.begin();
+        insertBin(i->first.first, i->first.second, i->second);
+        topRung.erase(i);
+    }
+}
+
+void
+EventCalendar::clear(Tick now)
+{
+    for (uint64_t word = 0; word < occupied.size(); word++) {
+        while (occupied[word]) {
+            int bit = findMsbSet(occupied[word]);
+            buckets[word * 64 + bit].clear();
+            occupied[word] &= ~(1ULL << bit);
+        }
+    }
+    topRung.clear();
+    _size = 0;
+    base = now >> tickShift;
+}
+
+void
+EventCalendar::rebase(Tick b)
+{
+    // Only taken when the current tick goes backwards, e.g. while Ruby
+    // warms its caches up, so the cost of re-indexing does not matter
+    std::vector<Bin> bins;
+    for (auto &bucket : buckets) {
+        bins.insert(bins.end(), bucket.begin(), bucket.end());
+        bucket.clear();
+    }
+    for (const auto &bin : topRung)
+        bins.push_back(Bin{bin.first.first, bin.first.second, bin.second});
+    topRung.clear();
+    std::fill(occupied.begin(), occupied.end(), 0);
+
+    base = b;
+    for (const auto &bin : bins)
+        insertBin(bin.when, bin.priority, bin.top);
+}
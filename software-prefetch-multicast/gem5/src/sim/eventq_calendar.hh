@@ -0,0 +1,139 @@
+/* @file
+ * Calendar index over the bins of an EventQueue
+ */
+
+#ifndef __SIM_EVENTQ_CALENDAR_HH__
+#define __SIM_EVENTQ_CALENDAR_HH__
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/types.hh"
+
+class Event;
+
+/**
+ * Index of the bins (when, priority) of an event queue, used by the
+ * EventQueue to find where a bin goes without walking the bin list.
+ *
+ * The near future is a calendar of 2^bucketBits buckets of 2^tickShift
+ * ticks each. The calendar covers the window [base, base + span) and a
+ * bucket only holds the (few) bins of its ticks, sorted. A bitmap of the
+ * non empty buckets finds the previous bin in a handful of word tests.
+ * Bins past the window wait in an ordered map, the top rung of a ladder
+ * queue, and move into the calendar as the window follows the current
+ * tick: each bin is moved at most once.
+ *
+ * The calendar only indexes the top event of every bin, the events
+ * themselves stay in the EventQueue lists so that the service order is
+ * the one of the list implementation.
+ */
+class EventCalendar
+{
+  public:
+    /**
+     * The default window (2^14 buckets of 256 ticks, ~4us) covers the
+     * CPU, Ruby and link latencies, timeouts fall in the top rung.
+     */
+    EventCalendar(unsigned tick_shift = 8, unsigned bucket_bits = 14);
+
+    /**
+     * Top event of the last bin before (when, priority), nullptr if
+     * there is none.
+     */
+    Event *before(Tick when, int priority);
+
+    /** Adds the bin (when, priority) or updates its top event */
+    void set(Tick when, int priority, Event *top);
+
+    /** Removes the bin (when, priority), which must be indexed */
+    void erase(Tick when, int priority);
+
+    /**
+     * Moves the window to now, no bin may be before now. Bins of the top
+     * rung that enter the window move into the calendar.
+     */
+    void advance(Tick now);
+
+    /** Removes all the bins and moves the window to now */
+    void clear(Tick now);
+
+    /** Number of indexed bins */
+    size_t size() const { return _size; }
+
+    /**
+     * Bucket entries and bitmap words visited since the last call, the
+     * insertion depth of the calendar
+     */
+    unsigned
+    takeDepth()
+    {
+        unsigned d = depth;
+        depth = 0;
+        return d;
+    }
+
+  private:
+    struct Bin
+    {
+        Tick when;
+        int priority;
+        Event *top;
+    };
+
+    static bool
+    less(Tick lw, int lp, Tick rw, int rp)
+    {
+        return lw < rw || (lw == rw && lp < rp);
+    }
+
+    /** Bucket of the window holding tick when, the window must hold it */
+    std::vector<Bin> &
+    bucket(Tick when)
+    {
+        return buckets[(when >> tickShift) & mask];
+    }
+
+    /** Whether the bucket of tick when is in the window */
+    bool
+    inWindow(Tick when) const
+    {
+        Tick b = when >> tickShift;
+        return b >= base && b - base < numBuckets;
+    }
+
+    /** Adds or updates a bin, returns whether the bin is new */
+    bool insertBin(Tick when, int priority, Event *top);
+
+    /**
+     * Last non empty bucket among the first n buckets of the window, -1
+     * if there is none
+     */
+    int64_t lastBucket(uint64_t n);
+
+    /** Last set bit of the bitmap in [lo, hi), -1 if there is none */
+    int64_t lastSet(uint64_t lo, uint64_t hi);
+
+    /** Re-indexes every bin with the window starting at bucket b */
+    void rebase(Tick b);
+
+    const unsigned tickShift;
+    const uint64_t numBuckets;
+    const uint64_t mask;
+
+    /** First bucket (tick >> tickShift) of the window */
+    Tick base;
+
+    std::vector<std::vector<Bin>> buckets;
+    std::vector<uint64_t> occupied;
+
+    /** Bins past the window */
+    std::map<std::pair<Tick, int>, Event *> topRung;
+
+    size_t _size;
+    unsigned depth;
+};
+
+#endif // __SIM_EVENTQ_CALENDAR_HH__
@@ -0,0 +1,272 @@
+/* @file
+ * EventCalendar tests, and a micro-benchmark of the insertion depth of
+ * the calendar against the bin list walk of the EventQueue.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <random>
+#include <utility>
+
+#include "sim/eventq_calendar.hh"
+
+namespace
+{
+
+typedef std::pair<Tick, int> Key;
+
+// The calendar never dereferences the events, use the bin ids
+Event *
+fakeEvent(uint64_t id)
+{
+    return reinterpret_cast<Event *>(id + 1);
+}
+
+/** Reference index: the ordered map of the bins */
+Event *
+before(const std::map<Key, Event *> &bins, Tick when, int priority)
+{
+    auto i = bins.lower_bound(Key(when, priority));
+    return i == bins.begin() ? nullptr : std::prev(i)->second;
+}
+
+/**
+ * Services the bins of both indexes in order, with random insertions
+ * and removals ahead of the current tick, some of them past the window.
+ */
+void
+checkAgainstMap(EventCalendar &calendar, std::mt19937_64 &rng, Tick now,
+                int ops)
+{
+    std::map<Key, Event *> bins;
+    std::uniform_int_distribution<int> op(0, 9);
+    std::uniform_int_distribution<Tick> near(0, 4000);
+    std::uniform_int_distribution<Tick> far(0, 1 << 20);
+    std::uniform_int_distribution<int> priority(-3, 3);
+    uint64_t id = 0;
+
+    calendar.clear(now);
+    for (int i = 0; i < ops; i++) {
+        int o = op(rng);
+        if (o < 6) {
+            Tick when = now + (o < 5 ? near(rng) : far(rng));
+            int prio = priority(rng);
+            ASSERT_EQ(calendar.before(when, prio), before(bins, when, prio));
+            Event *top = fakeEvent(id++);
+            calendar.set(when, prio, top);
+            bins[Key(when, prio)] = top;
+        } else if (o < 8 && !bins.empty()) {
+            // Remove a random bin
+            auto it = bins.lower_bound(Key(now + near(rng), 0));
+            if (it == bins.end())
+                it = bins.begin();
+            calendar.erase(it->first.first, it->first.second);
+            bins.erase(it);
+        } else if (!bins.empty()) {
+            // Service the first bin
+            auto first = bins.begin();
+            ASSERT_EQ(calendar.before(first->first.first,
+                                      first->first.second), nullptr);
+            now = first->first.first;
+            calendar.erase(first->first.first, first->first.second);
+            bins.erase(first);
+            calendar.advance(now);
+        }
+        ASSERT_EQ(calendar.size(), bins.size());
+    }
+
+    // Every bin is the previous one of the next bin
+    Event *prev = nullptr;
+    for (const auto &bin : bins) {
+        ASSERT_EQ(calendar.before(bin.first.first, bin.first.second), prev);
+        prev = bin.second;
+    }
+    ASSERT_EQ(calendar.before(MaxTick, 0), prev);
+}
+
+} // anonymous namespace
+
+TEST(EventCalendarTest, Empty)
+{
+    EventCalendar calendar;
+    EXPECT_EQ(calendar.size(), 0u);
+    EXPECT_EQ(calendar.before(0, 0), nullptr);
+    EXPECT_EQ(calendar.before(1000, 0), nullptr);
+    EXPECT_EQ(calendar.before(MaxTick, 0), nullptr);
+}
+
+TEST(EventCalendarTest, PriorityOrder)
+{
+    EventCalendar calendar;
+    calendar.set(100, 0, fakeEvent(0));
+    calendar.set(100, -1, fakeEvent(1));
+    calendar.set(100, 1, fakeEvent(2));
+    calendar.set(99, 5, fakeEvent(3));
+
+    EXPECT_EQ(calendar.before(100, -1), fakeEvent(3));
+    EXPECT_EQ(calendar.before(100, 0), fakeEvent(1));
+    EXPECT_EQ(calendar.before(100, 1), fakeEvent(0));
+    EXPECT_EQ(calendar.before(101, -5), fakeEvent(2));
+
+    // Updating the top of a bin does not add a bin
+    calendar.set(100, 0, fakeEvent(4));
+    EXPECT_EQ(calendar.size(), 4u);
+    EXPECT_EQ(calendar.before(100, 1), fakeEvent(4));
+
+    calendar.erase(100, 0);
+    EXPECT_EQ(calendar.before(100, 1), fakeEvent(1));
+}
+
+TEST(EventCalendarTest, TopRung)
+{
+    // 16 buckets of 16 ticks: the window is 256 ticks long
+    EventCalendar calendar(4, 4);
+    calendar.set(10, 0, fakeEvent(0));
+    calendar.set(1000, 0, fakeEvent(1));
+    calendar.set(100000, 0, fakeEvent(2));
+
+    EXPECT_EQ(calendar.before(500, 0), fakeEvent(0));
+    EXPECT_EQ(calendar.before(5000, 0), fakeEvent(1));
+    EXPECT_EQ(calendar.before(MaxTick, 0), fakeEvent(2));
+
+    calendar.erase(10, 0);
+    calendar.advance(900);
+    EXPECT_EQ(calendar.before(1000, 0), nullptr);
+    EXPECT_EQ(calendar.before(1001, 0), fakeEvent(1));
+    EXPECT_EQ(calendar.before(100001, 0), fakeEvent(2));
+
+    calendar.erase(1000, 0);
+    calendar.advance(100000);
+    EXPECT_EQ(calendar.before(100001, 0), fakeEvent(2));
+    calendar.erase(100000, 0);
+    EXPECT_EQ(calendar.size(), 0u);
+}
+
+TEST(EventCalendarTest, Rebase)
+{
+    // The current tick goes backwards, e.g. for the Ruby cache warmup
+    EventCalendar calendar(4, 4);
+    calendar.clear(100000);
+    calendar.set(100000, 0, fakeEvent(0));
+    calendar.set(10, 0, fakeEvent(1));
+    calendar.set(20, 0, fakeEvent(2));
+
+    EXPECT_EQ(calendar.before(15, 0), fakeEvent(1));
+    EXPECT_EQ(calendar.before(100000, 0), fakeEvent(2));
+    EXPECT_EQ(calendar.size(), 3u);
+}
+
+TEST(EventCalendarTest, RandomAgainstMap)
+{
+    std::mt19937_64 rng(1);
+
+    // A small window so that the bins go through the top rung and the
+    // window wraps around the buckets
+    EventCalendar small(4, 6);
+    checkAgainstMap(small, rng, 0, 20000);
+    checkAgainstMap(small, rng, 1ULL << 40, 20000);
+
+    EventCalendar calendar;
+    checkAgainstMap(calendar, rng, 0, 20000);
+}
+
+/**
+ * Schedules the clock edges of a 64 core SPM system, 3.5GHz CPUs and a
+ * 2GHz Ruby, with 16 messages in flight per core, through the bin list
+ * walk of the EventQueue and through the calendar, and reports the
+ * insertion depth of both. Run with --gtest_also_run_disabled_tests.
+ */
+TEST(EventCalendarTest, DISABLED_InsertionDepthBenchmark)
+{
+    const int cores = 64;
+    const int inflight = 16;
+    const int events = 2000000;
+    const int initial = cores * (2 + inflight);
+
+    struct Pending
+    {
+        Tick when;
+        Tick period;
+    };
+
+    auto workload = [&](auto &&insert, auto &&pop) {
+        std::mt19937_64 rng(1);
+        std::uniform_int_distribution<Tick> latency(1, 400);
+        for (int c = 0; c < cores; c++) {
+            insert(Pending{286, 286});
+            insert(Pending{500, 500});
+            for (int m = 0; m < inflight; m++)
+                insert(Pending{500 * latency(rng), 0});
+        }
+        for (int i = 0; i < events; i++) {
+            Pending p = pop();
+            insert(p.period ? Pending{p.when + p.period, p.period} :
+                   Pending{p.when + 500 * latency(rng), 0});
+        }
+    };
+
+    // Bin list walk, as EventQueue::insert
+    {
+        std::list<std::pair<Tick, std::list<Pending>>> bins;
+        uint64_t depth = 0;
+        auto start = std::chrono::steady_clock::now();
+        workload([&](const Pending &p) {
+                auto i = bins.begin();
+                while (i != bins.end() && i->first < p.when) {
+                    ++i;
+                    depth++;
+                }
+                if (i == bins.end() || i->first != p.when)
+                    i = bins.emplace(i, p.when, std::list<Pending>());
+                i->second.push_front(p);
+            }, [&]() {
+                Pending p = bins.front().second.front();
+                bins.front().second.pop_front();
+                if (bins.front().second.empty())
+                    bins.pop_front();
+                return p;
+            });
+        std::chrono::duration<double> time =
+            std::chrono::steady_clock::now() - start;
+        std::cout << "list: avg insertion depth "
+                  << double(depth) / (events + initial) << ", "
+                  << time.count() << "s\n";
+    }
+
+    // Calendar index
+    {
+        EventCalendar calendar;
+        std::map<Tick, std::list<Pending>> bins;
+        uint64_t depth = 0;
+        uint64_t id = 0;
+        auto start = std::chrono::steady_clock::now();
+        workload([&](const Pending &p) {
+                calendar.before(p.when, 0);
+                calendar.set(p.when, 0, fakeEvent(id++));
+                depth += calendar.takeDepth();
+                bins[p.when].push_front(p);
+            }, [&]() {
+                auto first = bins.begin();
+                Pending p = first->second.front();
+                first->second.pop_front();
+                if (first->second.empty()) {
+                    calendar.erase(first->first, 0);
+                    bins.erase(first);
+                }
+                calendar.advance(p.when);
+                calendar.takeDepth();
+                return p;
+            });
+        std::chrono::duration<double> time =
+            std::chrono::steady_clock::now() - start;
+        std::cout << "calendar: avg insertion depth "
+                  << double(depth) / (events + initial) << ", "
+                  << time.count() << "s (includes the reference map)\n";
+    }
+}
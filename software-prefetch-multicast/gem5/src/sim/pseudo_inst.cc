@@ -591,6 +591,7 @@ prepushBegin(ThreadContext *tc)
     DPRINTF(PseudoInst, "PseudoInst::prepushBegin()\n");
 
     AbstractController::enablePrepush();
+    tc->getSystemPtr()->prepushWindow(true);
 }
 
 void
@@ -599,6 +600,7 @@ prepushEnd(ThreadContext *tc)
     DPRINTF(PseudoInst, "PseudoInst::prepushEnd()\n");
 
     AbstractController::disablePrepush();
+    tc->getSystemPtr()->prepushWindow(false);
 }
 
 void
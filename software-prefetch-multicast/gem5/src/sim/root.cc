@@ -39,6 +39,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+
 #include "base/hostinfo.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
@@ -63,6 +65,18 @@ Root::Stats::Stats()
     hostSeconds(this, "host_seconds", "Real time elapsed on the host"),
     hostTickRate(this, "host_tick_rate", "Simulator tick rate (ticks/s)"),
     hostMemory(this, "host_mem_usage", "Number of bytes of host memory used"),
+    eventqInsertions(this, "eventq_insertions",
+                     "Number of events inserted in the main event queues"),
+    eventqInsertDepth(this, "eventq_insert_depth",
+                      "Bins (or calendar entries) visited by the "
+                      "event queue insertions"),
+    eventqMaxInsertDepth(this, "eventq_max_insert_depth",
+                         "Deepest event queue insertion"),
+    eventqAvgInsertDepth(this, "eventq_avg_insert_depth",
+                         "Average event queue insertion depth"),
+    eventqInsertDepthDist(this, "eventq_insert_depth_dist",
+                          "Distribution of the event queue insertion "
+                          "depths"),
 
     statTime(true),
     startTick(0)
@@ -89,6 +103,49 @@ Root::Stats::Stats()
 
     simSeconds = simTicks / simFreq;
     hostTickRate = simTicks / hostSeconds;
+
+    eventqInsertions.functor([]() {
+            Counter insertions = 0;
+            for (auto *eq : mainEventQueue)
+                insertions += eq->insertStats().insertions;
+            return insertions;
+        });
+    eventqInsertDepth.functor([]() {
+            Counter depth = 0;
+            for (auto *eq : mainEventQueue)
+                depth += eq->insertStats().depth;
+            return depth;
+        });
+    eventqMaxInsertDepth.functor([]() {
+            Counter depth = 0;
+            for (auto *eq : mainEventQueue)
+                depth = std::max(depth, eq->insertStats().maxDepth);
+            return depth;
+        });
+    eventqAvgInsertDepth = eventqInsertDepth / eventqInsertions;
+
+    const int buckets = EventQueue::InsertStats::DistBuckets;
+    eventqInsertDepthDist.init(buckets);
+    eventqInsertDepthDist.subname(0, "0");
+    for (int i = 1; i < buckets - 1; i++) {
+        eventqInsertDepthDist.subname(i, i == 1 ? std::string("1") :
+            csprintf("%d-%d", 1 << (i - 1), (1 << i) - 1));
+    }
+    eventqInsertDepthDist.subname(buckets - 1,
+                                  csprintf("%d+", 1 << (buckets - 2)));
+}
+
+void
+Root::Stats::preDumpStats()
+{
+    Stats::Group::preDumpStats();
+
+    for (int i = 0; i < EventQueue::InsertStats::DistBuckets; i++) {
+        Counter samples = 0;
+        for (auto *eq : mainEventQueue)
+            samples += eq->insertStats().dist[i];
+        eventqInsertDepthDist[i] = samples;
+    }
 }
 
 void
@@ -97,6 +154,9 @@ Root::Stats::resetStats()
     statTime.setTimer();
     startTick = curTick();
 
+    for (auto *eq : mainEventQueue)
+        eq->resetInsertStats();
+
     Stats::Group::resetStats();
 }
 
@@ -176,6 +236,11 @@ Root::Root(const RootParams &p)
 
     simQuantum = p.sim_quantum;
 
+    // Queues created from now on follow eventQueueCalendar
+    eventQueueCalendar = p.eventq_calendar;
+    for (auto *eq : mainEventQueue)
+        eq->useCalendar(eventQueueCalendar);
+
     // Some of the statistics are global and need to be accessed by
     // stat formulas. The most convenient way to implement that is by
     // having a single global stat group for global stats. Merge that
@@ -103,6 +103,15 @@ class Root : public SimObject
         ::Stats::Formula hostTickRate;
         ::Stats::Value hostMemory;
 
+        /** Insertion depth of the main event queues */
+        ::Stats::Value eventqInsertions;
+        ::Stats::Value eventqInsertDepth;
+        ::Stats::Value eventqMaxInsertDepth;
+        ::Stats::Formula eventqAvgInsertDepth;
+        ::Stats::Vector eventqInsertDepthDist;
+
+        void preDumpStats() override;
+
         static Stats instance;
 
       private:
@@ -0,0 +1,155 @@
+/* @file
+ * Periodic sampler of a selection of statistics
+ */
+
+#include "sim/stats_sampler.hh"
+
+#include <cmath>
+
+#include "base/logging.hh"
+#include "base/output.hh"
+#include "base/statistics.hh"
+#include "base/stats/group.hh"
+#include "sim/core.hh"
+#include "sim/root.hh"
+
+StatsSampler::StatsSampler(const Params &p)
+    : ClockedObject(p), interval(p.interval), os(nullptr), reportedDrops(0),
+      sampleEvent([this]{ sample(); }, name())
+{
+    fatal_if(interval == 0, "%s: the sampling interval must not be 0",
+             name());
+    fatal_if(p.capacity == 0, "%s: the sample capacity must not be 0",
+             name());
+
+    for (const auto &expression : p.stats)
+        match.add(ObjectMatch(expression));
+}
+
+std::map<const Stats::Info *, StatsSampler::LiveSource> &
+StatsSampler::liveSources()
+{
+    static std::map<const Stats::Info *, LiveSource> sources;
+    return sources;
+}
+
+void
+StatsSampler::addLiveScalar(const Stats::Scalar &stat,
+                            std::function<double()> source)
+{
+    liveSources()[stat.info()] = [source](double *values) {
+        *values = source();
+    };
+}
+
+void
+StatsSampler::addLiveVector(const Stats::Vector &stat, LiveSource source)
+{
+    liveSources()[stat.info()] = source;
+}
+
+void
+StatsSampler::select(const std::string &name, const Stats::Info *info,
+                     std::vector<std::string> &columns)
+{
+    if (!match.match(name))
+        return;
+
+    auto live = liveSources().find(info);
+    LiveSource source = live != liveSources().end() ? live->second : nullptr;
+
+    if (auto scalar = dynamic_cast<const Stats::ScalarInfo *>(info)) {
+        sources.push_back({scalar, nullptr, 1, source});
+        columns.push_back(name);
+    } else if (auto vector = dynamic_cast<const Stats::VectorInfo *>(info)) {
+        // Formulas are vectors too
+        size_t size = vector->size();
+        sources.push_back({nullptr, vector, size, source});
+        for (size_t i = 0; i < size; i++) {
+            if (size == 1 && vector->subnames.empty()) {
+                columns.push_back(name);
+            } else if (i < vector->subnames.size() &&
+                       !vector->subnames[i].empty()) {
+                columns.push_back(name + "::" + vector->subnames[i]);
+            } else {
+                columns.push_back(name + "::" + std::to_string(i));
+            }
+        }
+    } else {
+        warn("%s: cannot sample %s, only scalars, vectors and formulas "
+             "are supported", this->name(), name);
+    }
+}
+
+void
+StatsSampler::selectGroup(const std::string &prefix,
+                          const Stats::Group *group,
+                          std::vector<std::string> &columns)
+{
+    for (const auto *info : group->getStats())
+        select(prefix + info->name, info, columns);
+    for (const auto &child : group->getStatGroups())
+        selectGroup(prefix + child.first + ".", child.second, columns);
+}
+
+void
+StatsSampler::startup()
+{
+    ClockedObject::startup();
+
+    // Old style statistics carry their full name, the new style ones are
+    // named after the groups holding them.
+    std::vector<std::string> columns;
+    for (const auto &entry : Stats::nameMap())
+        select(entry.first, entry.second, columns);
+    selectGroup("", Root::root(), columns);
+
+    if (columns.empty()) {
+        warn("%s: no statistic matches, nothing to sample", name());
+        return;
+    }
+    inform("%s: sampling %d statistics (%d columns) every %d cycles",
+           name(), sources.size(), columns.size(), interval);
+
+    series.reset(new Stats::TimeSeries(columns, params().capacity,
+                                       SimClock::Frequency));
+    os = simout.create(params().file, true)->stream();
+
+    Stats::registerDumpCallback([this]() { flush(); });
+    registerExitCallback([this]() { flush(); });
+
+    schedule(sampleEvent, clockEdge(interval));
+}
+
+void
+StatsSampler::sample()
+{
+    double *row = series->append(curTick());
+    for (const auto &source : sources) {
+        if (source.live) {
+            source.live(row);
+            row += source.size;
+        } else if (source.scalar) {
+            *row++ = source.scalar->result();
+        } else {
+            const Stats::VResult &result = source.vector->result();
+            for (size_t i = 0; i < source.size; i++)
+                *row++ = i < result.size() ? result[i] : NAN;
+        }
+    }
+
+    schedule(sampleEvent, clockEdge(interval));
+}
+
+void
+StatsSampler::flush()
+{
+    series->write(*os);
+
+    if (series->dropped() != reportedDrops) {
+        warn("%s: dropped %d samples between two writes, raise the "
+             "capacity to keep them", name(),
+             series->dropped() - reportedDrops);
+        reportedDrops = series->dropped();
+    }
+}
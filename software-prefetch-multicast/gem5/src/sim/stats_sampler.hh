@@ -0,0 +1,108 @@
+/* @file
+ * Periodic sampler of a selection of statistics
+ */
+
+#ifndef __SIM_STATS_SAMPLER_HH__
+#define __SIM_STATS_SAMPLER_HH__
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "base/match.hh"
+#include "base/statistics.hh"
+#include "base/stats/info.hh"
+#include "base/stats/timeseries.hh"
+#include "params/StatsSampler.hh"
+#include "sim/clocked_object.hh"
+#include "sim/eventq.hh"
+
+namespace Stats
+{
+class Group;
+} // namespace Stats
+
+/**
+ * Every interval cycles, reads the current value of the selected scalar,
+ * vector and formula statistics into a Stats::TimeSeries, which is
+ * written to a binary file on every statistics dump and at exit. Only the
+ * selected statistics are evaluated, none of the dump machinery runs at
+ * the samples.
+ *
+ * The counters are sampled as they are: they restart from zero on every
+ * statistics reset. Statistics that their owner only brings up to date at
+ * dumps (e.g. in a collateStats() dump callback) would sample as stale
+ * values, their owner registers a live source computing their current
+ * value instead, which the sampler reads in place of the statistic.
+ */
+class StatsSampler : public ClockedObject
+{
+  public:
+    typedef StatsSamplerParams Params;
+    StatsSampler(const Params &p);
+
+    /** Selects the statistics, which are all registered by now */
+    void startup() override;
+
+    /**
+     * Writes the current value of a statistic, one element per vector
+     * element, to the row of the sample. Called at every sample, it does
+     * not allocate.
+     */
+    typedef std::function<void(double *values)> LiveSource;
+
+    /** Sample a scalar statistic from a function rather than its value */
+    static void addLiveScalar(const Stats::Scalar &stat,
+                              std::function<double()> source);
+
+    /**
+     * Sample a vector statistic from a function rather than its value,
+     * which writes stat.size() values
+     */
+    static void addLiveVector(const Stats::Vector &stat, LiveSource source);
+
+  private:
+    /** A selected statistic, feeding one column per element */
+    struct Source
+    {
+        const Stats::ScalarInfo *scalar;
+        const Stats::VectorInfo *vector;
+        size_t size;
+        /** Read in place of the statistic if set */
+        LiveSource live;
+    };
+
+    /** Live sources of the statistics updated at dumps only */
+    static std::map<const Stats::Info *, LiveSource> &liveSources();
+
+    /** Select the statistic name if it matches the expressions */
+    void select(const std::string &name, const Stats::Info *info,
+                std::vector<std::string> &columns);
+
+    /** Select the matching statistics of a group and its subgroups */
+    void selectGroup(const std::string &prefix, const Stats::Group *group,
+                     std::vector<std::string> &columns);
+
+    void sample();
+    void flush();
+
+    const Params &
+    params() const
+    {
+        return dynamic_cast<const Params &>(_params);
+    }
+
+    const Cycles interval;
+    ObjectMatch match;
+    std::vector<Source> sources;
+    std::unique_ptr<Stats::TimeSeries> series;
+    std::ostream *os;
+    uint64_t reportedDrops;
+
+    EventFunctionWrapper sampleEvent;
+};
+
+#endif // __SIM_STATS_SAMPLER_HH__
@@ -271,6 +271,15 @@ System::~System()
         delete workItemStats[j];
 }
 
+void
+System::regProbePoints()
+{
+    SimObject::regProbePoints();
+
+    ppPrepushWindow.reset(
+        new ProbePointArg<bool>(getProbeManager(), "PrepushWindow"));
+}
+
 void
 System::startup()
 {
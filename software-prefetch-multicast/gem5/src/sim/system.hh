@@ -42,6 +42,7 @@
 #ifndef __SYSTEM_HH__
 #define __SYSTEM_HH__
 
+#include <memory>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -61,6 +62,7 @@
 #include "mem/port_proxy.hh"
 #include "params/System.hh"
 #include "sim/futex_map.hh"
+#include "sim/probe/probe.hh"
 #include "sim/redirect_path.hh"
 #include "sim/se_signal.hh"
 #include "sim/sim_object.hh"
@@ -223,6 +225,7 @@ class System : public SimObject, public PCEventScope
     };
 
     void startup() override;
+    void regProbePoints() override;
 
     /**
      * Get a reference to the system port that can be used by
@@ -552,6 +555,21 @@ class System : public SimObject, public PCEventScope
 
     void workItemEnd(uint32_t tid, uint32_t workid);
 
+    /**
+     * Called by pseudo_inst when the workload opens or closes the prepush
+     * (ROI) window, so that listeners outside of Ruby can follow it.
+     */
+    void
+    prepushWindow(bool open)
+    {
+        if (ppPrepushWindow)
+            ppPrepushWindow->notify(open);
+    }
+
+  protected:
+    /** Notified with the new state when the prepush window changes */
+    std::unique_ptr<ProbePointArg<bool>> ppPrepushWindow;
+
   public:
     bool breakpoint();
 
@@ -0,0 +1,376 @@
+/**
+ * @file
+ *
+ *  Replays the config.ini of a Python configured run (se.py with the SPM
+ *  Ruby hierarchy) through CxxConfigManager, so that the points of a
+ *  sweep skip the Python SimObject elaboration.
+ *
+ *  Only the whitelisted parameters below (and the workload command) can
+ *  be changed from the command line: they do not change the object
+ *  graph. Anything else, e.g. the number of cores, the topology or the
+ *  cache sizes, needs a new config.ini from se.py.
+ *
+ *  Stats are written to <outdir>/stats.txt with the same layout as the
+ *  Python stats package, m5 ops dumping or resetting stats are honoured.
+ *  A config elaborated with --fast-forward is switched to its detailed
+ *  CPUs (system.switch_cpus) at the first exit, as se.py does.
+ *
+ *  Usage:
+ *
+ *      gem5.opt.replay <config.ini> [--outdir=<dir>]
+ *          [--debug-flags=<flags>] [--debug-file=<file>]
+ *          [--max-tick=<tick>] [--cmd=<binary>] [--options=<args>]
+ *          [--<override>=<value> ...]
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include "base/output.hh"
+#include "base/statistics.hh"
+#include "base/str.hh"
+#include "base/trace.hh"
+#include "cpu/base.hh"
+#include "sim/cxx_config_ini.hh"
+#include "sim/cxx_manager.hh"
+#include "sim/init_signals.hh"
+#include "sim/sim_events.hh"
+#include "sim/sim_exit.hh"
+#include "sim/simulate.hh"
+#include "sim/stat_control.hh"
+#include "sim/system.hh"
+#include "stats.hh"
+
+namespace
+{
+
+/** A parameter that can be overridden without re-elaborating the system */
+struct Override
+{
+    /** Command line option, named after the se.py option */
+    const char *option;
+    /** Type (the ini type= key) of the objects holding the parameter */
+    const char *type;
+    const char *param;
+    /** Separator of the values of a vector parameter, 0 for a scalar */
+    char separator;
+};
+
+const Override overrides[] = {
+    {"timeout_threshold", "L1Cache_Controller", "TimeoutThreshold", 0},
+    {"en_adaptive_timeout_threshold", "L1Cache_Controller",
+     "en_adaptive_timeout_threshold", 0},
+    {"en_adaptive_timeout_division", "L1Cache_Controller",
+     "en_adaptive_timeout_division", 0},
+    {"timeout_threshold_upper_bound", "L1Cache_Controller",
+     "timeout_threshold_upper_bound", 0},
+    {"determine_host", "L1Cache_Controller", "determine_host", 0},
+    {"shadow_timeout_thresholds", "L1Cache_Controller",
+     "shadow_timeout_thresholds", ','},
+    {"shadow_adaptive_upper_bounds", "L1Cache_Controller",
+     "shadow_adaptive_upper_bounds", ','},
+    {"timeout_switch_threshold", "L2Cache_Controller",
+     "timeout_switch_threshold", 0},
+    {"en_timeout_multicast", "L2Cache_Controller", "en_timeout_multicast", 0},
+    {"en_hostswitch", "L2Cache_Controller", "en_hostswitch", 0},
+};
+
+void
+usage(const std::string &prog_name)
+{
+    std::cerr << "Usage: " << prog_name << (
+        " <config-file.ini> [ <option> ]\n\n"
+        "OPTIONS:\n"
+        "    --outdir=<dir>        -- output directory [Default: m5out]\n"
+        "    --debug-flags=<flags> -- comma separated debug flags\n"
+        "    --debug-file=<file>   -- debug output file in the outdir\n"
+        "    --max-tick=<tick>     -- stop at the given tick\n"
+        "    --cmd=<binary>        -- binary run by the processes\n"
+        "    --options=<args>      -- arguments of the binary\n"
+        "\n"
+        "OVERRIDES (set on every object of the type):\n");
+    for (const auto &o : overrides)
+        std::cerr << "    --" << o.option << "=<value>  -- " << o.type
+            << '.' << o.param << '\n';
+    std::cerr << '\n';
+
+    std::exit(EXIT_FAILURE);
+}
+
+/** Objects of the config file by type */
+std::multimap<std::string, std::string>
+objectsByType(const CxxConfigFileBase &conf)
+{
+    std::vector<std::string> names;
+    conf.getAllObjectNames(names);
+
+    std::multimap<std::string, std::string> objects;
+    for (const auto &name : names) {
+        std::string type;
+        if (conf.getParam(name, "type", type))
+            objects.emplace(type, name);
+    }
+    return objects;
+}
+
+/** Applies the overrides and the workload command before instantiation */
+void
+applyOverrides(const CxxConfigFileBase &conf, CxxConfigManager &manager,
+               const std::map<std::string, std::string> &values,
+               const std::string &cmd, const std::string &options)
+{
+    auto objects = objectsByType(conf);
+
+    for (const auto &o : overrides) {
+        auto value = values.find(o.option);
+        if (value == values.end())
+            continue;
+
+        auto range = objects.equal_range(o.type);
+        if (range.first == range.second)
+            throw CxxConfigManager::Exception(o.option,
+                csprintf("no %s object in the config", o.type));
+
+        for (auto i = range.first; i != range.second; ++i) {
+            if (o.separator) {
+                std::vector<std::string> tokens;
+                tokenize(tokens, value->second, o.separator);
+                manager.setParamVector(i->second, o.param, tokens);
+            } else {
+                manager.setParam(i->second, o.param, value->second);
+            }
+        }
+    }
+
+    if (cmd.empty() && options.empty())
+        return;
+
+    // se.py sets cmd to the binary followed by its options
+    auto range = objects.equal_range("Process");
+    if (range.first == range.second)
+        throw CxxConfigManager::Exception("cmd", "no Process in the config");
+
+    for (auto i = range.first; i != range.second; ++i) {
+        std::vector<std::string> process_cmd;
+        if (cmd.empty()) {
+            conf.getParamVector(i->second, "cmd", process_cmd);
+            process_cmd.resize(1);
+        } else {
+            process_cmd.push_back(cmd);
+        }
+        tokenize(process_cmd, options, ' ');
+
+        manager.setParamVector(i->second, "cmd", process_cmd);
+        manager.setParam(i->second, "executable", process_cmd[0]);
+    }
+}
+
+/**
+ * Links the stats group of every object to its parent, as
+ * m5.stats._bindStatHierarchy does, so that the stats are named after
+ * the object path. Must run after regStats as the manager registers the
+ * stats of every object itself.
+ */
+void
+bindStatHierarchy(const CxxConfigFileBase &conf, CxxConfigManager &manager)
+{
+    std::vector<std::string> names;
+    conf.getAllObjectNames(names);
+
+    for (const auto &name : names) {
+        if (name == "root")
+            continue;
+
+        std::size_t dot = name.rfind('.');
+        std::string parent = dot == std::string::npos ?
+            "root" : name.substr(0, dot);
+        std::string child = dot == std::string::npos ?
+            name : name.substr(dot + 1);
+
+        manager.findObject(parent)->addStatGroup(child.c_str(),
+                                                 manager.findObject(name));
+    }
+}
+
+/**
+ * The (old, new) CPU pairs of a fast forwarded config, se.py names the
+ * detailed CPU of system.cpu<N> system.switch_cpus<N>
+ */
+std::vector<std::pair<std::string, std::string>>
+switchCpuPairs(const CxxConfigFileBase &conf)
+{
+    std::vector<std::string> names;
+    conf.getAllObjectNames(names);
+
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (const auto &name : names) {
+        const std::string prefix = "system.switch_cpus";
+        if (name.compare(0, prefix.size(), prefix) != 0 ||
+            name.find('.', prefix.size()) != std::string::npos)
+            continue;
+
+        std::string old_cpu = "system.cpu" + name.substr(prefix.size());
+        if (conf.objectExists(old_cpu))
+            pairs.emplace_back(old_cpu, name);
+    }
+    return pairs;
+}
+
+/** Drains the system, as m5.drain() */
+void
+drain(CxxConfigManager &manager)
+{
+    while (manager.drain() > 0)
+        simulate();
+}
+
+/** Hands the fast forwarded execution over to the detailed CPUs */
+void
+switchCpus(CxxConfigManager &manager,
+           const std::vector<std::pair<std::string, std::string>> &pairs)
+{
+    std::cout << "switching cpus\n";
+
+    drain(manager);
+
+    for (const auto &pair : pairs)
+        manager.getObject<BaseCPU>(pair.first).switchOut();
+
+    System &system = manager.getObject<System>("system");
+    if (system.getMemoryMode() != Enums::timing)
+        system.setMemoryMode(Enums::timing);
+
+    for (const auto &pair : pairs) {
+        manager.getObject<BaseCPU>(pair.second).takeOverFrom(
+            &manager.getObject<BaseCPU>(pair.first));
+    }
+
+    manager.drainResume();
+}
+
+}
+
+int
+main(int argc, char **argv)
+{
+    std::string prog_name(argv[0]);
+
+    if (argc < 2)
+        usage(prog_name);
+
+    cxxConfigInit();
+
+    initSignals();
+
+    setClockFrequency(1000000000000);
+    curEventQueue(getEventQueue(0));
+
+    Stats::initSimStats();
+    Stats::registerHandlers(CxxConfig::statsTextReset,
+                            CxxConfig::statsTextDump);
+
+    Trace::enable();
+
+    const std::string config_file(argv[1]);
+    std::string outdir = "m5out";
+    std::string debug_file = "";
+    std::string cmd = "";
+    std::string options = "";
+    Tick max_tick = MaxTick;
+    std::map<std::string, std::string> values;
+
+    for (int arg_ptr = 2; arg_ptr < argc; arg_ptr++) {
+        std::string arg(argv[arg_ptr]);
+        std::size_t eq = arg.find('=');
+
+        if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+            usage(prog_name);
+
+        std::string option = arg.substr(2, eq - 2);
+        std::string value = arg.substr(eq + 1);
+
+        if (option == "outdir") {
+            outdir = value;
+        } else if (option == "debug-flags") {
+            std::vector<std::string> flags;
+            tokenize(flags, value, ',');
+            for (const auto &flag : flags)
+                setDebugFlag(flag.c_str());
+        } else if (option == "debug-file") {
+            debug_file = value;
+        } else if (option == "max-tick") {
+            if (!to_number(value, max_tick))
+                usage(prog_name);
+        } else if (option == "cmd") {
+            cmd = value;
+        } else if (option == "options") {
+            options = value;
+        } else {
+            bool known = false;
+            for (const auto &o : overrides)
+                known = known || option == o.option;
+            if (!known)
+                usage(prog_name);
+            values[option] = value;
+        }
+    }
+
+    simout.setDirectory(outdir);
+    if (!debug_file.empty()) {
+        Trace::setDebugLogger(new Trace::OstreamLogger(
+            *simout.findOrCreate(debug_file)->stream()));
+    }
+    CxxConfig::statsInitText("stats.txt");
+
+    CxxConfigFileBase *conf = new CxxIniFile();
+
+    if (!conf->load(config_file.c_str())) {
+        std::cerr << "Can't open config file: " << config_file << '\n';
+        return EXIT_FAILURE;
+    }
+
+    CxxConfigManager *config_manager = new CxxConfigManager(*conf);
+
+    try {
+        applyOverrides(*conf, *config_manager, values, cmd, options);
+
+        config_manager->instantiate();
+        bindStatHierarchy(*conf, *config_manager);
+        CxxConfig::statsTextEnable();
+        config_manager->initState();
+        config_manager->startup();
+    } catch (CxxConfigManager::Exception &e) {
+        std::cerr << "Config problem in sim object " << e.name
+            << ": " << e.message << "\n";
+
+        return EXIT_FAILURE;
+    }
+
+    GlobalSimLoopExitEvent *exit_event = nullptr;
+
+    auto switch_pairs = switchCpuPairs(*conf);
+    if (!switch_pairs.empty()) {
+        simulate();
+        std::cout << "Switched CPUS @ tick " << curTick() << '\n';
+        switchCpus(*config_manager, switch_pairs);
+        Stats::reset();
+    }
+
+    std::cout << "**** REAL SIMULATION ****\n";
+
+    // Checkpoint m5 ops are not taken, checkpointing runs go through se.py
+    exit_event = simulate(max_tick - curTick());
+    while (exit_event->getCause() == "checkpoint") {
+        std::cerr << "Skipping checkpoint at tick " << curTick() << '\n';
+        exit_event = simulate(max_tick - curTick());
+    }
+
+    std::cout << "Exiting @ tick " << curTick() << " because "
+        << exit_event->getCause() << '\n';
+
+    Stats::dump();
+
+    return exit_event->getCode();
+}
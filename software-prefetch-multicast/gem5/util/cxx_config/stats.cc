@@ -43,7 +43,11 @@
  *  Register with: Stats::registerHandlers(statsReset, statsDump)
  */
 
+#include "base/logging.hh"
 #include "base/statistics.hh"
+#include "base/stats/text.hh"
+#include "sim/core.hh"
+#include "sim/root.hh"
 #include "stats.hh"
 
 namespace CxxConfig
@@ -110,4 +114,95 @@ void statsEnable()
         (*i)->enable();
 }
 
+namespace
+{
+
+Stats::Output *textOutput = nullptr;
+Tick lastTextDump = 0;
+
+/** Visit the new-style stats of group and its children */
+template <typename F>
+void
+forEachGroupStat(Stats::Group &group, F func)
+{
+    for (auto stat : group.getStats())
+        func(stat);
+    for (auto &child : group.getStatGroups())
+        forEachGroupStat(*child.second, func);
+}
+
+void
+dumpGroup(Stats::Output &output, Stats::Group &group)
+{
+    for (auto stat : group.getStats())
+        stat->visit(output);
+    for (auto &child : group.getStatGroups()) {
+        output.beginGroup(child.first.c_str());
+        dumpGroup(output, *child.second);
+        output.endGroup();
+    }
+}
+
+}
+
+void statsInitText(const std::string &filename)
+{
+    textOutput = Stats::initText(filename, true, true);
+}
+
+void statsTextEnable()
+{
+    auto check = [](Stats::Info *stat) {
+        if (!stat->check() || !stat->baseCheck())
+            fatal("statistic '%s' (%d) was not properly initialized "
+                  "by a regStats() function\n", stat->name, stat->id);
+        stat->enable();
+    };
+
+    std::list<Stats::Info *> &stats = Stats::statsList();
+    for (auto i = stats.begin(); i != stats.end(); ++i)
+        check(*i);
+    stats.sort(Stats::Info::less);
+
+    forEachGroupStat(*Root::root(), check);
+
+    Stats::enable();
+}
+
+void statsTextDump()
+{
+    // Only one dump per tick, as m5.stats.dump()
+    if (lastTextDump == curTick())
+        return;
+    lastTextDump = curTick();
+
+    Stats::processDumpQueue();
+    Root::root()->preDumpStats();
+
+    statsPrepare();
+    forEachGroupStat(*Root::root(),
+                     [](Stats::Info *stat) { stat->prepare(); });
+
+    if (!textOutput || !textOutput->valid())
+        return;
+
+    textOutput->begin();
+    dumpGroup(*textOutput, *Root::root());
+    std::list<Stats::Info *> &stats = Stats::statsList();
+    for (auto i = stats.begin(); i != stats.end(); ++i)
+        (*i)->visit(*textOutput);
+    textOutput->end();
+}
+
+void statsTextReset()
+{
+    Root::root()->resetStats();
+
+    std::list<Stats::Info *> &stats = Stats::statsList();
+    for (auto i = stats.begin(); i != stats.end(); ++i)
+        (*i)->reset();
+
+    Stats::processResetQueue();
+}
+
 }
@@ -46,6 +46,8 @@
 #ifndef __UTIL_CXX_CONFIG_STATS_H__
 #define __UTIL_CXX_CONFIG_STATS_H__
 
+#include <string>
+
 namespace CxxConfig
 {
 
@@ -54,6 +56,12 @@ void statsReset();
 void statsEnable();
 void statsPrepare();
 
+/** stats.txt output, laid out as the Python stats package does */
+void statsInitText(const std::string &filename);
+void statsTextDump();
+void statsTextReset();
+void statsTextEnable();
+
 }
 
 #endif // __UTIL_CXX_CONFIG_STATS_H__
@@ -0,0 +1,25 @@
+# Render a binary debug trace (--debug-file=FILE.trc) as the text gem5
+# would have printed. The records are formatted by the cprintf of gem5,
+# so the script runs in any gem5 binary:
+#
+#   build/X86/gem5.opt -q util/decode_debug_trace.py m5out/debug.trc \
+#       m5out/debug.txt
+
+from __future__ import print_function
+
+import argparse
+import sys
+
+import m5
+
+parser = argparse.ArgumentParser(
+    description="Render a binary debug trace as text")
+parser.add_argument("trace", help="Binary debug trace")
+parser.add_argument("output", nargs="?", default="",
+                    help="Text output [Default: stdout]")
+args = parser.parse_args()
+
+if not m5.trace.decode(args.trace, args.output):
+    print("%s: truncated or not a debug trace" % args.trace,
+          file=sys.stderr)
+    sys.exit(1)
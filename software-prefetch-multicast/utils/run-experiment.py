@@ -1,4 +1,5 @@
 import os
+import re
 import sys
 import math
 import argparse
@@ -40,7 +41,9 @@ def get_command(args, cmd, options):
         command.append('--listener-mode=off')
 
     # runscript and system config
-    if args.launch_experiments == "prepush-ack-bingo":
+    if args.fanout == "replay":
+        command.append(f"./gem5/configs/example/fanout_replay.py")
+    elif args.launch_experiments == "prepush-ack-bingo":
         command.append(f"./gem5/configs/example/se.py")
     else:
         command.append(f"./gem5/configs/example/se.py")
@@ -50,7 +53,12 @@ def get_command(args, cmd, options):
 
     # CPU options
     command.append(f"--num-cpus={args.num_cpus}")
-    command.append(f"--cpu-type={args.cpu_type}")
+    if args.simpoint in ["profile", "checkpoint"]:
+        command.append("--cpu-type=AtomicSimpleCPU")
+    elif args.fanout == "replay":
+        command.append("--cpu-type=TraceCPU")
+    else:
+        command.append(f"--cpu-type={args.cpu_type}")
     command.append("--cpu-clock=3.5GHz")
 
     # Memory hierarchy
@@ -107,6 +115,13 @@ def get_command(args, cmd, options):
             elif args.num_cpus == 64:
                 command.append("--timeout_threshold=1024")
                 command.append("--timeout_switch_threshold=16384")
+
+        # Shadow timeout policies, evaluated on the waitlist events of the
+        # run above (stats: *.L1cache.shadow_timeout.*)
+        if args.shadow_timeout_thresholds is not None:
+            command.append(f"--shadow_timeout_thresholds={args.shadow_timeout_thresholds}")
+        if args.shadow_adaptive_upper_bounds is not None:
+            command.append(f"--shadow_adaptive_upper_bounds={args.shadow_adaptive_upper_bounds}")
             
         if args.spm_type == "MulticastSoftwarePrefetch": # Multicast Software Prefetch
             command.append("--en_timeout_multicast=1")
@@ -129,6 +144,30 @@ def get_command(args, cmd, options):
     if args.enable_prefetch:
         command.append("--enable-prefetch")
 
+    # Spin-wait quiescing, the replay CPUs do not execute the program
+    if args.spin_quiesce and args.fanout != "replay":
+        command.append("--spin-quiesce")
+
+    if args.eventq_calendar:
+        command.append("--eventq-calendar")
+
+    # The replay CPUs do not decode the program either
+    if args.shared_decode_cache and args.fanout != "replay":
+        command.append("--shared-decode-cache")
+
+    if args.noc_latency_csv:
+        command.append("--noc-latency-csv=noc_latency.csv")
+        command.append("--noc-latency-csv-interval="
+                       f"{args.noc_latency_csv_interval}")
+
+    for expression in args.stats_sample:
+        command.append(f"--stats-sample={expression}")
+    if args.stats_sample:
+        command.append("--stats-sample-interval="
+                       f"{args.stats_sample_interval}")
+        command.append("--stats-sample-capacity="
+                       f"{args.stats_sample_capacity}")
+
     # NoC options
     command.append(f"--message-buffer-size={args.message_buffer_size}")
     command.append("--network=garnet")
@@ -148,9 +187,17 @@ def get_command(args, cmd, options):
     if args.hold_switch_for_multicast_only:
         command.append("--hold-switch-for-multicast-only")
 
-    # Benchmark options
-    command.append(f"--cmd={cmd}")
-    command.append(f"--options=\"{options}\"")
+    # Benchmark options, a replay only reads the traces of the front end
+    if args.fanout == "replay":
+        command.append(f"--inst-trace-file={args.fanout_trace_dir}/inst.pb.gz")
+        command.append(f"--data-trace-file={args.fanout_trace_dir}/deps.pb.gz")
+    else:
+        command.append(f"--cmd={cmd}")
+        command.append(f"--options=\"{options}\"")
+    if args.fanout == "record":
+        command.append("--elastic-trace-en")
+        command.append(f"--inst-trace-file={args.fanout_trace_dir}/inst.pb.gz")
+        command.append(f"--data-trace-file={args.fanout_trace_dir}/deps.pb.gz")
 
     # Profiling and prepush options
     if args.profile_llc:
@@ -182,8 +229,35 @@ def get_command(args, cmd, options):
     if args.coalescing:
         command.append("--coalescing")
 
+    # Sampled simulation
+    if args.sample_window is not None:
+        command.append(f"--sample-window={args.sample_window}")
+        command.append(f"--sample-interval={args.sample_interval}")
+        command.append(f"--sample-detail-warmup={args.sample_detail_warmup}")
+
+    # SimPoint region selection within the ROI
+    if args.simpoint == "profile":
+        command.append("--simpoint-profile")
+        command.append("--simpoint-roi-only")
+        command.append(f"--simpoint-interval={args.simpoint_interval}")
+    elif args.simpoint == "checkpoint":
+        prefix = f"{args.simpoint_dir}/simpoint"
+        command.append(f"--checkpoint-dir={args.simpoint_dir}")
+        command.append(f"--take-simpoint-checkpoints={prefix}.simpts,"
+                       f"{prefix}.weights,{args.simpoint_interval},"
+                       f"{args.simpoint_warmup},{prefix}.insts")
+    elif args.simpoint == "run":
+        command.append(f"--checkpoint-dir={args.simpoint_dir}")
+        command.append(f"--checkpoint-restore={args.simpoint_id}")
+        command.append("--restore-simpoint-checkpoint")
+
+    # Fan out variant options
+    if args.fanout == "replay" and args.fanout_options:
+        command.append(args.fanout_options)
+
     # Others
-    command.append(f"--fast-forward={sys.maxsize}")
+    if args.simpoint is None and args.fanout != "replay":
+        command.append(f"--fast-forward={sys.maxsize}")
     if args.log:
         logfile_path = f"{args.outdir}/sim.log"
         logdir = os.path.dirname(logfile_path)
@@ -194,10 +268,40 @@ def get_command(args, cmd, options):
         else:
             command.append(f"> {logfile_path} 2>&1 &")
 
+    if args.replay_config is not None:
+        return get_replay_command(args, command)
+
     return command
 # get_command() - end
 
 
+# se.py options a config.ini replay can still change, see
+# gem5/util/cxx_config/replay.cc
+REPLAY_OPTIONS = ["debug-flags", "debug-file", "cmd", "options",
+                  "timeout_threshold", "en_adaptive_timeout_threshold",
+                  "en_adaptive_timeout_division",
+                  "timeout_threshold_upper_bound", "determine_host",
+                  "shadow_timeout_thresholds", "shadow_adaptive_upper_bounds",
+                  "timeout_switch_threshold", "en_timeout_multicast",
+                  "en_hostswitch"]
+
+
+def get_replay_command(args, command):
+    '''Turn an se.py command into a replay of a previously elaborated
+    config.ini, only the options in REPLAY_OPTIONS are kept'''
+
+    replay = [args.replay_binary, args.replay_config,
+              f"--outdir={args.outdir}"]
+    for option in command[1:]:
+        if option.startswith("--"):
+            if option[2:].split("=", 1)[0] in REPLAY_OPTIONS:
+                replay.append(option)
+        elif option.startswith(">"):
+            replay.append(option)
+    return replay
+# get_replay_command() - end
+
+
 def get_benchmark_cmd_options(args):
     enprefetch = args.enprefetch
     benchmark = args.benchmark
@@ -564,6 +668,57 @@ def get_benchmark_cmd_options(args):
 # get_benchmark_cmd_options() - end
 
 
+def run_simpoints(args):
+    """ Run every SimPoint checkpoint and combine the weighted stats. """
+
+    expr = re.compile(r"cpt\.simpoint_(\d+)_inst_\d+_weight_([\d\.e\-]+)_")
+    cpts = sorted(d for d in os.listdir(args.simpoint_dir) if expr.match(d))
+    if not cpts:
+        raise RuntimeError(f"No SimPoint checkpoint in {args.simpoint_dir}")
+
+    outdir = args.outdir
+    for i, cpt in enumerate(cpts):
+        m = expr.match(cpt)
+        temp_args = deepcopy(args)
+        # Simulation.py restores the checkpoints in sorted order from 1
+        temp_args.simpoint_id = i + 1
+        temp_args.outdir = f"{outdir}/simpoint{m.group(1)}-weight-{m.group(2)}"
+        temp_args.simpoint = "run"
+        run_gem5_instance(temp_args)
+
+    if not args.dry_run:
+        subprocess.run([sys.executable,
+                        f"{os.path.dirname(os.path.abspath(__file__))}"
+                        "/simpoint.py", "weighted-stats",
+                        f"--rundir={outdir}"], check=True)
+# run_simpoints() - end
+
+
+def fanout(args):
+    """ Replay the recorded traces under every variant in parallel. """
+
+    args_list = []
+    for variant in args.fanout_variants:
+        name, _, options = variant.partition(":")
+        temp_args = deepcopy(args)
+        temp_args.outdir = f"{args.outdir}/{name}"
+        temp_args.fanout_options = options
+        temp_args.log = True
+        args_list.append(temp_args)
+
+    if args.sweep_thread_pool_size is None:
+        args.sweep_thread_pool_size = mp.cpu_count() // 2
+
+    pool_size = max(1, min(args.sweep_thread_pool_size, len(args_list)))
+    pool = mp.Pool(pool_size)
+    pool.map(run_gem5_instance, args_list)
+    pool.close()
+    pool.join()
+
+    print("Complete all fan out replays!")
+# fanout() - end
+
+
 def run_gem5_instance(args):
     """ Run a simulation instance. """
 
@@ -1049,6 +1204,68 @@ def main():
                         help="Number of iterations as input to cfd")
     parser.add_argument("--particlefilter-frames", default=0, type=int,
                         help="Number of frames as input to particlefilter")
+    parser.add_argument("--shadow-timeout-thresholds", default=None,
+                        type=str,
+                        help="Comma separated fixed timeout thresholds "
+                             "evaluated in the shadow of the real one, e.g. "
+                             "128,256,512,1024,2048 [Default: None]")
+    parser.add_argument("--shadow-adaptive-upper-bounds", default=None,
+                        type=str,
+                        help="Comma separated adaptive timeout upper bounds "
+                             "evaluated in the shadow of the real one "
+                             "[Default: None]")
+    parser.add_argument("--sample-window", default=None, type=int,
+                        help="Sampled simulation: detailed measurement "
+                             "window in ticks, the full benchmark input can "
+                             "then be used [Default: None, no sampling]")
+    parser.add_argument("--sample-interval", default=None, type=int,
+                        help="Sampled simulation: functional warming ticks "
+                             "between two windows [Default: None]")
+    parser.add_argument("--sample-detail-warmup", default=0, type=int,
+                        help="Sampled simulation: detailed warming ticks "
+                             "before each window [Default: 0]")
+    parser.add_argument("--simpoint", default=None, type=str,
+                        choices=["profile", "checkpoint", "run"],
+                        help="SimPoint workflow step: 'profile' the BBVs of "
+                             "the ROI, take 'checkpoint's at the simpoints "
+                             "clustered by utils/simpoint.py, or 'run' all "
+                             "of them and combine the weighted stats "
+                             "[Default: None]")
+    parser.add_argument("--simpoint-dir", default="m5out", type=str,
+                        help="Directory of the BBV profile, simpoints and "
+                             "checkpoints [Default: m5out]")
+    parser.add_argument("--simpoint-interval", default=10000000, type=int,
+                        help="SimPoint interval in instructions "
+                             "[Default: 10000000]")
+    parser.add_argument("--simpoint-warmup", default=1000000, type=int,
+                        help="Warmup instructions before each simpoint "
+                             "[Default: 1000000]")
+    parser.add_argument("--fanout", default=None, type=str,
+                        choices=["record", "replay"],
+                        help="Fan out one functional front end to several "
+                             "configurations: 'record' the per-core elastic "
+                             "traces of the detailed region once, then "
+                             "'replay' them under every --fanout-variants "
+                             "entry in parallel [Default: None]")
+    parser.add_argument("--fanout-trace-dir", default="m5out/fanout",
+                        type=str,
+                        help="Directory of the fan out traces "
+                             "[Default: m5out/fanout]")
+    parser.add_argument("--fanout-variants", type=str, nargs="*",
+                        default=[],
+                        help="Replay variants as '<name>:<extra gem5 "
+                             "options>', e.g. 'spm:--en_softprepush=1' "
+                             "[Default: []]")
+    parser.add_argument("--replay-config", default=None, type=str,
+                        help="Instantiate the system from the config.ini of "
+                             "a previous run instead of se.py, only the "
+                             "timeout/host switch options and the benchmark "
+                             "can differ from that run [Default: None]")
+    parser.add_argument("--replay-binary", type=str,
+                        default="./gem5/util/cxx_config/gem5.opt.replay",
+                        help="config.ini replay binary built with "
+                             "--with-cxx-config [Default: "
+                             "./gem5/util/cxx_config/gem5.opt.replay]")
     parser.add_argument("--lud-size", default=1024, type=int, #1024
                         help="Matrix size for LU Decomposition")
     parser.add_argument("--test-input", default=False, action="store_true",
@@ -1081,7 +1298,10 @@ def main():
     parser.add_argument("--debug-end", metavar="TICK", type=int, default=None,
                         help="End debug output at TICK")
     parser.add_argument("--debug-file", metavar="FILE", default=None,
-                        help="Sets the output file for debug [Default: None]")
+                        help="Sets the output file for debug, a FILE "
+                             "ending in .trc is a compressed binary trace "
+                             "(decode with gem5/util/decode_debug_trace.py) "
+                             "[Default: None]")
     parser.add_argument("--profile-pc-low", default=None, type=str,
                         help="The low PC boundry for profile PC range, can "
                              "be either decimal or hex form [Default: None]")
@@ -1101,6 +1321,38 @@ def main():
     parser.add_argument("--enable-prefetch", default=False,
                         action="store_true",
                         help="Enable ruby prefetcher [Default: False]")
+    parser.add_argument("--spin-quiesce", default=False,
+                        action="store_true",
+                        help="Suspend cores spinning in barriers until the "
+                             "spun line is written [Default: False]")
+    parser.add_argument("--eventq-calendar", default=False,
+                        action="store_true",
+                        help="Index the gem5 event queue in a calendar "
+                             "[Default: False]")
+    parser.add_argument("--shared-decode-cache", default=False,
+                        action="store_true",
+                        help="Share the x86 decode cache across the cores "
+                             "and pre-decode the benchmark text "
+                             "[Default: False]")
+    parser.add_argument("--noc-latency-csv", default=False,
+                        action="store_true",
+                        help="Stream the NoC latency breakdown per message "
+                             "class to m5out/noc_latency.csv "
+                             "[Default: False]")
+    parser.add_argument("--noc-latency-csv-interval", default=10000, type=int,
+                        help="Sampling interval of the NoC latency CSV in "
+                             "cycles [Default: 10000]")
+    parser.add_argument("--stats-sample", default=[], action="append",
+                        help="Sample the gem5 statistics matching this "
+                             "name expression into "
+                             "m5out/stats_timeseries.bin, can be repeated "
+                             "(decode with utils/stats-timeseries.py)")
+    parser.add_argument("--stats-sample-interval", default=10000, type=int,
+                        help="Statistics sampling interval in cycles "
+                             "[Default: 10000]")
+    parser.add_argument("--stats-sample-capacity", default=4096, type=int,
+                        help="Samples held in memory between two writes of "
+                             "the time series [Default: 4096]")
     parser.add_argument("--prepush", default=False, action="store_true",
                         help="Enable prepush.")
     parser.add_argument("--always-prepush", default=False, action="store_true",
@@ -1158,6 +1410,9 @@ def main():
 
     args = parser.parse_args()
 
+    if args.sample_window is not None and args.sample_interval is None:
+        parser.error("--sample-window needs --sample-interval")
+
     if args.launch_experiments is None:
         if not os.path.exists(args.gem5):
             print(f"Error: {args.gem5} not exists!")
@@ -1193,6 +1448,10 @@ def main():
             print(f"Error: {gem5} not exists!")
             return
         launch_experiments(args)
+    elif args.simpoint == "run":
+        run_simpoints(args)
+    elif args.fanout == "replay":
+        fanout(args)
     else:
         run_gem5_instance(args)
 
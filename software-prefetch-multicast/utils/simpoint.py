@@ -0,0 +1,227 @@
+import os
+import re
+import sys
+import gzip
+import argparse
+import numpy as np
+
+
+def read_bbv(filename):
+    '''Read a SimPoint BBV file (one "T:id:count ..." line per interval)'''
+
+    opener = gzip.open if filename.endswith(".gz") else open
+    intervals = []
+    max_id = 0
+    with opener(filename, "rt") as bbvfile:
+        for line in bbvfile:
+            if not line.startswith("T"):
+                continue
+            vector = {}
+            for field in line[1:].split():
+                _, bb_id, count = field.split(":")
+                bb_id = int(bb_id)
+                vector[bb_id] = int(count)
+                max_id = max(max_id, bb_id)
+            intervals.append(vector)
+
+    bbv = np.zeros((len(intervals), max_id), dtype=np.float64)
+    for i, vector in enumerate(intervals):
+        for bb_id, count in vector.items():
+            bbv[i, bb_id - 1] = count
+    return bbv
+# read_bbv() - end
+
+
+def project(bbv, dims, seed):
+    '''Normalize each interval and randomly project it to dims dimensions,
+    as SimPoint 3.2 does.'''
+
+    totals = bbv.sum(axis=1, keepdims=True)
+    totals[totals == 0] = 1
+    rng = np.random.RandomState(seed)
+    matrix = rng.uniform(-1, 1, size=(bbv.shape[1], dims))
+    return (bbv / totals) @ matrix
+# project() - end
+
+
+def kmeans(points, k, seed, iterations=100):
+    '''Plain k-means with k-means++ seeding'''
+
+    rng = np.random.RandomState(seed)
+    centers = [points[rng.randint(len(points))]]
+    for _ in range(1, k):
+        dist = np.min([((points - c) ** 2).sum(axis=1) for c in centers],
+                      axis=0)
+        if dist.sum() == 0:
+            centers.append(points[rng.randint(len(points))])
+        else:
+            centers.append(points[rng.choice(len(points),
+                                             p=dist / dist.sum())])
+    centers = np.array(centers)
+
+    labels = np.zeros(len(points), dtype=int)
+    for _ in range(iterations):
+        dist = ((points[:, None, :] - centers[None, :, :]) ** 2).sum(axis=2)
+        new_labels = dist.argmin(axis=1)
+        if (new_labels == labels).all() and _ > 0:
+            break
+        labels = new_labels
+        for c in range(k):
+            members = points[labels == c]
+            if len(members) > 0:
+                centers[c] = members.mean(axis=0)
+    return labels, centers
+# kmeans() - end
+
+
+def bic(points, labels, centers):
+    '''Bayesian information criterion of a clustering (higher is better)'''
+
+    n, d = points.shape
+    k = len(centers)
+    sse = ((points - centers[labels]) ** 2).sum()
+    variance = max(sse / max(n - k, 1), 1e-12)
+    likelihood = 0.0
+    for c in range(k):
+        nc = (labels == c).sum()
+        if nc == 0:
+            continue
+        likelihood += nc * np.log(nc) - nc * np.log(n) \
+                - nc * d / 2.0 * np.log(2 * np.pi * variance) \
+                - (nc - 1) * d / 2.0
+    return likelihood - (k * (d + 1)) / 2.0 * np.log(n)
+# bic() - end
+
+
+def cluster(args):
+    '''Cluster the BBVs and write SimPoint 3.2 style simpoints/weights'''
+
+    bbv = read_bbv(args.bbv)
+    if len(bbv) == 0:
+        raise RuntimeError(f"No interval found in {args.bbv}")
+    points = project(bbv, args.dims, args.seed)
+
+    # Pick the smallest k whose BIC reaches the threshold of the BIC range,
+    # as SimPoint does
+    results = []
+    for k in range(1, min(args.max_k, len(points)) + 1):
+        labels, centers = kmeans(points, k, args.seed)
+        results.append((k, labels, centers, bic(points, labels, centers)))
+    scores = [r[3] for r in results]
+    low, high = min(scores), max(scores)
+    for k, labels, centers, score in results:
+        if high == low or (score - low) / (high - low) >= args.bic_threshold:
+            break
+    print(f"{len(points)} intervals, {k} clusters")
+
+    with open(f"{args.output}.simpts", "w") as simpts, \
+            open(f"{args.output}.weights", "w") as weights:
+        for c in range(k):
+            members = np.where(labels == c)[0]
+            if len(members) == 0:
+                continue
+            dist = ((points[members] - centers[c]) ** 2).sum(axis=1)
+            interval = members[dist.argmin()]
+            simpts.write(f"{interval} {c}\n")
+            weights.write(f"{len(members) / len(points)} {c}\n")
+# cluster() - end
+
+
+def read_last_dump(statsfile):
+    '''Return the numeric stats of the last dump of a stats.txt'''
+
+    dumps = []
+    with open(statsfile, "r") as f:
+        for line in f:
+            if "Begin Simulation Statistics" in line:
+                dumps.append({})
+                continue
+            fields = line.split()
+            if len(fields) < 2 or not dumps:
+                continue
+            try:
+                dumps[-1][fields[0]] = float(fields[1])
+            except ValueError:
+                pass
+    if not dumps:
+        raise RuntimeError(f"No stats found in {statsfile}")
+    return dumps[-1]
+# read_last_dump() - end
+
+
+def weighted_stats(args):
+    '''Combine the stats of the simpoint runs by their weights'''
+
+    expr = re.compile(r"simpoint(\d+)-weight-([\d\.e\-]+)$")
+    total_weight = 0.0
+    combined = {}
+    for entry in sorted(os.listdir(args.rundir)):
+        m = expr.match(entry)
+        statsfile = os.path.join(args.rundir, entry, "stats.txt")
+        if not m or not os.path.exists(statsfile):
+            continue
+        weight = float(m.group(2))
+        total_weight += weight
+        for stat, value in read_last_dump(statsfile).items():
+            combined[stat] = combined.get(stat, 0.0) + weight * value
+    if total_weight == 0:
+        raise RuntimeError(f"No simpoint run found in {args.rundir}")
+
+    output = os.path.join(args.rundir, "weighted-stats.txt")
+    with open(output, "w") as f:
+        f.write(f"# total simpoint weight {total_weight}\n")
+        for stat, value in combined.items():
+            f.write(f"{stat} {value / total_weight}\n")
+    print(f"Weighted stats written to {output}")
+# weighted_stats() - end
+
+
+def main():
+
+    parser = argparse.ArgumentParser(
+            description="SimPoint clustering and weighted stats for the "
+                        "ROI profiled with --simpoint-roi-only")
+    subparsers = parser.add_subparsers(dest="command")
+
+    parser_cluster = subparsers.add_parser("cluster",
+            help="Cluster a BBV file into simpoints and weights")
+    parser_cluster.add_argument("--bbv", type=str,
+                                default="m5out/simpoint.bb.gz",
+                                help="BBV file [Default: "
+                                     "m5out/simpoint.bb.gz]")
+    parser_cluster.add_argument("--output", type=str,
+                                default="m5out/simpoint",
+                                help="Output prefix of the .simpts and "
+                                     ".weights files [Default: "
+                                     "m5out/simpoint]")
+    parser_cluster.add_argument("--max-k", type=int, default=10,
+                                help="Maximum number of clusters "
+                                     "[Default: 10]")
+    parser_cluster.add_argument("--dims", type=int, default=15,
+                                help="Random projection dimensions "
+                                     "[Default: 15]")
+    parser_cluster.add_argument("--bic-threshold", type=float, default=0.9,
+                                help="BIC threshold to select k "
+                                     "[Default: 0.9]")
+    parser_cluster.add_argument("--seed", type=int, default=493575226,
+                                help="Random seed [Default: 493575226]")
+
+    parser_stats = subparsers.add_parser("weighted-stats",
+            help="Combine the stats of the simpoint runs")
+    parser_stats.add_argument("--rundir", type=str, default="m5out",
+                              help="Directory holding the "
+                                   "simpoint<N>-weight-<W> runs "
+                                   "[Default: m5out]")
+
+    args = parser.parse_args()
+
+    if args.command == "cluster":
+        cluster(args)
+    elif args.command == "weighted-stats":
+        weighted_stats(args)
+    else:
+        parser.print_help()
+
+
+if __name__ == "__main__":
+    main()
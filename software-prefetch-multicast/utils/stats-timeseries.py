@@ -0,0 +1,96 @@
+import re
+import sys
+import struct
+import argparse
+
+MAGIC = b"M5TSER01"
+
+
+def read_timeseries(filename):
+    '''Read a time series written by the gem5 StatsSampler, returns the
+    ticks per second, the column names and the (tick, values) samples.
+    A sample cut short by a simulation still running is ignored.'''
+
+    with open(filename, "rb") as tsfile:
+        data = tsfile.read()
+
+    if data[:len(MAGIC)] != MAGIC:
+        sys.exit(f"{filename}: not a statistics time series")
+    offset = len(MAGIC)
+    frequency, ncolumns = struct.unpack_from("=QI", data, offset)
+    offset += struct.calcsize("=QI")
+
+    columns = []
+    for _ in range(ncolumns):
+        length, = struct.unpack_from("=I", data, offset)
+        offset += 4
+        columns.append(data[offset:offset + length].decode())
+        offset += length
+
+    record = struct.Struct(f"=Q{ncolumns}d")
+    samples = []
+    while offset + record.size <= len(data):
+        fields = record.unpack_from(data, offset)
+        samples.append((fields[0], fields[1:]))
+        offset += record.size
+    return frequency, columns, samples
+# read_timeseries() - end
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode the statistics time series of a gem5 run")
+    parser.add_argument("file", type=str, nargs="?",
+                        default="m5out/stats_timeseries.bin",
+                        help="Time series [Default: "
+                             "m5out/stats_timeseries.bin]")
+    parser.add_argument("--columns", type=str, default=None,
+                        help="Regular expression selecting the columns "
+                             "[Default: all]")
+    parser.add_argument("--delta", default=False, action="store_true",
+                        help="Print the difference between consecutive "
+                             "samples instead of the counters "
+                             "[Default: False]")
+    parser.add_argument("--plot", type=str, default=None,
+                        help="Plot the selected columns to this file "
+                             "instead of printing a CSV")
+    args = parser.parse_args()
+
+    frequency, columns, samples = read_timeseries(args.file)
+
+    selected = list(range(len(columns)))
+    if args.columns:
+        pattern = re.compile(args.columns)
+        selected = [i for i in selected if pattern.search(columns[i])]
+
+    rows = []
+    previous = None
+    for tick, values in samples:
+        values = [values[i] for i in selected]
+        if args.delta:
+            current = values
+            values = [v - p for v, p in zip(values, previous or values)]
+            previous = current
+        rows.append((tick, values))
+
+    if args.plot:
+        import matplotlib
+        matplotlib.use("Agg")
+        import matplotlib.pyplot as plt
+
+        seconds = [tick / frequency for tick, _ in rows]
+        for n, i in enumerate(selected):
+            plt.plot(seconds, [values[n] for _, values in rows],
+                     label=columns[i])
+        plt.xlabel("Simulated time (s)")
+        plt.legend(fontsize="small")
+        plt.savefig(args.plot, bbox_inches="tight")
+        return
+
+    print(",".join(["tick"] + [columns[i] for i in selected]))
+    for tick, values in rows:
+        print(",".join([str(tick)] + [repr(v) for v in values]))
+
+
+if __name__ == "__main__":
+    main()